@@ -0,0 +1,30 @@
+#include "bench_util.h"
+#include "body.h"
+#include "color.h"
+#include <stdio.h>
+
+const double DT = 1.0 / 60;
+
+void bench_body_tick(void *aux, size_t iterations) {
+  body_t *body = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    body_add_force(body, (vector_t){0, -1});
+    body_tick(body, DT);
+  }
+  bench_consume(body_get_centroid(body).y);
+}
+
+int main(void) {
+  const size_t VERTEX_COUNTS[] = {4, 20, 64};
+  const size_t NUM_COUNTS = sizeof(VERTEX_COUNTS) / sizeof(*VERTEX_COUNTS);
+  for (size_t i = 0; i < NUM_COUNTS; i++) {
+    size_t n = VERTEX_COUNTS[i];
+    body_t *body = body_init(bench_regular_polygon(n, 10, VEC_ZERO), 1,
+                             (rgb_color_t){0, 0, 0});
+    body_set_velocity(body, (vector_t){100, 0});
+    char name[64];
+    snprintf(name, sizeof(name), "body_tick/%zu", n);
+    bench_run(name, bench_body_tick, body);
+    body_free(body);
+  }
+}
@@ -0,0 +1,89 @@
+#include "bench_util.h"
+#include "collision.h"
+#include "job_system.h"
+#include "list.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// the size of the batch given to find_collisions()
+#define BATCH_PAIRS 2000
+
+void bench_find_collision(void *aux, size_t iterations) {
+  collision_pair_t *pair = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    collision_info_t info = find_collision(pair->shape1, pair->shape2);
+    bench_consume(info.collided);
+  }
+}
+
+typedef struct batch {
+  job_system_t *jobs;
+  collision_pair_t pairs[BATCH_PAIRS];
+  collision_info_t results[BATCH_PAIRS];
+} batch_t;
+
+void bench_find_collisions(void *aux, size_t iterations) {
+  batch_t *batch = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    find_collisions(batch->jobs, batch->pairs, BATCH_PAIRS, batch->results);
+    bench_consume(batch->results[i % BATCH_PAIRS].collided);
+  }
+}
+
+int main(void) {
+  const size_t VERTEX_COUNTS[] = {4, 8, 16, 32, 64};
+  const size_t NUM_COUNTS = sizeof(VERTEX_COUNTS) / sizeof(*VERTEX_COUNTS);
+  const double RADIUS = 10;
+  for (size_t i = 0; i < NUM_COUNTS; i++) {
+    size_t n = VERTEX_COUNTS[i];
+    list_t *shape = bench_regular_polygon(n, RADIUS, (vector_t){0, 0});
+    // overlapping shapes test every axis; separated ones can stop early
+    list_t *overlapping =
+        bench_regular_polygon(n, RADIUS, (vector_t){RADIUS, RADIUS / 2});
+    list_t *separated =
+        bench_regular_polygon(n, RADIUS, (vector_t){4 * RADIUS, 0});
+    char name[64];
+
+    collision_pair_t pair = {shape, overlapping};
+    snprintf(name, sizeof(name), "find_collision/overlapping/%zu", n);
+    bench_run(name, bench_find_collision, &pair);
+
+    pair = (collision_pair_t){shape, separated};
+    snprintf(name, sizeof(name), "find_collision/separated/%zu", n);
+    bench_run(name, bench_find_collision, &pair);
+
+    list_free(shape);
+    list_free(overlapping);
+    list_free(separated);
+  }
+
+  // a batch of octagons in a row, each overlapping the next, on 1, 2, 4, ...
+  // threads, up to one per core
+  const size_t BATCH_VERTICES = 8;
+  batch_t *batch = malloc(sizeof(batch_t));
+  list_t *shapes[BATCH_PAIRS + 1];
+  for (size_t i = 0; i <= BATCH_PAIRS; i++) {
+    shapes[i] = bench_regular_polygon(BATCH_VERTICES, RADIUS,
+                                      (vector_t){i * 1.5 * RADIUS, 0});
+  }
+  for (size_t i = 0; i < BATCH_PAIRS; i++) {
+    batch->pairs[i] = (collision_pair_t){shapes[i], shapes[i + 1]};
+  }
+  job_system_t *all_cores = job_system_init(JOB_SYSTEM_ALL_CORES);
+  size_t max_threads = job_system_num_threads(all_cores);
+  job_system_free(all_cores);
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    batch->jobs = job_system_init(threads - 1);
+    char name[64];
+    snprintf(name, sizeof(name), "find_collisions/%d/threads=%zu",
+             BATCH_PAIRS, threads);
+    bench_run(name, bench_find_collisions, batch);
+    job_system_free(batch->jobs);
+  }
+  batch->jobs = NULL;
+  bench_run("find_collisions/2000/serial", bench_find_collisions, batch);
+  for (size_t i = 0; i <= BATCH_PAIRS; i++) {
+    list_free(shapes[i]);
+  }
+  free(batch);
+}
@@ -0,0 +1,53 @@
+#include "bench_util.h"
+#include "list.h"
+#include <stdio.h>
+
+// the number of elements added and removed per operation
+const size_t LIST_BATCH = 1000;
+
+void bench_list_add(void *aux, size_t iterations) {
+  int value = 0;
+  for (size_t i = 0; i < iterations; i++) {
+    list_t *list = list_init(1, NULL);
+    for (size_t j = 0; j < LIST_BATCH; j++) {
+      list_add(list, &value);
+    }
+    bench_consume(list_size(list));
+    list_free(list);
+  }
+}
+
+void bench_list_add_remove(void *aux, size_t iterations) {
+  list_t *list = aux;
+  int value = 0;
+  for (size_t i = 0; i < iterations; i++) {
+    for (size_t j = 0; j < LIST_BATCH; j++) {
+      list_add(list, &value);
+    }
+    while (list_size(list) > 0) {
+      list_remove(list, list_size(list) - 1);
+    }
+  }
+}
+
+void bench_list_remove_front(void *aux, size_t iterations) {
+  list_t *list = aux;
+  int value = 0;
+  for (size_t i = 0; i < iterations; i++) {
+    for (size_t j = 0; j < LIST_BATCH; j++) {
+      list_add(list, &value);
+    }
+    while (list_size(list) > 0) {
+      list_remove(list, 0);
+    }
+  }
+}
+
+int main(void) {
+  printf("(each operation is %zu elements)\n", LIST_BATCH);
+  bench_run("list_add/grow", bench_list_add, NULL);
+  list_t *list = list_init(LIST_BATCH, NULL);
+  bench_run("list_add+list_remove/back", bench_list_add_remove, list);
+  bench_run("list_add+list_remove/front", bench_list_remove_front, list);
+  list_free(list);
+}
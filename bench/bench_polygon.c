@@ -0,0 +1,31 @@
+#include "bench_util.h"
+#include "list.h"
+#include "polygon.h"
+#include <stdio.h>
+
+void bench_polygon_area(void *aux, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    bench_consume(polygon_area(aux));
+  }
+}
+
+void bench_polygon_centroid(void *aux, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    bench_consume(polygon_centroid(aux).x);
+  }
+}
+
+int main(void) {
+  const size_t VERTEX_COUNTS[] = {4, 16, 64, 256};
+  const size_t NUM_COUNTS = sizeof(VERTEX_COUNTS) / sizeof(*VERTEX_COUNTS);
+  for (size_t i = 0; i < NUM_COUNTS; i++) {
+    size_t n = VERTEX_COUNTS[i];
+    list_t *polygon = bench_regular_polygon(n, 10, (vector_t){5, 5});
+    char name[64];
+    snprintf(name, sizeof(name), "polygon_area/%zu", n);
+    bench_run(name, bench_polygon_area, polygon);
+    snprintf(name, sizeof(name), "polygon_centroid/%zu", n);
+    bench_run(name, bench_polygon_centroid, polygon);
+    list_free(polygon);
+  }
+}
@@ -0,0 +1,174 @@
+#include "bench_util.h"
+#include "body.h"
+#include "color.h"
+#include "forces.h"
+#include "job_system.h"
+#include "scene.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const double DT = 1.0 / 60;
+const double G = 10e3;
+const double GAMMA = 0.5;
+const double K = 20;
+const double ELASTICITY = 0.5;
+const double PLAYER_MASS = 100;
+const double OBSTACLE_MASS = 10;
+const double OBSTACLE_RADIUS = 15;
+const double OBSTACLE_SPACING = 40;
+const size_t OBSTACLES_PER_ROW = 100;
+const size_t CLUSTER_BODIES = 400;
+const double THETA = 0.5;
+const vector_t SCROLL_VELOCITY = {-200, 0};
+const rgb_color_t COLOR = {0, 0, 0};
+const uint32_t PLAYER = 1;
+const uint32_t OBSTACLE = 2;
+
+body_t *make_body(list_t *shape, double mass) {
+  info_t *info = info_init();
+  set_info_type(info, 0);
+  return body_init_with_info(shape, mass, COLOR, info, free, NULL);
+}
+
+/**
+ * Builds a scene shaped like a level of the game: one player body that
+ * collides with every other body, and obstacles scrolling past it.
+ * A share of the obstacles also have gravity, drag or a spring.
+ * The player's collisions are either one per obstacle, or one category
+ * contact that the spatial index finds the touching obstacles for.
+ */
+scene_t *make_level(size_t num_bodies, bool by_category) {
+  scene_t *scene = scene_init();
+  body_t *player = make_body(bench_regular_polygon(20, 30, (vector_t){100, 100}),
+                             PLAYER_MASS);
+  body_set_collision_filter(player, PLAYER, UINT32_MAX);
+  scene_add_body(scene, player);
+  if (by_category) {
+    create_category_physics_collision(scene, ELASTICITY, PLAYER, OBSTACLE);
+  }
+  create_earth_gravity(scene, G, player);
+  create_drag(scene, GAMMA, player);
+
+  body_t *previous = NULL;
+  for (size_t i = 1; i < num_bodies; i++) {
+    vector_t center = {(i % OBSTACLES_PER_ROW) * OBSTACLE_SPACING,
+                       (i / OBSTACLES_PER_ROW) * OBSTACLE_SPACING};
+    body_t *obstacle = make_body(
+        bench_regular_polygon(6, OBSTACLE_RADIUS, center), OBSTACLE_MASS);
+    body_set_velocity(obstacle, SCROLL_VELOCITY);
+    body_set_collision_filter(obstacle, OBSTACLE, UINT32_MAX);
+    scene_add_body(scene, obstacle);
+    if (!by_category) {
+      create_physics_collision(scene, ELASTICITY, player, obstacle);
+    }
+    if (i % 10 == 0) {
+      create_earth_gravity(scene, G, obstacle);
+    }
+    if (i % 5 == 0) {
+      create_drag(scene, GAMMA, obstacle);
+    }
+    if (i % 20 == 0 && previous != NULL) {
+      create_spring(scene, K, previous, obstacle);
+    }
+    previous = obstacle;
+  }
+  return scene;
+}
+
+/**
+ * Builds a cluster of bodies that all attract each other, so nearly all of
+ * the tick is spent in parallel force creators.
+ */
+scene_t *make_cluster(size_t num_bodies) {
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < num_bodies; i++) {
+    vector_t center = {(i % 20) * OBSTACLE_SPACING,
+                       (i / 20) * OBSTACLE_SPACING};
+    scene_add_body(scene, make_body(bench_regular_polygon(6, OBSTACLE_RADIUS,
+                                                          center),
+                                    OBSTACLE_MASS));
+  }
+  for (size_t i = 0; i < num_bodies; i++) {
+    for (size_t j = i + 1; j < num_bodies; j++) {
+      create_newtonian_gravity(scene, G, scene_get_body(scene, i),
+                               scene_get_body(scene, j));
+    }
+  }
+  return scene;
+}
+
+/**
+ * Builds a cluster like make_cluster(), but with one N-body gravity
+ * force creator instead of one per pair.
+ */
+scene_t *make_nbody_cluster(size_t num_bodies) {
+  const uint32_t CLUSTER = 1;
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < num_bodies; i++) {
+    vector_t center = {(i % 20) * OBSTACLE_SPACING,
+                       (i / 20) * OBSTACLE_SPACING};
+    body_t *body = make_body(
+        bench_regular_polygon(6, OBSTACLE_RADIUS, center), OBSTACLE_MASS);
+    body_set_collision_filter(body, CLUSTER, UINT32_MAX);
+    scene_add_body(scene, body);
+  }
+  create_nbody_gravity(scene, G, THETA, CLUSTER);
+  return scene;
+}
+
+void bench_scene_tick(void *aux, size_t iterations) {
+  scene_t *scene = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    scene_tick(scene, DT);
+  }
+  bench_consume(scene_bodies(scene));
+}
+
+int main(void) {
+  const size_t BODY_COUNTS[] = {100, 1000, 10000};
+  const size_t NUM_COUNTS = sizeof(BODY_COUNTS) / sizeof(*BODY_COUNTS);
+  for (size_t i = 0; i < NUM_COUNTS; i++) {
+    scene_t *scene = make_level(BODY_COUNTS[i], false);
+    char name[64];
+    snprintf(name, sizeof(name), "scene_tick/%zu", BODY_COUNTS[i]);
+    bench_run(name, bench_scene_tick, scene);
+    scene_free(scene);
+  }
+  for (size_t i = 0; i < NUM_COUNTS; i++) {
+    scene_t *scene = make_level(BODY_COUNTS[i], true);
+    char name[64];
+    snprintf(name, sizeof(name), "scene_tick/category_%zu", BODY_COUNTS[i]);
+    bench_run(name, bench_scene_tick, scene);
+    scene_free(scene);
+  }
+
+  // the force phase on 1, 2, 4, ... threads, up to one per core
+  scene_t *cluster = make_cluster(CLUSTER_BODIES);
+  job_system_t *all_cores = job_system_init(JOB_SYSTEM_ALL_CORES);
+  size_t max_threads = job_system_num_threads(all_cores);
+  job_system_free(all_cores);
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    job_system_t *jobs = job_system_init(threads - 1);
+    scene_set_job_system(cluster, jobs);
+    char name[64];
+    snprintf(name, sizeof(name), "scene_tick/gravity_%zu/threads=%zu",
+             CLUSTER_BODIES, threads);
+    bench_run(name, bench_scene_tick, cluster);
+    job_system_free(jobs);
+  }
+  scene_set_job_system(cluster, NULL);
+  bench_run("scene_tick/gravity_400/serial", bench_scene_tick, cluster);
+  scene_free(cluster);
+
+  const size_t NBODY_COUNTS[] = {CLUSTER_BODIES, 1000, 10000};
+  for (size_t i = 0; i < sizeof(NBODY_COUNTS) / sizeof(*NBODY_COUNTS); i++) {
+    scene_t *scene = make_nbody_cluster(NBODY_COUNTS[i]);
+    char name[64];
+    snprintf(name, sizeof(name), "scene_tick/nbody_gravity_%zu",
+             NBODY_COUNTS[i]);
+    bench_run(name, bench_scene_tick, scene);
+    scene_free(scene);
+  }
+}
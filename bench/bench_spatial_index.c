@@ -0,0 +1,122 @@
+#include "bench_util.h"
+#include "list.h"
+#include "polygon.h"
+#include "spatial_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+const double CELL_SIZE = 128;
+const double ITEM_RADIUS = 15;
+const double ITEM_SPACING = 40;
+const size_t ITEMS_PER_ROW = 100;
+// how far the items scroll each tick, as obstacles do at 60 ticks a second
+const double SCROLL_STEP = 200.0 / 60;
+// ticks before the items jump back to where they started
+const size_t SCROLL_TICKS = 1000;
+
+// items laid out like the obstacles of a level, and the index of them
+typedef struct level {
+  spatial_index_t *index;
+  list_t *results;
+  int *items;
+  // where each item starts, and where it is in the current tick
+  aabb_t *start;
+  aabb_t *bounds;
+  size_t num_items;
+  double speed;
+  size_t tick;
+} level_t;
+
+// moves every item on by one tick
+void level_move(level_t *level) {
+  level->tick++;
+  double offset = -(double)(level->tick % SCROLL_TICKS) * level->speed;
+  for (size_t i = 0; i < level->num_items; i++) {
+    level->bounds[i] = level->start[i];
+    level->bounds[i].min.x += offset;
+    level->bounds[i].max.x += offset;
+  }
+}
+
+level_t *level_init(size_t num_items, double speed) {
+  level_t *level = malloc(sizeof(level_t));
+  level->index = spatial_index_init(CELL_SIZE);
+  level->results = list_init(num_items, NULL);
+  level->items = malloc(num_items * sizeof(int));
+  level->start = malloc(num_items * sizeof(aabb_t));
+  level->bounds = malloc(num_items * sizeof(aabb_t));
+  level->num_items = num_items;
+  level->speed = speed;
+  level->tick = 0;
+  for (size_t i = 0; i < num_items; i++) {
+    vector_t center = {(i % ITEMS_PER_ROW) * ITEM_SPACING,
+                       (i / ITEMS_PER_ROW) * ITEM_SPACING};
+    level->start[i] = (aabb_t){
+        .min = {center.x - ITEM_RADIUS, center.y - ITEM_RADIUS},
+        .max = {center.x + ITEM_RADIUS, center.y + ITEM_RADIUS}};
+    spatial_index_insert(level->index, &level->items[i], level->start[i]);
+  }
+  return level;
+}
+
+void level_free(level_t *level) {
+  spatial_index_free(level->index);
+  list_free(level->results);
+  free(level->items);
+  free(level->start);
+  free(level->bounds);
+  free(level);
+}
+
+// one query near the player, as a tick's collision search makes
+void level_query(level_t *level) {
+  list_clear(level->results);
+  aabb_t near = {.min = {0, 0}, .max = {200, 200}};
+  spatial_index_query(level->index, near, level->results);
+  bench_consume(list_size(level->results));
+}
+
+void bench_index_rebuild(void *aux, size_t iterations) {
+  level_t *level = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    level_move(level);
+    spatial_index_clear(level->index);
+    for (size_t j = 0; j < level->num_items; j++) {
+      spatial_index_insert(level->index, &level->items[j], level->bounds[j]);
+    }
+    level_query(level);
+  }
+}
+
+void bench_index_update(void *aux, size_t iterations) {
+  level_t *level = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    level_move(level);
+    for (size_t j = 0; j < level->num_items; j++) {
+      spatial_index_update(level->index, j, level->bounds[j]);
+    }
+    level_query(level);
+  }
+}
+
+int main(void) {
+  const size_t ITEM_COUNTS[] = {1000, 10000};
+  const size_t NUM_COUNTS = sizeof(ITEM_COUNTS) / sizeof(*ITEM_COUNTS);
+  for (size_t i = 0; i < NUM_COUNTS; i++) {
+    size_t n = ITEM_COUNTS[i];
+    char name[64];
+    level_t *level = level_init(n, SCROLL_STEP);
+    snprintf(name, sizeof(name), "index_tick/rebuild/%zu", n);
+    bench_run(name, bench_index_rebuild, level);
+    snprintf(name, sizeof(name), "index_tick/update/%zu", n);
+    bench_run(name, bench_index_update, level);
+    level_free(level);
+    // nothing moves, as with a level's walls and floors
+    level = level_init(n, 0);
+    snprintf(name, sizeof(name), "index_tick/rebuild_static/%zu", n);
+    bench_run(name, bench_index_rebuild, level);
+    snprintf(name, sizeof(name), "index_tick/update_static/%zu", n);
+    bench_run(name, bench_index_update, level);
+    level_free(level);
+  }
+}
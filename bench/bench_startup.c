@@ -0,0 +1,125 @@
+/**
+ * Times starting the game and generating its levels, against the headless
+ * platform. Each result also counts the allocations it made.
+ */
+#include "asset_pack.h"
+#include "bench_util.h"
+#include "scene.h"
+#include "state.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const char PACK_PATH[] = "assets/images.pack";
+// touching one byte per page brings the whole mapping into memory
+const size_t PAGE_STRIDE = 4096;
+// defined in demo/beaver_run.c
+extern const size_t GROUND_SCENE_INDEX;
+extern const size_t WATER_SCENE_INDEX;
+extern const size_t SKY_SCENE_INDEX;
+void create_ground_scene(scene_t *scene, bool add_hud);
+void create_water_scene(scene_t *scene, bool add_hud);
+void create_sky_scene(scene_t *scene, bool add_hud);
+void add_forces(scene_t *scene, size_t index);
+void restart_game(state_t *state);
+
+typedef void (*create_level_t)(scene_t *scene, bool add_hud);
+
+typedef struct level {
+  create_level_t create;
+  size_t index;
+  scene_t *scene;
+} level_t;
+
+void bench_open_pack(void *aux, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    asset_pack_t *pack = asset_pack_open(PACK_PATH);
+    double sum = 0;
+    for (size_t p = 0; p < asset_pack_num_pages(pack); p++) {
+      asset_page_t page = asset_pack_get_page(pack, p);
+      size_t size = page.width * page.height * ASSET_PACK_BYTES_PER_PIXEL;
+      for (size_t offset = 0; offset < size; offset += PAGE_STRIDE) {
+        sum += page.pixels[offset];
+      }
+    }
+    bench_consume(sum);
+    asset_pack_close(pack);
+  }
+}
+
+void bench_init(void *aux, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    *(state_t **)aux = emscripten_init();
+  }
+}
+
+void bench_init_and_free(void *aux, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    emscripten_free(emscripten_init());
+  }
+}
+
+void bench_restart(void *aux, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    restart_game(aux);
+  }
+}
+
+void bench_create_level(void *aux, size_t iterations) {
+  level_t *level = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    scene_t *scene = scene_init();
+    level->create(scene, false);
+    bench_consume(scene_bodies(scene));
+    scene_free(scene);
+  }
+}
+
+// adds another set of the level's force creators each time
+void bench_add_forces(void *aux, size_t iterations) {
+  level_t *level = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    add_forces(level->scene, level->index);
+  }
+  bench_consume(scene_forcer_count(level->scene));
+}
+
+int main(void) {
+  // cold: the first time through, as when the game is loaded
+  asset_pack_t *pack = asset_pack_open(PACK_PATH);
+  if (pack != NULL) {
+    asset_pack_close(pack);
+    bench_once("cold/open_pack", bench_open_pack, NULL);
+  } else {
+    printf("no valid %s, so assets are not timed (run make pack)\n",
+           PACK_PATH);
+  }
+  state_t *state;
+  bench_once("cold/emscripten_init", bench_init, &state);
+  emscripten_free(state);
+  printf("peak resident memory after startup: %zu KiB\n",
+         bench_peak_rss_kib());
+
+  // warm: repeated, as when the game is restarted
+  bench_run("startup/emscripten_init+free", bench_init_and_free, NULL);
+  state = emscripten_init();
+  bench_run("startup/restart_game", bench_restart, state);
+  emscripten_free(state);
+
+  level_t levels[] = {{create_ground_scene, GROUND_SCENE_INDEX},
+                      {create_water_scene, WATER_SCENE_INDEX},
+                      {create_sky_scene, SKY_SCENE_INDEX}};
+  const char *names[] = {"ground", "water", "sky"};
+  for (size_t i = 0; i < sizeof(levels) / sizeof(*levels); i++) {
+    char name[64];
+    snprintf(name, sizeof(name), "level/create_%s_scene", names[i]);
+    bench_run(name, bench_create_level, &levels[i]);
+
+    levels[i].scene = scene_init();
+    levels[i].create(levels[i].scene, false);
+    snprintf(name, sizeof(name), "level/add_forces(%s)", names[i]);
+    bench_run(name, bench_add_forces, &levels[i]);
+    scene_free(levels[i].scene);
+  }
+}
@@ -1,3 +1,4 @@
+#include "audio.h"
 #include "body.h"
 #include "collision.h"
 #include "color.h"
@@ -9,7 +10,6 @@
 #include "state.h"
 #include "vector.h"
 #include "test_util.h"
-#include <SDL2/SDL.h>
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
@@ -27,6 +27,8 @@ const double g = 10e3;
 // window constants
 const vector_t WINDOW = (vector_t) {.x=1000, .y=500};
 const vector_t CENTER = (vector_t) {.x=500, .y=250};
+// bodies that scroll past this x position are removed
+const double REMOVE_X_POSITION = -100.0;
 
 // ball (simulates beaver)
 const double BALL_RAD = 30.0;
@@ -34,6 +36,8 @@ const rgb_color_t BALL_COLOR = (rgb_color_t){.r = 1.0, .g = 0, .b = 1.0};
 const double BALL_SPEED = 200;
 const double BALL_MASS = 100;
 const double WRAP_DIS = 20;
+// how far below the beaver something must be for it to jump off
+const double GROUND_PROBE = 2.0;
 const size_t INIT_LIVES = 5;
 const size_t BEAVER_SURFACE_IDX = 0;
 const size_t BEAVER_IDX = 1;
@@ -200,9 +204,7 @@ const size_t SKY_FONT_LIVE_IDX = 5;
 const size_t TRANSITION_FONT_SCORE_IDX = 6;
 const size_t END_FONT_SCORE_IDX = 7;
 
-const size_t NUM_SURFACES = 20;
 const size_t NUM_SCENES = 9;
-const size_t NUM_FONTS = 8;
 
 const size_t TIME_BETWEEN_SPACE = 1;
 
@@ -248,15 +250,32 @@ typedef struct state {
 } state_t;
 
 
-body_type_t *make_type_info(body_type_t type) {
-  body_type_t *info = malloc(sizeof(*info));
-  *info = type;
+// stored as an info_t, since the physics handlers read bodies' info_type()
+info_t *make_type_info(body_type_t type) {
+  info_t *info = info_init();
+  set_info_type(info, type);
   return info;
 }
 
 
 body_type_t get_type(body_t *body) {
-  return *(body_type_t *)body_get_info(body);
+  return info_type(body_get_info(body));
+}
+
+// each type of body is its own collision category
+uint32_t type_category(body_type_t type) { return (uint32_t)1 << type; }
+
+// the types the beaver stands on
+uint32_t ground_categories(void) {
+  return type_category(BRICK) | type_category(DOOR) |
+         type_category(BRICK_TOP) | type_category(BOARDER);
+}
+
+// adds a body whose category is its type, so it collides with the types
+// add_forces() sets up as soon as it is in the scene
+void add_typed_body(scene_t *scene, body_t *body) {
+  body_set_collision_filter(body, type_category(get_type(body)), UINT32_MAX);
+  scene_add_body(scene, body);
 }
 
 
@@ -327,7 +346,7 @@ void add_background(scene_t *scene, double length, double width, rgb_color_t col
                                      make_type_info(BACKGROUND), free, picture_init(index, length, width));
   body_set_velocity(body, VEC_ZERO);
   body_set_centroid(body, (vector_t){.x = length/2, .y = width/2});
-  scene_add_body(scene, body);
+  add_typed_body(scene, body);
 
 }
 
@@ -340,7 +359,7 @@ void add_beaver(scene_t *scene) {
   body_set_centroid(ball, CENTER);
   body_set_lives(ball, INIT_LIVES);
   body_set_score(ball, 0);
-  scene_add_body(scene, ball);
+  add_typed_body(scene, ball);
 }
 
 /* Adds a transition door to the scene*/
@@ -349,7 +368,7 @@ void add_door(scene_t *scene) {
   body_t *door = body_init_with_info(rect_init(DOOR_WIDTH, DOOR_LENGTH), DOOR_MASS, DOOR_COLOR, make_type_info(DOOR), free, NULL);
   body_set_velocity(door, BACKGROUND_SPEED);
   body_set_centroid(door, centroid);
-  scene_add_body(scene, door);
+  add_typed_body(scene, door);
 }
 
 /* Adds a coin to the scene*/
@@ -358,7 +377,7 @@ void add_one_coin(scene_t *scene, vector_t centroid) {
   body_set_velocity(coin, BACKGROUND_SPEED);
   body_set_centroid(coin, centroid);
   body_set_score(coin, COIN_SCORE);
-  scene_add_body(scene, coin);
+  add_typed_body(scene, coin);
 }
 
 /* Adds coins of random location on the ground in the scene*/
@@ -395,7 +414,7 @@ void add_one_ddl(scene_t *scene, vector_t centroid) {
   body_set_velocity(ddl, DDL_SPEED);
   body_set_centroid(ddl, centroid);
   body_set_score(ddl, DDL_SCORE);
-  scene_add_body(scene, ddl);
+  add_typed_body(scene, ddl);
 }
 
 /* Adds "moving" deadlines of random location on the ground*/
@@ -415,7 +434,7 @@ void add_one_ddl_non_ground(scene_t *scene, vector_t centroid) {
   body_set_velocity(ddl, DDL_SPEED);
   body_set_centroid(ddl, centroid);
   body_set_score(ddl, DDL_SCORE);
-  scene_add_body(scene, ddl);
+  add_typed_body(scene, ddl);
 }
 
 /* Adds "moving" deadlines of random location in water/sky*/
@@ -436,7 +455,7 @@ void add_one_bird(scene_t *scene, vector_t centroid) {
   body_set_velocity(bird, BIRD_SPEED);
   body_set_centroid(bird, centroid);
   body_set_score(bird, BIRD_SCORE);
-  scene_add_body(scene, bird);
+  add_typed_body(scene, bird);
 }
 
 /* Adds "moving" birds of random location in the scene*/
@@ -459,7 +478,7 @@ void add_one_fish(scene_t *scene, vector_t centroid) {
   body_set_velocity(fish, FISH_SPEED);
   body_set_centroid(fish, centroid);
   body_set_score(fish, FISH_SCORE);
-  scene_add_body(scene, fish);
+  add_typed_body(scene, fish);
 }
 
 /* Adds trash of random locations in the scene*/
@@ -483,7 +502,7 @@ void add_one_trash(scene_t *scene, vector_t centroid) {
   body_set_velocity(trash, TRASH_SPEED);
   body_set_centroid(trash, centroid);
   body_set_score(trash, TRASH_SCORE);
-  scene_add_body(scene, trash);
+  add_typed_body(scene, trash);
 }
 
 /* Adds trash of random locations in the scene*/
@@ -505,7 +524,7 @@ void add_one_brick_bottom(scene_t *scene, vector_t centroid) {
   body_t *brick = body_init_with_info(rect_init(BRICK_LENGTH, BRICK_WIDTH_BOTTOM), BRICK_MASS, BRICK_COLOR, make_type_info(BRICK), free, NULL);
   body_set_velocity(brick, BACKGROUND_SPEED);
   body_set_centroid(brick, (vector_t){.x =centroid.x, .y = centroid.y -7.5});
-  scene_add_body(scene, brick);
+  add_typed_body(scene, brick);
 }
 
 /* Add top part of the brick*/
@@ -514,7 +533,7 @@ void add_one_brick_top(scene_t *scene, vector_t centroid) {
   body_t *brick = body_init_with_info(rect_init(BRICK_LENGTH, BRICK_WIDTH_TOP), BRICK_MASS, BRICK_COLOR, make_type_info(BRICK_TOP), free, NULL);
   body_set_velocity(brick, BACKGROUND_SPEED);
   body_set_centroid(brick, (vector_t){.x =centroid.x, .y = centroid.y +2.5});
-  scene_add_body(scene, brick);
+  add_typed_body(scene, brick);
 }
 
 /* Add a brick*/
@@ -556,7 +575,7 @@ void add_one_slow_down(scene_t *scene, vector_t centroid, rgb_color_t color) {
     POWER_MASS, color, make_type_info(POWER_SLOW), free, NULL);
   body_set_velocity(slowdown, BACKGROUND_SPEED);
   body_set_centroid(slowdown, centroid);
-  scene_add_body(scene, slowdown);
+  add_typed_body(scene, slowdown);
 }
 
 
@@ -578,7 +597,7 @@ void add_one_double_points(scene_t *scene, vector_t centroid, rgb_color_t color)
     POWER_MASS, color, make_type_info(POWER_POINTS), free, NULL);
   body_set_velocity(double_points, BACKGROUND_SPEED);
   body_set_centroid(double_points, centroid);
-  scene_add_body(scene, double_points);
+  add_typed_body(scene, double_points);
 }
 
 
@@ -601,7 +620,7 @@ void add_one_shield(scene_t *scene, vector_t centroid, rgb_color_t color) {
   body_set_velocity(shield, BACKGROUND_SPEED);
   body_set_centroid(shield, centroid);
   body_set_lives(shield, 1);
-  scene_add_body(scene, shield);
+  add_typed_body(scene, shield);
 }
 
 /* Adds live power ups of random locations in the scene*/
@@ -622,7 +641,7 @@ void add_one_magnet(scene_t *scene, vector_t centroid, rgb_color_t color) {
     POWER_MASS, color, make_type_info(POWER_MAGNET), free, NULL);
   body_set_velocity(magnet, BACKGROUND_SPEED);
   body_set_centroid(magnet, centroid);
-  scene_add_body(scene, magnet);
+  add_typed_body(scene, magnet);
 }
 
 /* Adds live power ups of random locations in the scene*/
@@ -641,86 +660,51 @@ void add_many_magnets(scene_t *scene){
 void add_forces(scene_t *scene, size_t index)
 {
   body_t *ball = scene_get_body(scene, BEAVER_IDX);
-  size_t body_count = scene_bodies(scene);
-
-  // Add force creators with other bodies
-  for (size_t i = 0; i < body_count; i++) {
-    body_t *body = scene_get_body(scene, i);
+  uint32_t beaver = type_category(BALL);
+  // moving at the velocity the contact solver leaves keeps the beaver from
+  // sinking into what it stands on, and costs no more than the default
+  scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
 
-    switch (get_type(body)) 
-    {
-      case BACKGROUND:
-        if (index == GROUND_SCENE_INDEX)
-        {
-          create_earth_gravity(scene, G, ball);
-          create_normal_force(scene, G, ball, body);
-        }
-        else if (index == WATER_SCENE_INDEX)
-          create_buoyancy(scene, G, ball);
-        break;
-      case BRICK:
-        create_physics_collision(scene, BRICK_ELASTICITY, ball, body);
-        create_normal_force(scene, G, ball, body);
-        break;
-      case BRICK_TOP:
-        create_normal_force(scene, G, ball, body);
-        break;
-      case DOOR:
-        create_physics_collision(scene, BRICK_ELASTICITY, ball, body);
-        create_normal_force(scene, G, ball, body);
-        break;
-      case BOARDER:
-        create_normal_force(scene, G, ball, body);
-        break;
-      case DDL:
-        create_remove_collision(scene, ball, body);
-        break;
-      case COIN:
-        create_remove_collision(scene, ball, body);
-        break;
-      case BIRD:
-        create_remove_collision(scene, ball, body);
-        break;
-      case TRASH:
-        create_remove_collision(scene, ball, body);
-        break;
-      case FISH:
-        create_remove_collision(scene, ball, body);
-        break;
-      case POWER_SLOW:
-        create_slow_collision(scene, ball, body);
-        break;
-      case POWER_POINTS:
-        create_double_points_collision(scene, ball, body);
-        break;
-      case POWER_LIVE:
-        create_remove_collision(scene, ball, body);
-        break;
-      case POWER_MAGNET:
-        create_magnet_collision(scene, ball, body);
-        break;
-    }
+  if (index == GROUND_SCENE_INDEX)
+  {
+    create_earth_gravity(scene, G, ball);
+    create_category_normal_force(scene, beaver, type_category(BACKGROUND));
   }
+  else if (index == WATER_SCENE_INDEX)
+    create_buoyancy(scene, G, ball);
+
+  // the beaver bounces off bricks and doors, and stands on them
+  uint32_t solid = type_category(BRICK) | type_category(DOOR);
+  create_category_physics_collision(scene, BRICK_ELASTICITY, beaver, solid);
+  uint32_t ground = ground_categories();
+  create_category_normal_force(scene, beaver, ground);
+  // a jump can carry the beaver through a thin brick in one tick
+  body_set_ccd_categories(ball, ground);
+
+  // and collects everything else
+  create_category_remove_collision(
+      scene, beaver,
+      type_category(DDL) | type_category(COIN) | type_category(BIRD) |
+          type_category(TRASH) | type_category(FISH) |
+          type_category(POWER_LIVE));
+  create_category_slow_collision(scene, beaver, type_category(POWER_SLOW));
+  create_category_double_points_collision(scene, beaver,
+                                          type_category(POWER_POINTS));
+  create_category_magnet_collision(scene, beaver, type_category(POWER_MAGNET));
+  // the magnet power-up pulls in coins while it lasts
+  create_magnet_attractor(scene, g, ball, type_category(COIN), MAGNET_DISTANCE);
 }
 
 /* create ground scene */
-void create_ground_scene(scene_t *scene, list_t *loaded_surfaces, list_t *fonts)
+void create_ground_scene(scene_t *scene, bool add_hud)
 {
   // Add water background and beaver to the scene
   add_background(scene, GROUND_WIDTH, GROUND_HEIGHT, GROUND_COLOR, GROUND_SURFACE_IDX);
   add_beaver(scene);
-  
-  // set surfaces for the images in scene
-  if (loaded_surfaces != NULL)
-  {
-    scene_set_surfaces(scene, loaded_surfaces);
-  }
 
   // set text in scene
-  if (fonts != NULL)
+  if (add_hud)
   {
-    scene_set_fonts(scene, fonts);
-
     list_t *font_index = list_init(LEVELS_NUM_FONTS, free);
     size_t *int_0 = malloc(sizeof(size_t));
     *int_0 = GROUND_FONT_SCORE_IDX;
@@ -749,23 +733,15 @@ void create_ground_scene(scene_t *scene, list_t *loaded_surfaces, list_t *fonts)
 }
 
 /* create water scene */
-void create_water_scene(scene_t *scene, list_t *loaded_surfaces, list_t *fonts)
+void create_water_scene(scene_t *scene, bool add_hud)
 {
   // Add water background and beave to the scene
   add_background(scene, SKY_WIDTH, SKY_HEIGHT, WATER_COLOR, WATER_SURFACE_IDX);
   add_beaver(scene);
 
-  // set surfaces for the images in scene
-  if (loaded_surfaces != NULL)
-  {
-    scene_set_surfaces(scene, loaded_surfaces);
-  }
-
   // set text in scene
-  if (fonts != NULL)
+  if (add_hud)
   {
-    scene_set_fonts(scene, fonts);
-
     list_t *font_index = list_init(LEVELS_NUM_FONTS, free);
     size_t *int_2 = malloc(sizeof(size_t));
     *int_2 = WATER_FONT_SCORE_IDX;
@@ -794,23 +770,15 @@ void create_water_scene(scene_t *scene, list_t *loaded_surfaces, list_t *fonts)
 
 
 /* create sky scene*/
-void create_sky_scene(scene_t *scene, list_t *loaded_surfaces, list_t *fonts)
+void create_sky_scene(scene_t *scene, bool add_hud)
 {
   // Add sky background and beaver to the scene
   add_background(scene, SKY_WIDTH, SKY_HEIGHT, SKY_COLOR, SKY_SURFACE_IDX);
   add_beaver(scene);
 
-  // set surfaces for the images in scene
-  if (loaded_surfaces != NULL)
-  {
-    scene_set_surfaces(scene, loaded_surfaces);
-  }
-
   // set text in scene
-  if (fonts != NULL)
+  if (add_hud)
   {
-    scene_set_fonts(scene, fonts);
-
     list_t *font_index = list_init(LEVELS_NUM_FONTS, free);
     size_t *int_4 = malloc(sizeof(size_t));
     *int_4 = SKY_FONT_SCORE_IDX;
@@ -838,38 +806,24 @@ void create_sky_scene(scene_t *scene, list_t *loaded_surfaces, list_t *fonts)
 }
 
 /* create welcome page scene*/
-void create_welcome_scene(scene_t *scene, list_t *loaded_surfaces, size_t surface_idx)
+void create_welcome_scene(scene_t *scene, size_t surface_idx)
 {
   // Add transition background to the scene
   add_background(scene, TRANSITION_WIDTH, TRANSITION_HEIGHT, GROUND_COLOR, surface_idx);
-
-  // set surfaces for the images in scene
-  if (loaded_surfaces != NULL)
-  {
-    scene_set_surfaces(scene, loaded_surfaces);
-  }
 }
 
 /* create transition page scene*/ 
-void create_transition_scene(scene_t *scene, list_t *loaded_surfaces, list_t *fonts, size_t scene_idx)
+void create_transition_scene(scene_t *scene, bool add_hud, size_t scene_idx)
 {
 
   // Add transition background to the scene
   add_background(scene, TRANSITION_WIDTH, TRANSITION_HEIGHT, GROUND_COLOR, scene_idx);
   // Add beaver to the scene to get the previous score
   add_beaver(scene);
-  
-  // set surfaces for the images in scene
-  if (loaded_surfaces != NULL)
-  {
-    scene_set_surfaces(scene, loaded_surfaces);
-  }
 
   // set text in scene
-  if (fonts != NULL)
+  if (add_hud)
   {
-    scene_set_fonts(scene, fonts);
-
     list_t *font_index = list_init(TRANSITION_NUM_FONTS, free);
     size_t *int_num = malloc(sizeof(size_t));
     if (scene_idx == TRANSITION1_SURFACE_INDEX || scene_idx == TRANSITION2_SURFACE_INDEX){
@@ -910,6 +864,52 @@ bool lose_game(state_t *state, scene_t *scene, size_t curr_scene) {
 }
 
 
+/* rebuild every level and go back to the welcome page */
+void restart_game(state_t *state)
+{
+  // reset all scenes
+  for (size_t i = 0; i<NUM_SCENES; i++)
+  {
+    scene_reset(list_get(state->scenes, i));
+    scene_set_score(list_get(state->scenes, i), 0);
+  }
+
+  scene_t *ground = list_get(state->scenes, GROUND_SCENE_INDEX);
+  create_ground_scene(ground, false);
+  
+  scene_t *scene_transition_1 = list_get(state->scenes, GROUND_SCENE_INDEX + 1);
+  create_transition_scene(scene_transition_1, false, TRANSITION1_SURFACE_INDEX);
+
+  scene_t *water = list_get(state->scenes, WATER_SCENE_INDEX);
+  create_water_scene(water, false);
+
+  scene_t *scene_transition_2 = list_get(state->scenes, TRANSITION2_SCENE_INDEX);
+  create_transition_scene(scene_transition_2, false, TRANSITION2_SURFACE_INDEX);
+
+  scene_t *sky = list_get(state->scenes, SKY_SCENE_INDEX);
+  create_sky_scene(sky, false);
+
+  scene_t *scene_end = list_get(state->scenes, END_SCENE_INDEX); 
+  create_transition_scene(scene_end, false, END_SURFACE_INDEX);
+  
+  scene_t *lose = list_get(state->scenes, LOSE_SCENE_INDEX); 
+  create_transition_scene(lose, false, LOSE_SURFACE_INDEX);
+
+  state->curr_scene = 0;
+
+  // clear the points
+  state->total_points = 0;
+}
+
+// whether the beaver stands on something it can jump off
+bool beaver_on_ground(scene_t *scene) {
+  body_t *beaver = scene_get_body(scene, BEAVER_IDX);
+  scene_hit_t hit = scene_shapecast(
+      scene, body_borrow_shape(beaver), (vector_t){0, -GROUND_PROBE},
+      ground_categories() | type_category(BACKGROUND));
+  return hit.body != NULL;
+}
+
 void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
   
   scene_t *scene = list_get(state->scenes, state->curr_scene);
@@ -923,45 +923,14 @@ void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
         // check if all the levels are finished
         if (state->curr_scene >= NUM_SCENES-1)
         {
-          // reset all scenes
-          for (size_t i = 0; i<NUM_SCENES; i++)
-          {
-            scene_reset(list_get(state->scenes, i));
-            scene_set_score(list_get(state->scenes, i), 0);
-          }
-
-
-          scene_t *ground = list_get(state->scenes, GROUND_SCENE_INDEX);
-          create_ground_scene(ground, NULL, NULL);
-          
-          scene_t *scene_transition_1 = list_get(state->scenes, GROUND_SCENE_INDEX + 1);
-          create_transition_scene(scene_transition_1, NULL, NULL, TRANSITION1_SURFACE_INDEX);
-
-          scene_t *water = list_get(state->scenes, WATER_SCENE_INDEX);
-          create_water_scene(water, NULL, NULL);
-
-          scene_t *scene_transition_2 = list_get(state->scenes, TRANSITION2_SCENE_INDEX);
-          create_transition_scene(scene_transition_2, NULL, NULL, TRANSITION2_SURFACE_INDEX);
-
-          scene_t *sky = list_get(state->scenes, SKY_SCENE_INDEX);
-          create_sky_scene(sky, NULL, NULL);
-
-          scene_t *scene_end = list_get(state->scenes, END_SCENE_INDEX); 
-          create_transition_scene(scene_end, NULL, NULL, END_SURFACE_INDEX);
-          
-          scene_t *lose = list_get(state->scenes, LOSE_SCENE_INDEX); 
-          create_transition_scene(lose, NULL, NULL, LOSE_SURFACE_INDEX);
-
-          state->curr_scene = 0;
-
-          // clear the points
-          state->total_points = 0;
-          
+          restart_game(state);
         }
       }
 
       // hit space to jump
-      else if (state->last_hit_space > TIME_BETWEEN_SPACE && state->curr_scene == GROUND_SCENE_INDEX)
+      else if (state->last_hit_space > TIME_BETWEEN_SPACE &&
+               state->curr_scene == GROUND_SCENE_INDEX &&
+               beaver_on_ground(scene))
       {
         state->last_hit_space = 0;
         body_t *beaver = scene_get_body(scene, BEAVER_IDX);
@@ -1036,31 +1005,14 @@ void scene_fast_enemy(scene_t *scene){
   }
 }
 
-/* create newtonian attraction between the beaver and coins within the distance*/
-void scene_magnet(scene_t *scene){
-  body_t *beaver = scene_get_body(scene, BEAVER_IDX);
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *body = scene_get_body(scene, i);
-    if (get_type(body) == COIN){
-      vector_t position = body_get_centroid(body);
-      double dis = distance(position, body_get_centroid(beaver));
-      if (dis < MAGNET_DISTANCE){
-      create_newtonian_gravity(scene, g, beaver, body);
-      }
-    }
-  }
-}
-
 state_t *emscripten_init(void) {
-  srand(time(NULL));
   // Initialize scene
   vector_t min = VEC_ZERO;
   vector_t max = WINDOW;
-  list_t *loaded_surfaces = list_init(NUM_SURFACES, (free_func_t) SDL_FreeSurface);
-
-  list_t *fonts = list_init(NUM_FONTS, (free_func_t) free_text);
   
-  sdl_init(min, max, loaded_surfaces, fonts);
+  sdl_init(min, max);
+  // the platform picks the seed so recorded runs can be replayed
+  srand(sdl_seed());
   
   state_t *state = malloc(sizeof(state_t));
   state->last_hit_space = 1;
@@ -1070,47 +1022,47 @@ state_t *emscripten_init(void) {
   // create welcome scene
   scene_t *scene_welcome = scene_init();
   list_add(state->scenes, scene_welcome);
-  create_welcome_scene(scene_welcome, loaded_surfaces, WELCOME_SURFACE_INDEX);
+  create_welcome_scene(scene_welcome, WELCOME_SURFACE_INDEX);
 
   // create gameplay scene
   scene_t *scene_gameplay = scene_init();
   list_add(state->scenes, scene_gameplay);
-  create_welcome_scene(scene_gameplay, loaded_surfaces, GAMEPLAY_SURFACE_INDEX);
+  create_welcome_scene(scene_gameplay, GAMEPLAY_SURFACE_INDEX);
 
   // create ground scene
   scene_t *scene_ground = scene_init();
   list_add(state->scenes, scene_ground);
-  create_ground_scene(scene_ground, loaded_surfaces, fonts);
+  create_ground_scene(scene_ground, true);
 
   // create the first transition scene
   scene_t *scene_transition_1 = scene_init();
   list_add(state->scenes, scene_transition_1);
-  create_transition_scene(scene_transition_1, loaded_surfaces, fonts, TRANSITION1_SURFACE_INDEX);
+  create_transition_scene(scene_transition_1, true, TRANSITION1_SURFACE_INDEX);
 
   // create water scene
   scene_t *scene_water = scene_init();
   list_add(state->scenes, scene_water);
-  create_water_scene(scene_water, loaded_surfaces, fonts);
+  create_water_scene(scene_water, true);
 
   // create the second transition scene
   scene_t *scene_transition_2= scene_init();
   list_add(state->scenes, scene_transition_2);
-  create_transition_scene(scene_transition_2, loaded_surfaces, fonts, TRANSITION2_SURFACE_INDEX);
+  create_transition_scene(scene_transition_2, true, TRANSITION2_SURFACE_INDEX);
 
   // create the sky scene
   scene_t *scene_sky = scene_init();
   list_add(state->scenes, scene_sky);
-  create_sky_scene(scene_sky, loaded_surfaces, fonts);
+  create_sky_scene(scene_sky, true);
 
   // create endgame scene
   scene_t *scene_end = scene_init();
   list_add(state->scenes, scene_end);
-  create_transition_scene(scene_end, loaded_surfaces, fonts, END_SURFACE_INDEX);
+  create_transition_scene(scene_end, true, END_SURFACE_INDEX);
   
   // create lost game scene
   scene_t *scene_lose = scene_init();
   list_add(state->scenes, scene_lose);
-  create_transition_scene(scene_lose, loaded_surfaces, fonts, LOSE_SURFACE_INDEX);
+  create_transition_scene(scene_lose, true, LOSE_SURFACE_INDEX);
 
   // initialize state variables
   state->curr_scene = 0;
@@ -1124,6 +1076,22 @@ state_t *emscripten_init(void) {
   return state;
 }
 
+/* delete bodies that have scrolled out of the scene, except the beaver,
+   which the rest of the level still reads */
+void remove_scrolled_out(scene_t *scene)
+{
+  aabb_t removed_region = {.min = {-INFINITY, -INFINITY},
+                           .max = {REMOVE_X_POSITION, INFINITY}};
+  list_t *scrolled_out = scene_bodies_in_bounds(scene, removed_region);
+  for (size_t i = 0; i < list_size(scrolled_out); i++) {
+    body_t *body = list_get(scrolled_out, i);
+    if (body_get_centroid(body).x < REMOVE_X_POSITION && get_type(body) != BALL)
+    {
+      body_remove(body);
+    }
+  }
+}
+
 void emscripten_main(state_t *state) {
 
   // get current scene
@@ -1134,7 +1102,11 @@ void emscripten_main(state_t *state) {
   if (state->curr_scene == WELCOME_SCENE_INDEX || state->curr_scene % 2 == 1 || state->curr_scene == LOSE_SCENE_INDEX)
   {
     if (!sdl_is_done(state)) {
-      sdl_render_scene(scene, 0.0);
+      sdl_begin_phase(PHASE_PHYSICS);
+      scene_tick(scene, 0.0);
+      sdl_begin_phase(PHASE_RENDER);
+      sdl_render_scene(scene);
+      sdl_begin_phase(PHASE_LOGIC);
     }
     finish_level(state);
   }
@@ -1184,7 +1156,6 @@ void emscripten_main(state_t *state) {
           state->state_magnet = true;
         }
         state->time_elapsed_magnet += dt;
-        scene_magnet(scene);
       }
       if (state->time_elapsed_magnet >= POWER_UP_TIME){
         state->time_elapsed_magnet = 0.0;
@@ -1192,7 +1163,21 @@ void emscripten_main(state_t *state) {
         body_set_magnet(beaver, false);
       }
 
-      sdl_render_scene(scene, dt);
+      // collisions change the beaver's score and lives during the tick
+      double score_before_tick = body_get_score(beaver);
+      size_t lives_before_tick = body_get_lives(beaver);
+      sdl_begin_phase(PHASE_PHYSICS);
+      scene_tick(scene, dt);
+      remove_scrolled_out(scene);
+      sdl_begin_phase(PHASE_RENDER);
+      sdl_render_scene(scene);
+      sdl_begin_phase(PHASE_LOGIC);
+      if (body_get_lives(beaver) < lives_before_tick) {
+        audio_play_sound(SOUND_HIT);
+      }
+      else if (body_get_score(beaver) > score_before_tick) {
+        audio_play_sound(SOUND_COIN);
+      }
       wrap_around(state);
     }
     
@@ -0,0 +1,115 @@
+#ifndef __ALLOC_TRACK_H__
+#define __ALLOC_TRACK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Counts the heap use of each part of the engine.
+ *
+ * A library file opts in by defining ALLOC_SUBSYSTEM before including this
+ * header after <stdlib.h>; its malloc, calloc, realloc and free calls then
+ * go through the tracker. Tracking is off until alloc_track_enable() is
+ * called, and while it is off the calls go straight to the allocator.
+ * Memory may be freed by a different subsystem than allocated it;
+ * it is still counted against the one that allocated it.
+ */
+
+/**
+ * The parts of the engine whose allocations are counted separately.
+ */
+typedef enum {
+  ALLOC_LIST,
+  ALLOC_BODY,
+  ALLOC_FORCES,
+  ALLOC_COLLISION,
+  ALLOC_SCENE,
+  ALLOC_JOBS,
+  ALLOC_PLATFORM,
+  NUM_ALLOC_SUBSYSTEMS
+} alloc_subsystem_t;
+
+/**
+ * The heap use of one subsystem since tracking was enabled or last reset.
+ */
+typedef struct alloc_stats {
+  // calls to malloc, calloc and realloc
+  size_t allocations;
+  size_t frees;
+  // bytes requested by those calls
+  size_t bytes;
+  // bytes allocated and not yet freed, and the most there have been at once
+  size_t live_bytes;
+  size_t peak_bytes;
+} alloc_stats_t;
+
+/**
+ * Starts counting allocations.
+ */
+void alloc_track_enable(void);
+
+/**
+ * Stops counting allocations and forgets what has been counted.
+ */
+void alloc_track_disable(void);
+
+/**
+ * Returns whether allocations are being counted.
+ *
+ * @return true if alloc_track_enable() has been called and not disabled
+ */
+bool alloc_track_enabled(void);
+
+/**
+ * Sets every subsystem's counts back to zero.
+ * Live bytes are kept, and the peaks restart from them.
+ */
+void alloc_track_reset(void);
+
+/**
+ * Gets the heap use of one subsystem.
+ *
+ * @param subsystem the subsystem to look up
+ * @return its counts since tracking was enabled or last reset
+ */
+alloc_stats_t alloc_track_stats(alloc_subsystem_t subsystem);
+
+/**
+ * Gets the number of allocations made by every subsystem together.
+ * Comparing two readings tells whether the code between them allocated.
+ *
+ * @return the allocations since tracking was enabled or last reset
+ */
+size_t alloc_track_total(void);
+
+/**
+ * Gets the name of a subsystem, for reports.
+ *
+ * @param subsystem the subsystem
+ * @return its name, e.g. "list"
+ */
+const char *alloc_subsystem_name(alloc_subsystem_t subsystem);
+
+/**
+ * Prints every subsystem's counts, one line each.
+ */
+void alloc_track_print(void);
+
+/**
+ * The tracked allocator. Use malloc() and the rest in a file that defines
+ * ALLOC_SUBSYSTEM; the macros below call these with the right subsystem.
+ */
+void *track_malloc(alloc_subsystem_t subsystem, size_t size);
+void *track_calloc(alloc_subsystem_t subsystem, size_t count, size_t size);
+void *track_realloc(alloc_subsystem_t subsystem, void *ptr, size_t size);
+void track_free(void *ptr);
+
+#ifdef ALLOC_SUBSYSTEM
+#define malloc(size) track_malloc(ALLOC_SUBSYSTEM, size)
+#define calloc(count, size) track_calloc(ALLOC_SUBSYSTEM, count, size)
+#define realloc(ptr, size) track_realloc(ALLOC_SUBSYSTEM, ptr, size)
+// not a function-like macro, so free can still be passed as a free_func_t
+#define free track_free
+#endif
+
+#endif // #ifndef __ALLOC_TRACK_H__
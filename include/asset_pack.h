@@ -0,0 +1,143 @@
+#ifndef __ASSET_PACK_H__
+#define __ASSET_PACK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Every pixel in a pack is 4 bytes, in R, G, B, A byte order
+ * (SDL_PIXELFORMAT_RGBA32), so pages can be uploaded without converting.
+ */
+extern const size_t ASSET_PACK_BYTES_PER_PIXEL;
+
+/**
+ * Images are stored on pages of raw pixels.
+ * Large images get a page to themselves; small sprites share atlas pages.
+ * The pixels of a page are rows of width pixels, with no padding.
+ */
+typedef struct asset_page {
+  size_t width;
+  size_t height;
+  const uint8_t *pixels;
+} asset_page_t;
+
+/**
+ * Where an image sits in a pack: the page it is on
+ * and the rectangle it covers on that page.
+ * The name points into the pack's mapping, like the pages' pixels.
+ */
+typedef struct asset_image {
+  const char *name;
+  size_t page;
+  size_t x;
+  size_t y;
+  size_t width;
+  size_t height;
+} asset_image_t;
+
+/**
+ * Collects images and lays them out into pages before writing a pack file.
+ * Used by the build-time packer.
+ */
+typedef struct asset_pack_writer asset_pack_writer_t;
+
+/**
+ * A pack file mapped into memory.
+ * The pages point straight into the mapping, so they are only valid
+ * until the pack is closed.
+ */
+typedef struct asset_pack asset_pack_t;
+
+/**
+ * Allocates memory for a writer with no images.
+ * Asserts that the memory was allocated.
+ *
+ * @return the new writer
+ */
+asset_pack_writer_t *asset_pack_writer_init(void);
+
+/**
+ * Releases the memory allocated for a writer.
+ *
+ * @param writer a pointer to a writer returned from asset_pack_writer_init()
+ */
+void asset_pack_writer_free(asset_pack_writer_t *writer);
+
+/**
+ * Adds an image to a writer. The name and pixels are copied.
+ * Images are numbered in the order they are added.
+ *
+ * @param writer a pointer to a writer returned from asset_pack_writer_init()
+ * @param name the name to store with the image, e.g. the file it came from,
+ *   so readers can check that the pack holds the images they expect
+ * @param width the width of the image in pixels (must be positive)
+ * @param height the height of the image in pixels (must be positive)
+ * @param pixels width * height RGBA32 pixels, row by row
+ * @return the index of the image in the pack
+ */
+size_t asset_pack_writer_add(asset_pack_writer_t *writer, const char *name,
+                             size_t width, size_t height,
+                             const uint8_t *pixels);
+
+/**
+ * Lays out the added images into pages and writes them to a pack file.
+ *
+ * @param writer a pointer to a writer returned from asset_pack_writer_init()
+ * @param path the file to write
+ * @return true if the file was written, false otherwise
+ */
+bool asset_pack_writer_save(asset_pack_writer_t *writer, const char *path);
+
+/**
+ * Maps a pack file into memory.
+ *
+ * @param path the pack file to open
+ * @return the pack, or NULL if the file is missing or is not a valid pack
+ */
+asset_pack_t *asset_pack_open(const char *path);
+
+/**
+ * Unmaps a pack file and releases its memory.
+ *
+ * @param pack a pointer to a pack returned from asset_pack_open()
+ */
+void asset_pack_close(asset_pack_t *pack);
+
+/**
+ * Gets the number of images in a pack.
+ *
+ * @param pack a pointer to a pack returned from asset_pack_open()
+ * @return the number of images
+ */
+size_t asset_pack_num_images(asset_pack_t *pack);
+
+/**
+ * Gets the number of pages in a pack.
+ *
+ * @param pack a pointer to a pack returned from asset_pack_open()
+ * @return the number of pages
+ */
+size_t asset_pack_num_pages(asset_pack_t *pack);
+
+/**
+ * Gets a page of a pack.
+ * Asserts that the index is valid.
+ *
+ * @param pack a pointer to a pack returned from asset_pack_open()
+ * @param index the index of the page
+ * @return the page's size and pixels
+ */
+asset_page_t asset_pack_get_page(asset_pack_t *pack, size_t index);
+
+/**
+ * Gets where an image is stored in a pack.
+ * Asserts that the index is valid.
+ *
+ * @param pack a pointer to a pack returned from asset_pack_open()
+ * @param index the index of the image, in the order it was added
+ * @return the image's name, page and rectangle
+ */
+asset_image_t asset_pack_get_image(asset_pack_t *pack, size_t index);
+
+#endif // #ifndef __ASSET_PACK_H__
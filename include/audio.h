@@ -0,0 +1,66 @@
+#ifndef __AUDIO_H__
+#define __AUDIO_H__
+
+#include <stdbool.h>
+
+/**
+ * The short sound effects the game can play.
+ * Each one is loaded once by audio_init().
+ */
+typedef enum { SOUND_COIN, SOUND_HIT, NUM_SOUNDS } sound_t;
+
+/**
+ * Loads the background music and every sound effect, and sets up the
+ * mixing channels sound effects are played on.
+ * Must be called after the audio device is opened with Mix_OpenAudio().
+ * Files that fail to load are reported once here; playing them later
+ * does nothing.
+ */
+void audio_init(void);
+
+/**
+ * Releases the music and sound effects loaded by audio_init().
+ * Must be called before the audio device is closed.
+ */
+void audio_free(void);
+
+/**
+ * Starts looping the background music from the beginning.
+ */
+void audio_play_music(void);
+
+/**
+ * Stops the background music immediately.
+ */
+void audio_stop_music(void);
+
+/**
+ * Starts looping the background music, raising its volume from silence.
+ *
+ * @param ms the length of the fade in milliseconds
+ */
+void audio_fade_in_music(int ms);
+
+/**
+ * Lowers the volume of the background music to silence, then stops it.
+ *
+ * @param ms the length of the fade in milliseconds
+ */
+void audio_fade_out_music(int ms);
+
+/**
+ * Returns whether the background music is currently playing.
+ *
+ * @return true if music is playing (including while fading), false otherwise
+ */
+bool audio_music_playing(void);
+
+/**
+ * Plays a sound effect once on the sound effect channels.
+ * If every channel is busy, the sound that has played the longest is cut off.
+ *
+ * @param sound the sound effect to play
+ */
+void audio_play_sound(sound_t sound);
+
+#endif // #ifndef __AUDIO_H__
@@ -0,0 +1,89 @@
+#ifndef __BARNES_HUT_H__
+#define __BARNES_HUT_H__
+
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A quadtree over point masses that estimates the gravity on each of them
+ * in O(log n) time instead of O(n).
+ * See https://en.wikipedia.org/wiki/Barnes%E2%80%93Hut_simulation.
+ *
+ * Each node of the tree stores the total mass and the center of mass of the
+ * points inside it. A point far enough from a node is pulled by the node as
+ * if all of its mass were at its center of mass, instead of by each point.
+ *
+ * The tree is rebuilt by clearing it, adding every point again and building
+ * it; its internal buffers are kept between rebuilds.
+ */
+typedef struct barnes_hut barnes_hut_t;
+
+/**
+ * Allocates memory for an empty tree.
+ * Asserts that the memory was allocated.
+ *
+ * @return the new tree
+ */
+barnes_hut_t *barnes_hut_init(void);
+
+/**
+ * Releases the memory allocated for a tree.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ */
+void barnes_hut_free(barnes_hut_t *tree);
+
+/**
+ * Removes every point from a tree, keeping its allocated buffers.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ */
+void barnes_hut_clear(barnes_hut_t *tree);
+
+/**
+ * Adds a point mass to a tree.
+ * barnes_hut_build() must be called before the tree is queried again.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ * @param position the point's position
+ * @param mass the point's mass (must be finite and not negative)
+ * @return the point's index, counting from 0 since the last clear
+ */
+size_t barnes_hut_add(barnes_hut_t *tree, vector_t position, double mass);
+
+/**
+ * Gets the number of points in a tree.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ * @return the number of points added since the last clear
+ */
+size_t barnes_hut_size(barnes_hut_t *tree);
+
+/**
+ * Builds the quadtree over the points added since the last clear.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ */
+void barnes_hut_build(barnes_hut_t *tree);
+
+/**
+ * Estimates the gravitational field at one of a tree's points,
+ * i.e. the sum over every other point of its mass divided by the squared
+ * distance to it, in the direction of it.
+ * Multiplying by G and the point's mass gives the force on the point.
+ *
+ * A node whose width divided by its distance from the point is less than
+ * theta is treated as one mass; 0 computes the exact sum over every point.
+ * Points at the same position do not pull each other.
+ *
+ * @param tree a pointer to a tree built with barnes_hut_build()
+ * @param point the index of the point, as returned by barnes_hut_add()
+ * @param theta the opening angle (0.5 is a common choice)
+ * @param min_distance the distance below which points are treated as
+ *   being this far apart, so the field does not blow up
+ * @return the field at the point
+ */
+vector_t barnes_hut_field(barnes_hut_t *tree, size_t point, double theta,
+                          double min_distance);
+
+#endif // #ifndef __BARNES_HUT_H__
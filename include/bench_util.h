@@ -0,0 +1,118 @@
+/** Common functions for benchmarks. */
+
+#ifndef __BENCH_UTIL_H__
+#define __BENCH_UTIL_H__
+
+#include "list.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * The code being measured.
+ * Each call must perform the operation `iterations` times.
+ *
+ * @param aux the auxiliary value passed to bench_run()
+ * @param iterations how many times to perform the operation
+ */
+typedef void (*bench_func_t)(void *aux, size_t iterations);
+
+/**
+ * The timing of one benchmark, in nanoseconds per operation.
+ * The mean and standard deviation are taken over the repetitions.
+ * Allocations are averaged over every operation that was timed.
+ */
+typedef struct bench_result {
+  double mean_ns;
+  double stddev_ns;
+  double min_ns;
+  size_t repetitions;
+  size_t iterations;
+  double allocations_per_op;
+  double bytes_per_op;
+} bench_result_t;
+
+/**
+ * Heap use since the last call to bench_alloc_reset().
+ * Benchmarks are linked with malloc, calloc, realloc and free wrapped
+ * (-Wl,--wrap=malloc and so on), which is how these are counted.
+ */
+typedef struct bench_alloc_stats {
+  // calls to malloc, calloc and realloc
+  size_t allocations;
+  size_t frees;
+  // bytes requested by those calls
+  size_t bytes;
+  // the most heap memory that was allocated at once
+  size_t peak_bytes;
+} bench_alloc_stats_t;
+
+/**
+ * Returns a monotonic timestamp in seconds, for timing code directly.
+ *
+ * @return the current time in seconds since an arbitrary point
+ */
+double bench_now(void);
+
+/**
+ * Times a benchmark and prints its result as one line.
+ * The number of iterations is first raised until one call takes a
+ * measurable amount of time; the call is then repeated BENCH_REPS times
+ * (10 unless the BENCH_REPS environment variable says otherwise).
+ *
+ * @param name the name printed with the result
+ * @param func the code to time
+ * @param aux a value passed to each call of func
+ * @return the timing of the benchmark
+ */
+bench_result_t bench_run(const char *name, bench_func_t func, void *aux);
+
+/**
+ * Times a single call, for costs that are only paid once such as startup.
+ * Prints the time, the allocations and the peak heap use of the call.
+ *
+ * @param name the name printed with the result
+ * @param func the code to time; it is called once with iterations = 1
+ * @param aux a value passed to func
+ * @return the time taken by the call in nanoseconds
+ */
+double bench_once(const char *name, bench_func_t func, void *aux);
+
+/**
+ * Starts counting allocations from zero.
+ * The peak is measured from the memory that is allocated now.
+ */
+void bench_alloc_reset(void);
+
+/**
+ * Gets the heap use since the last call to bench_alloc_reset().
+ *
+ * @return the allocation counts and the peak heap use
+ */
+bench_alloc_stats_t bench_alloc_stats(void);
+
+/**
+ * Gets the most memory the process has had resident at once.
+ *
+ * @return the peak resident set size in kibibytes
+ */
+size_t bench_peak_rss_kib(void);
+
+/**
+ * Allocates a regular polygon, the usual input shape for benchmarks.
+ *
+ * @param num_vertices the number of vertices (at least 3)
+ * @param radius the distance from the center to each vertex
+ * @param center the center of the polygon
+ * @return a list of vector_t* vertices in counterclockwise order
+ */
+list_t *bench_regular_polygon(size_t num_vertices, double radius,
+                              vector_t center);
+
+/**
+ * Uses a value so the compiler cannot optimize away the code computing it.
+ *
+ * @param value a result computed by the benchmarked code
+ */
+void bench_consume(double value);
+
+#endif // #ifndef __BENCH_UTIL_H__
@@ -3,9 +3,11 @@
 
 #include "color.h"
 #include "list.h"
+#include "polygon.h"
 #include "vector.h"
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * A rigid body constrained to the plane.
@@ -25,6 +27,14 @@ typedef struct info info_t;
  */
 typedef struct picture picture_t;
 
+/**
+ * Forces and impulses recorded on one thread, to be added to their bodies
+ * later. While a log is active on a thread, body_add_force() and
+ * body_add_impulse() on that thread append to it and leave the body alone,
+ * so several threads can apply forces to the same bodies at once.
+ */
+typedef struct force_log force_log_t;
+
 /**
  * Allocates memory for an empty info.
  *
@@ -135,6 +145,17 @@ void body_free(body_t *body);
  */
 list_t *body_get_shape(body_t *body);
 
+/**
+ * Gets the current shape of a body without copying it.
+ * The list belongs to the body: it must not be modified or freed,
+ * and it changes when the body moves.
+ * Use this instead of body_get_shape() in code that runs every tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the polygon describing the body's current position
+ */
+list_t *body_borrow_shape(body_t *body);
+
 /**
  * Gets the current center of mass of a body.
  * While this could be calculated with polygon_centroid(), that becomes too slow
@@ -146,6 +167,16 @@ list_t *body_get_shape(body_t *body);
  */
 vector_t body_get_centroid(body_t *body);
 
+/**
+ * Gets the current axis-aligned bounding box of a body.
+ * The box is cached and kept up to date as the body moves,
+ * so this is cheap enough to call on every body every tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the smallest axis-aligned box containing the body's shape
+ */
+aabb_t body_get_bounds(body_t *body);
+
 /**
  * Gets the current velocity of a body.
  *
@@ -292,6 +323,41 @@ void body_add_force(body_t *body, vector_t force);
  */
 void body_add_impulse(body_t *body, vector_t impulse);
 
+/**
+ * Allocates memory for an empty force log.
+ *
+ * @return the new force log
+ */
+force_log_t *force_log_init(void);
+
+/**
+ * Releases the memory allocated for a force log.
+ *
+ * @param log a pointer to a log returned from force_log_init()
+ */
+void force_log_free(force_log_t *log);
+
+/**
+ * Empties a force log and makes it the active log of the calling thread,
+ * until force_log_end() is called on the same thread.
+ *
+ * @param log a pointer to a log returned from force_log_init()
+ */
+void force_log_begin(force_log_t *log);
+
+/**
+ * Stops recording into the calling thread's active force log.
+ */
+void force_log_end(void);
+
+/**
+ * Adds the recorded forces and impulses to their bodies,
+ * in the order they were recorded.
+ *
+ * @param log a pointer to a log returned from force_log_init()
+ */
+void force_log_apply(force_log_t *log);
+
 /**
  * Updates the body after a given time interval has elapsed.
  * Sets acceleration and velocity according to the forces and impulses
@@ -305,6 +371,17 @@ void body_add_impulse(body_t *body, vector_t impulse);
  */
 void body_tick(body_t *body, double dt);
 
+/**
+ * Computes how far body_tick() would translate a body,
+ * given the forces and impulses applied to it so far this tick.
+ * Does not change the body.
+ *
+ * @param body the body to predict the motion of
+ * @param dt the number of seconds the next tick lasts
+ * @return the translation of the body's centroid over the tick
+ */
+vector_t body_get_motion(body_t *body, double dt);
+
 /**
  * Marks a body for removal--future calls to body_is_removed() will return true.
  * Does not free the body.
@@ -340,6 +417,14 @@ vector_t body_get_force(body_t *body);
  */
 vector_t body_get_impulse(body_t *body);
 
+/**
+ * Discards the forces and impulses applied to a body since the last tick,
+ * without moving it.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_clear_forces(body_t *body);
+
 /**
  * Add a certain velocity to the current velocity of the body
  *
@@ -392,4 +477,54 @@ void body_set_magnet(body_t *body, bool true_or_false);
  */
 bool body_get_magnet(body_t *body);
 
+/**
+ * Sets which collision categories a body is in, and which categories
+ * it can collide with. Scenes use these to find the pairs of bodies
+ * that category contacts apply to (see scene_add_category_contact()).
+ * A new body is in no category and can collide with every category.
+ *
+ * @param body the body to set the categories of
+ * @param category a bit for each category the body is in
+ * @param mask a bit for each category the body can collide with
+ */
+void body_set_collision_filter(body_t *body, uint32_t category, uint32_t mask);
+
+/**
+ * Gets the collision categories a body is in.
+ *
+ * @param body the body to get the categories of
+ * @return a bit for each category the body is in
+ */
+uint32_t body_get_category(body_t *body);
+
+/**
+ * Gets the collision categories a body can collide with.
+ *
+ * @param body the body to get the mask of
+ * @return a bit for each category the body can collide with
+ */
+uint32_t body_get_mask(body_t *body);
+
+/**
+ * Marks a body as fast, so that it cannot pass through thin bodies
+ * in a single tick. Scenes sweep a fast body along its motion each tick
+ * and stop it where it first touches a body in the given categories,
+ * so the collision is found on the next tick (see scene_tick()).
+ * A new body is not fast.
+ *
+ * @param body the body to mark
+ * @param categories a bit for each category of bodies the body must not
+ *   pass through, or 0 to stop sweeping the body
+ */
+void body_set_ccd_categories(body_t *body, uint32_t categories);
+
+/**
+ * Gets the categories of the bodies a fast body is swept against.
+ *
+ * @param body the body to get the categories of
+ * @return the categories set with body_set_ccd_categories(),
+ *   or 0 if the body is not fast
+ */
+uint32_t body_get_ccd_categories(body_t *body);
+
 #endif // #ifndef __BODY_H__
@@ -2,6 +2,7 @@
 #define __COLLISION_H__
 
 #include <stdbool.h>
+#include "job_system.h"
 #include "list.h"
 #include "vector.h"
 
@@ -19,6 +20,12 @@ typedef struct {
      * If collided is false, this value is undefined.
      */
     vector_t axis;
+    /**
+     * If the shapes are colliding, how far they overlap along the axis.
+     * Moving shape2 this far along the axis separates them.
+     * If collided is false, this value is 0.
+     */
+    double depth;
 } collision_info_t;
 
 /**
@@ -29,9 +36,83 @@ typedef struct {
  *
  * @param shape1 the first shape
  * @param shape2 the second shape
- * @return whether the shapes are colliding, and if so, the collision axis.
- * The axis should be a unit vector pointing from shape1 towards shape2.
+ * @return whether the shapes are colliding, and if so, the collision axis
+ * and depth. The axis should be a unit vector pointing from shape1
+ * towards shape2.
  */
 collision_info_t find_collision(list_t *shape1, list_t *shape2);
 
+/**
+ * Two shapes to test for collision with find_collisions().
+ */
+typedef struct {
+    list_t *shape1;
+    list_t *shape2;
+} collision_pair_t;
+
+/**
+ * Computes find_collision() for many pairs of shapes.
+ * The tests only read the shapes, so they are split into chunks
+ * that run on a job system's threads.
+ *
+ * @param jobs the job system to run the tests on,
+ *   or NULL to run them all on the calling thread
+ * @param pairs the pairs of shapes to test
+ * @param num_pairs the number of pairs
+ * @param results an array of at least num_pairs elements;
+ *   results[i] is set to the status of the collision in pairs[i]
+ */
+void find_collisions(job_system_t *jobs, collision_pair_t *pairs,
+                     size_t num_pairs, collision_info_t *results);
+
+/**
+ * Represents when a moving shape first touches another shape.
+ */
+typedef struct {
+    /** Whether the shapes touch during the motion */
+    bool collided;
+    /**
+     * If the shapes touch, the fraction of the motion at which they first
+     * touch, between 0 and 1. It is 0 if they already overlap at the start.
+     */
+    double time;
+    /**
+     * If the shapes touch after the start, the axis they touch along:
+     * a unit vector pointing from the first shape towards the second.
+     * If they already overlap at the start, it is undefined.
+     */
+    vector_t axis;
+} collision_sweep_t;
+
+/**
+ * Finds the first time two convex polygons touch while they move in
+ * straight lines, so fast shapes cannot skip over thin ones between two
+ * calls to find_collision().
+ * The shapes are given as in find_collision(), at their positions before
+ * moving. Only the motion of shape1 relative to shape2 matters.
+ *
+ * @param shape1 the first shape
+ * @param motion1 how far the first shape moves
+ * @param shape2 the second shape
+ * @param motion2 how far the second shape moves
+ * @return whether the shapes touch during the motion, and if so,
+ *   when they first touch and along which axis
+ */
+collision_sweep_t find_time_of_impact(list_t *shape1, vector_t motion1,
+                                      list_t *shape2, vector_t motion2);
+
+/**
+ * Finds where a line segment first enters a convex polygon,
+ * i.e. the time of impact of a point moving along the segment.
+ *
+ * @param origin the start of the segment
+ * @param motion the segment's end minus its start
+ * @param shape the polygon, as in find_collision()
+ * @return whether the segment touches the polygon, and if so, the fraction
+ *   of the segment before it first touches and the axis from the segment
+ *   into the polygon's surface (undefined if it starts inside)
+ */
+collision_sweep_t find_ray_impact(vector_t origin, vector_t motion,
+                                  list_t *shape);
+
 #endif // #ifndef __COLLISION_H__
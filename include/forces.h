@@ -8,17 +8,6 @@
 
 #include "scene.h"
 
-/**
- * A function called when a collision occurs.
- * @param body1 the first body passed to create_collision()
- * @param body2 the second body passed to create_collision()
- * @param axis a unit vector pointing from body1 towards body2
- *   that defines the direction the two bodies are colliding in
- * @param aux the auxiliary value passed to create_collision()
- */
-typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
-                                    void *aux);
-
 /**
  * Adds a force creator to a scene that applies gravity between two bodies.
  * The force creator will be called each tick
@@ -37,9 +26,9 @@ void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2);
 
 /**
- * Adds a force creator to a scene that applies earth gravity to a body near the earth surface.
- * The force creator will be called each tick
- * to compute the Newtonian gravitational force between the bodies.
+ * Makes a scene apply earth gravity to a body near the earth surface.
+ * The body is added to the scene's gravity field (see scene_force_field()),
+ * which computes the force on every body it holds each tick.
  * @param scene the scene containing the bodies
  * @param g earth gravitation constant 9.8
  * @param body the body
@@ -61,9 +50,9 @@ void create_earth_gravity(scene_t *scene, double g, body_t *body);
 void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2);
 
 /**
- * Adds a force creator to a scene that applies a drag force on a body.
- * The force creator will be called each tick
- * to compute the drag force on the body proportional to its velocity.
+ * Makes a scene apply a drag force on a body, through a force field
+ * (see scene_force_field()). The field computes the drag force on the body
+ * each tick, proportional to its velocity.
  * The force points opposite the body's velocity.
  *
  * @param scene the scene containing the bodies
@@ -79,7 +68,9 @@ void create_drag(scene_t *scene, double gamma, body_t *body);
  * This generalizes create_destructive_collision() from last week,
  * allowing different things to happen on a collision.
  * The handler is passed the bodies, the collision axis, and an auxiliary value.
- * It should only be called once while the bodies are still colliding.
+ * It should only be called once while the bodies are still colliding,
+ * so it is registered as the begin handler of a contact
+ * (see scene_add_contact()).
  *
  * @param scene the scene containing the bodies
  * @param body1 the first body
@@ -105,15 +96,12 @@ void create_collision(scene_t *scene, body_t *body1, body_t *body2,
 void create_destructive_collision(scene_t *scene, body_t *body1, body_t *body2);
 
 /**
- * Adds a force creator to a scene that applies impulses
- * to resolve collisions between two bodies in the scene.
- * This should be represented as an on-collision callback
- * registered with create_collision().
- *
- * You may remember from project01 that you should avoid applying impulses
- * multiple times while the bodies are still colliding.
- * You should also have a special case that allows either body1 or body2
- * to have mass INFINITY, as this is useful for simulating walls.
+ * Makes a scene's contact solver bounce two bodies off each other
+ * vertically (see scene_add_axis_contact()); bodies that touch side-on
+ * pass through each other.
+ * Either body1 or body2 may have mass INFINITY, e.g. to simulate walls.
+ * Like create_collision(), bodies that collide head-on have their
+ * scores flipped.
  *
  * @param scene the scene containing the bodies
  * @param elasticity the "coefficient of restitution" of the collision;
@@ -208,12 +196,11 @@ void create_magnet_collision(scene_t *scene, body_t *body1,
 void create_slope_forces(scene_t *scene, double mu, body_t *body);
 
 /**
- * Adds a force creator to a scene that applies buoyancy on a body
- * when it's in the water.
+ * Makes a scene apply buoyancy on a body when it's in the water,
+ * through a force field (see scene_force_field()).
  * The buoyancy is T = rVg, where r is the water density and V is
  * the volume of the body in the water.
- * The force creator will be called each tick to compute the
- * buoyancy on the body.
+ * The field computes the buoyancy on the body each tick.
  * The buoyancy points vertically up.
  *
  * @param scene the scene containing the bodies
@@ -223,18 +210,137 @@ void create_slope_forces(scene_t *scene, double mu, body_t *body);
 void create_buoyancy(scene_t *scene, double constant, body_t *body);
 
 /**
- * Adds a force creator to a scene that applies normal force to body 1 in the scene where body 2 is the ground.
- * It is represented as an on-collision callback
- * registered with create_collision().
- * body 1's velocity is set to zero in y direction.
+ * Makes a scene hold body1 up while it stands on body2, the ground.
+ * The scene's contact solver cancels the velocity and forces pushing body1
+ * into the ground, without bouncing or pushing it sideways
+ * (see scene_add_axis_contact()).
  *
  * @param scene the scene containing the bodies
- * @param g the "coefficient of gravity";
- * 0 is a perfectly inelastic collision and 1 is a perfectly elastic collision
- * @param body1 the first body
- * @param body2 the second body
+ * @param body1 the body held up
+ * @param body2 the ground
  */
-void create_normal_force(scene_t *scene, double g, body_t *body1,
-                           body_t *body2);
+void create_normal_force(scene_t *scene, body_t *body1, body_t *body2);
+
+/**
+ * Adds a collision like create_collision() between every body in
+ * category1 and every body in category2, including bodies added later.
+ * See scene_add_category_contact() and body_set_collision_filter().
+ *
+ * @param scene the scene containing the bodies
+ * @param category1 the categories of the bodies passed to the handler first
+ * @param category2 the categories of the bodies passed to the handler second
+ * @param handler a function to call whenever two such bodies collide
+ * @param aux an auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void create_category_collision(scene_t *scene, uint32_t category1,
+                               uint32_t category2, collision_handler_t handler,
+                               void *aux, free_func_t freer);
+
+/**
+ * Adds create_physics_collision() between every body in category1
+ * and every body in category2.
+ *
+ * @param scene the scene containing the bodies
+ * @param elasticity the "coefficient of restitution" of the collisions
+ * @param category1 the categories of the first bodies
+ * @param category2 the categories of the second bodies
+ */
+void create_category_physics_collision(scene_t *scene, double elasticity,
+                                       uint32_t category1, uint32_t category2);
+
+/**
+ * Adds create_remove_collision() between every body in category1
+ * and every body in category2.
+ *
+ * @param scene the scene containing the bodies
+ * @param category1 the categories of the bodies that stay
+ * @param category2 the categories of the bodies that are removed
+ */
+void create_category_remove_collision(scene_t *scene, uint32_t category1,
+                                      uint32_t category2);
+
+/**
+ * Adds create_slow_collision() between every body in category1
+ * and every body in category2.
+ *
+ * @param scene the scene containing the bodies
+ * @param category1 the categories of the beaver
+ * @param category2 the categories of the slow-down power-ups
+ */
+void create_category_slow_collision(scene_t *scene, uint32_t category1,
+                                    uint32_t category2);
+
+/**
+ * Adds create_double_points_collision() between every body in category1
+ * and every body in category2.
+ *
+ * @param scene the scene containing the bodies
+ * @param category1 the categories of the beaver
+ * @param category2 the categories of the double power-ups
+ */
+void create_category_double_points_collision(scene_t *scene,
+                                             uint32_t category1,
+                                             uint32_t category2);
+
+/**
+ * Adds create_magnet_collision() between every body in category1
+ * and every body in category2.
+ *
+ * @param scene the scene containing the bodies
+ * @param category1 the categories of the beaver
+ * @param category2 the categories of the magnet power-ups
+ */
+void create_category_magnet_collision(scene_t *scene, uint32_t category1,
+                                      uint32_t category2);
+
+/**
+ * Adds create_normal_force() between every body in category1
+ * and every body in category2.
+ *
+ * @param scene the scene containing the bodies
+ * @param category1 the categories of the bodies held up
+ * @param category2 the categories of the ground
+ */
+void create_category_normal_force(scene_t *scene, uint32_t category1,
+                                  uint32_t category2);
+
+/**
+ * Adds a force creator to a scene that pulls bodies towards a body
+ * while the body is magnetic (see body_set_magnet()).
+ * Each tick, it finds the bodies in the given categories within a radius
+ * of the body, and applies Newtonian gravity to them, but not to the body.
+ * Bodies that come in range later are pulled too, so it is added once.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param body the body that attracts the others
+ * @param categories the categories of the bodies it attracts
+ *   (see body_set_collision_filter())
+ * @param radius how far from the body's centroid bodies are attracted
+ */
+void create_magnet_attractor(scene_t *scene, double G, body_t *body,
+                             uint32_t categories, double radius);
+
+/**
+ * Adds a force creator to a scene that applies Newtonian gravity
+ * between every pair of bodies in the given categories,
+ * like create_newtonian_gravity() on each pair, but in O(n log n) time.
+ * Each tick, it builds a Barnes-Hut tree (see barnes_hut.h) over the bodies
+ * and pulls each body by the far-away groups of bodies as if each group
+ * were one body at its center of mass.
+ * Bodies with infinite mass are not pulled and do not pull.
+ * Bodies added to the categories later are pulled too, so it is added once.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param theta the opening angle: a group is treated as one body when its
+ *   width divided by its distance is less than theta;
+ *   0 is exact, and larger values are faster but less accurate
+ * @param categories the categories of the bodies that attract each other
+ *   (see body_set_collision_filter())
+ */
+void create_nbody_gravity(scene_t *scene, double G, double theta,
+                          uint32_t categories);
 
 #endif // #ifndef __FORCES_H__
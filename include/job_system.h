@@ -0,0 +1,131 @@
+#ifndef __JOB_SYSTEM_H__
+#define __JOB_SYSTEM_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A pool of worker threads that run jobs.
+ *
+ * Each worker keeps its own queue of jobs. It runs the newest job it
+ * queued itself, and when it has none it steals the oldest job queued by
+ * another thread. Threads that are not workers share one more queue.
+ * A thread waiting for a job runs other queued jobs until it finishes,
+ * so waiting never leaves a core idle and jobs can wait on other jobs.
+ *
+ * If no worker threads can be started (e.g. a build without threads),
+ * the system still works: jobs run on the threads that wait for them.
+ */
+typedef struct job_system job_system_t;
+
+/**
+ * A handle to a submitted job.
+ * Every handle must be passed to job_wait() or job_release() exactly once.
+ */
+typedef struct job job_t;
+
+/**
+ * A function run by a job.
+ *
+ * @param aux the value passed to job_submit()
+ */
+typedef void (*job_func_t)(void *aux);
+
+/**
+ * A function run on part of a range of indices by job_parallel_for().
+ *
+ * @param aux the value passed to job_parallel_for()
+ * @param start the first index to process
+ * @param end one past the last index to process
+ */
+typedef void (*job_range_func_t)(void *aux, size_t start, size_t end);
+
+/**
+ * Passed to job_system_init() to start a worker for every core
+ * but the one the waiting thread runs on.
+ */
+extern const size_t JOB_SYSTEM_ALL_CORES;
+
+/**
+ * Starts a job system.
+ * At most 64 workers are started.
+ *
+ * @param num_workers the number of worker threads, not counting the threads
+ *   that wait for jobs, or JOB_SYSTEM_ALL_CORES;
+ *   with 0 workers every job runs on a thread waiting for it
+ * @return the new job system
+ */
+job_system_t *job_system_init(size_t num_workers);
+
+/**
+ * Finishes every queued job, then stops the workers and frees the system.
+ * Every job handle must already have been waited on or released.
+ *
+ * @param system a pointer to a system returned from job_system_init()
+ */
+void job_system_free(job_system_t *system);
+
+/**
+ * Gets the number of threads that run jobs: the workers,
+ * plus one for the thread that waits for them.
+ *
+ * @param system a pointer to a system returned from job_system_init()
+ * @return the number of threads
+ */
+size_t job_system_num_threads(job_system_t *system);
+
+/**
+ * Queues a job to run once all of its dependencies have finished.
+ *
+ * @param system a pointer to a system returned from job_system_init()
+ * @param func the function to run
+ * @param aux the value to pass to func
+ * @param dependencies handles of jobs that must finish first,
+ *   or NULL if there are none; they are not released
+ * @param num_dependencies the number of handles in dependencies
+ * @return a handle to the job
+ */
+job_t *job_submit(job_system_t *system, job_func_t func, void *aux,
+                  job_t **dependencies, size_t num_dependencies);
+
+/**
+ * Runs other queued jobs until a job has finished, then releases its handle.
+ *
+ * @param system the system the job was submitted to
+ * @param job a handle returned from job_submit()
+ */
+void job_wait(job_system_t *system, job_t *job);
+
+/**
+ * Gives up a job's handle without waiting for the job.
+ * The job still runs.
+ *
+ * @param system the system the job was submitted to
+ * @param job a handle returned from job_submit()
+ */
+void job_release(job_system_t *system, job_t *job);
+
+/**
+ * Runs queued jobs until every submitted job has finished.
+ *
+ * @param system a pointer to a system returned from job_system_init()
+ */
+void job_system_wait_idle(job_system_t *system);
+
+/**
+ * Calls func on chunks of the indices [0, count), spread over the workers
+ * and the calling thread, and returns once every index has been processed.
+ * Each index is in exactly one chunk. Chunks are handed out as threads
+ * become free, so uneven chunks balance out.
+ *
+ * @param system a pointer to a system returned from job_system_init()
+ * @param count the number of indices
+ * @param grain the number of indices in each chunk,
+ *   or 0 to split the range into a few chunks per thread
+ * @param func the function to call on each chunk
+ * @param aux the value to pass to func
+ */
+void job_parallel_for(job_system_t *system, size_t count, size_t grain,
+                      job_range_func_t func, void *aux);
+
+#endif // #ifndef __JOB_SYSTEM_H__
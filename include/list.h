@@ -75,6 +75,14 @@ void *list_remove(list_t *list, size_t index);
  */
 void list_add(list_t *list, void *value);
 
+/**
+ * Removes every element from a list without calling its freer.
+ * The capacity is kept, so the list can be refilled without reallocating.
+ *
+ * @param list a pointer to a list returned from list_init()
+ */
+void list_clear(list_t *list);
+
 /**
  * Resizes the list to double its capacity
  * and asserts that the resize succeeded.
@@ -3,6 +3,17 @@
 
 #include "list.h"
 #include "vector.h"
+#include <stdbool.h>
+
+/**
+ * An axis-aligned bounding box.
+ * min is the bottom left corner and max is the top right corner.
+ * aabb_t is defined here instead of polygon.c because it is passed *by value*.
+ */
+typedef struct {
+  vector_t min;
+  vector_t max;
+} aabb_t;
 
 /**
  * Computes the area of a polygon.
@@ -46,4 +57,42 @@ void polygon_translate(list_t *polygon, vector_t translation);
  */
 void polygon_rotate(list_t *polygon, double angle, vector_t point);
 
+/**
+ * Computes the axis-aligned bounding box of a polygon.
+ *
+ * @param polygon the list of vertices that make up the polygon
+ * @return the smallest axis-aligned box containing every vertex
+ */
+aabb_t polygon_bounds(list_t *polygon);
+
+/**
+ * Checks whether two axis-aligned bounding boxes overlap.
+ * Boxes that only touch along an edge count as overlapping.
+ *
+ * @param box1 the first box
+ * @param box2 the second box
+ * @return whether the boxes share at least one point
+ */
+bool aabb_overlap(aabb_t box1, aabb_t box2);
+
+/**
+ * Translates an axis-aligned bounding box by a given vector.
+ *
+ * @param box the box to move
+ * @param translation the vector to add to both corners
+ * @return the translated box
+ */
+aabb_t aabb_translate(aabb_t box, vector_t translation);
+
+/**
+ * Computes the region an axis-aligned bounding box covers while it moves
+ * in a straight line.
+ *
+ * @param box the box at the start of the motion
+ * @param motion how far the box moves
+ * @return the smallest axis-aligned box containing the box at every point
+ *   of the motion
+ */
+aabb_t aabb_sweep(aabb_t box, vector_t motion);
+
 #endif // #ifndef __POLYGON_H__
@@ -0,0 +1,125 @@
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A recording of everything nondeterministic that enters the game:
+ * the random seed, the key events, and the time step of each tick.
+ * Each event is stamped with the frame it happened in, so playing
+ * the events back into the same frames repeats the same playthrough.
+ *
+ * The file is a small header followed by one compact record per event;
+ * frame numbers are stored as varint offsets from the previous event.
+ */
+typedef struct replay_writer replay_writer_t;
+
+/**
+ * Reads back a recording made with a replay_writer_t.
+ * The whole file is read into memory when it is opened.
+ */
+typedef struct replay_reader replay_reader_t;
+
+/**
+ * The kinds of events in a recording.
+ */
+typedef enum { REPLAY_KEY, REPLAY_TICK, REPLAY_END } replay_event_type_t;
+
+/**
+ * One recorded event.
+ * Key events use key, key_type and held_time; ticks use dt.
+ * The end event marks the frame the recording stopped in.
+ */
+typedef struct replay_event {
+  replay_event_type_t type;
+  size_t frame;
+  char key;
+  int key_type;
+  double held_time;
+  double dt;
+} replay_event_t;
+
+/**
+ * Creates a recording file and writes its header.
+ *
+ * @param path the file to write
+ * @param seed the random seed the recorded game uses
+ * @return the writer, or NULL if the file could not be created
+ */
+replay_writer_t *replay_writer_init(const char *path, unsigned seed);
+
+/**
+ * Records a key event.
+ * Frames must be recorded in nondecreasing order.
+ *
+ * @param writer a pointer to a writer returned from replay_writer_init()
+ * @param frame the frame the key event was handled in
+ * @param key the key, as passed to the key handler
+ * @param key_type the type of key event, as passed to the key handler
+ * @param held_time the time the key was held, as passed to the key handler
+ */
+void replay_write_key(replay_writer_t *writer, size_t frame, char key,
+                      int key_type, double held_time);
+
+/**
+ * Records the time step the game ticked by.
+ *
+ * @param writer a pointer to a writer returned from replay_writer_init()
+ * @param frame the frame the time step was taken in
+ * @param dt the time step in seconds
+ */
+void replay_write_tick(replay_writer_t *writer, size_t frame, double dt);
+
+/**
+ * Records the end of the recording, then closes the file
+ * and releases the memory allocated for the writer.
+ *
+ * @param writer a pointer to a writer returned from replay_writer_init()
+ * @param frame the frame the recording ended in
+ */
+void replay_writer_free(replay_writer_t *writer, size_t frame);
+
+/**
+ * Reads a recording file.
+ *
+ * @param path the file to read
+ * @return the reader, or NULL if the file is missing or is not a recording
+ */
+replay_reader_t *replay_reader_init(const char *path);
+
+/**
+ * Releases the memory allocated for a reader.
+ *
+ * @param reader a pointer to a reader returned from replay_reader_init()
+ */
+void replay_reader_free(replay_reader_t *reader);
+
+/**
+ * Gets the random seed a recording was made with.
+ *
+ * @param reader a pointer to a reader returned from replay_reader_init()
+ * @return the seed
+ */
+unsigned replay_seed(replay_reader_t *reader);
+
+/**
+ * Gets the next event without consuming it.
+ * A recording that was cut short ends with a REPLAY_END event
+ * in the frame of its last event.
+ *
+ * @param reader a pointer to a reader returned from replay_reader_init()
+ * @return the next event
+ */
+replay_event_t replay_peek(replay_reader_t *reader);
+
+/**
+ * Consumes the next event.
+ * The end event is never consumed; it is returned again.
+ *
+ * @param reader a pointer to a reader returned from replay_reader_init()
+ * @return the event that was consumed
+ */
+replay_event_t replay_next(replay_reader_t *reader);
+
+#endif // #ifndef __REPLAY_H__
@@ -2,8 +2,9 @@
 #define __SCENE_H__
 
 #include "body.h"
+#include "collision.h"
+#include "job_system.h"
 #include "list.h"
-#include <SDL2/SDL.h>
 
 
 
@@ -14,114 +15,6 @@
  */
 typedef struct scene scene_t;
 
-/**
- * A collection of information for to create text in scene
- * Includes text font, container length and width, and color
- */
-typedef struct text text_t;
-
-/**
- * Allocates memory for an empty text.
- *
- * @return the new text
- */
-text_t *text_init (size_t length, size_t width, vector_t center, void* font, SDL_Color color);
-
-/**
- * Releases memory allocated for a given text
- *
- * @param text a pointer to a text returned from text_init()
- */
-void free_text(text_t *text);
-
- /**
-  * @brief Returns width of given text's container
-  * 
-  * @param text a pointer to a text returned from text_init()
-  * @return * size_t width of text
-  */
-size_t text_get_width(text_t *text);
-
-
- /**
-  * @brief Returns length of given text's container
-  * 
-  * @param text a pointer to a text returned from text_init()
-  * @return * size_t length of text
-  */
-size_t text_get_length(text_t *text);
-
-
- /**
-  * @brief Returns position of given text's container
-  * 
-  * @param text a pointer to a text returned from text_init()
-  * @return * vector_t position of text
-  */
-vector_t text_get_center(text_t *text);
-
- /**
-  * Returns font of given text
-  * 
-  * @param text a pointer to a text returned from text_init()
-  * @return * void* font fo given text
-  */
-void* text_get_font(text_t *text);
-
- /**
-  * Returns color of given text
-  * 
-  * @param text a pointer to a text returned from text_init()
-  * @return * SDL_Color color of given text
-  */
-SDL_Color text_get_color(text_t *text);
-
- /**
-  * Sets width of given text's container
-  * 
-  * @param text a pointer to a text returned from text_init()
-  * @param width width of text
-  * @return * void 
-  */
-void text_set_width(text_t *text, size_t width);
-
- /**
-  * Sets length of given text's container
-  * 
-  * @param text a pointer to a text returned from text_init()
-  * @param length length of text
-  * @return * void 
-  */
-void text_set_length(text_t *text, size_t length);
-
- /**
-  * Sets center of given text's container
-  * 
-  * @param text a pointer to a text returned from text_init()
-  * @param center position of text
-  * @return * void 
-  */
-
-void text_set_center(text_t *text, vector_t center);
-
- /**
-  * Sets font of given text
-  * 
-  * @param text a pointer to a text returned from text_init()
-  * @param font font of text
-  * @return * void 
-  */
-void text_set_font(text_t *text, void* font);
-
- /**
-  * Sets color of given text
-  * 
-  * @param text a color to a text returned from text_init()
-  * @param color color of text
-  * @return * void 
-  */
-void text_set_color(text_t *text, SDL_Color color);
-
 /**
  * A function which adds some forces or impulses to bodies,
  * e.g. from collisions, gravity, or spring forces.
@@ -129,6 +22,109 @@ void text_set_color(text_t *text, SDL_Color color);
  */
 typedef void (*force_creator_t)(void *aux);
 
+/**
+ * A function called when a collision occurs.
+ * @param body1 the first body passed to create_collision()
+ * @param body2 the second body passed to create_collision()
+ * @param axis a unit vector pointing from body1 towards body2
+ *   that defines the direction the two bodies are colliding in
+ * @param aux the auxiliary value passed to create_collision()
+ */
+typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
+                                    void *aux);
+
+/**
+ * A collision found by a force creator, to be handled once every
+ * force creator has run. See scene_queue_collision().
+ */
+typedef struct collision_event {
+  body_t *body1;
+  body_t *body2;
+  // a unit vector along which the bodies collide
+  vector_t axis;
+  // how far the bodies overlap along the axis
+  double depth;
+  collision_handler_t handler;
+  void *aux;
+} collision_event_t;
+
+/**
+ * The handlers of a contact between two bodies; see scene_add_contact().
+ * Any of them may be NULL.
+ */
+typedef struct contact_handlers {
+  // called in the first tick the bodies touch
+  collision_handler_t begin;
+  // called in every later tick that they still touch
+  collision_handler_t stay;
+  // called in the first tick that they no longer touch
+  collision_handler_t end;
+} contact_handlers_t;
+
+/**
+ * A force that acts on many bodies at once, added with
+ * scene_force_field(). Each body the field acts on gets the force
+ *   mass * acceleration - drag * velocity,
+ * e.g. {0, -9.8} acceleration for earth gravity.
+ * Bodies with infinite mass are not affected.
+ */
+typedef struct force_field {
+  vector_t acceleration;
+  // the linear drag coefficient
+  double drag;
+  // if bounded, the field only acts on bodies whose centroid is in region,
+  // e.g. buoyancy in a pool of water
+  bool bounded;
+  aabb_t region;
+  // the field acts on every body in one of these categories
+  // (see body_set_collision_filter()), as well as the bodies added to it
+  // with scene_add_field_body()
+  uint32_t categories;
+} force_field_t;
+
+/**
+ * The first body hit by a ray or shape cast; see scene_raycast().
+ */
+typedef struct scene_hit {
+  // the body hit, or NULL if the cast hit nothing
+  body_t *body;
+  // the fraction of the motion made before touching the body,
+  // or 1 if nothing was hit
+  double time;
+  // the unit normal of the body's surface where it was hit, pointing back
+  // against the motion; zero if the cast started inside the body
+  vector_t normal;
+} scene_hit_t;
+
+/**
+ * How scene_tick() moves bodies under the forces on them;
+ * see scene_set_integrator().
+ */
+typedef enum integrator {
+  // body_tick(): the velocity changes by the forces at the start of the
+  // tick, and the body moves at the average of its old and new velocities
+  INTEGRATOR_AVERAGE_VELOCITY,
+  // the velocity changes first and the body moves at the new velocity;
+  // as cheap as the default, and keeps the energy of oscillations bounded
+  INTEGRATOR_SEMI_IMPLICIT_EULER,
+  // the body moves under the forces at the start of the tick, and its
+  // velocity changes by the average of the forces there and where it
+  // ends up; evaluates the forces twice per tick
+  INTEGRATOR_VELOCITY_VERLET,
+  // the classic fourth-order Runge-Kutta method;
+  // evaluates the forces four times per tick
+  INTEGRATOR_RK4,
+} integrator_t;
+
+/**
+ * A function called each tick with the result of testing two bodies
+ * for collision. See scene_add_collision_tester().
+ *
+ * @param aux the auxiliary value passed to scene_add_collision_tester()
+ * @param info the status of the collision between the bodies
+ */
+typedef void (*collision_tester_t)(void *aux, collision_info_t info);
+
 /**
  * Allocates memory for an empty scene.
  * Makes a reasonable guess of the number of bodies to allocate space for.
@@ -139,61 +135,20 @@ typedef void (*force_creator_t)(void *aux);
 scene_t *scene_init();
 
 /**
- * Returns list of surfaces needed in all scenes
- * 
- * @param scene a pointer to a scene returned from scene_init()
- * @return * list_t* list of surfaces needed for scenes
- */
-list_t *scene_get_surfaces(scene_t *scene);
-
-/**
- * Sets list of surfaces needed in all scenes 
+ * Returns list of indicies of the platform's HUD texts shown in the given scene 
+ * The first text shows the score and the second the beaver's lives.
  * 
  * @param scene a pointer to a scene returned from scene_init()
- * @param loaded_surfaces list of surfaces needed for scenes
- * @return * void 
- */
-void scene_set_surfaces(scene_t *scene, list_t *loaded_surfaces);
-
-/**
- *returns list of texts needed in all scenes
-**/
-
-/**
- * Returns ist of fonts needed in the scenes
- * 
- * @param scene a pointer to a scene returned from scene_init()
- * @return * list_t* list of fonts needed in the scenes
- */
-
-list_t *scene_get_fonts(scene_t *scene);
-
-/**
- * Returns list of indicies for which texts in fonts is needed in the given scene 
- * 
- * @param scene a pointer to a scene returned from scene_init()
- * @return * list_t* list of indicies for which texts in fonts is needed in the given scene 
+ * @return * list_t* list of indicies of HUD texts, or NULL if the scene has none
  */
 list_t *scene_get_font_indexs(scene_t *scene);
 
 /**
- * sets list of fonts in given scene
-**/
-
-/**
- * Sets list of fonts in given scene 
+ * Sets list of HUD text indexs in given scene 
+ * The scene frees the list when it is freed.
  * 
  * @param scene a pointer to a scene returned from scene_init()
- * @param font list of fonts needed for scenes
- * @return * void 
- */
-void scene_set_fonts(scene_t *scene, list_t *font);
-
-/**
- * Sets list of font indexs in given scene 
- * 
- * @param scene a pointer to a scene returned from scene_init()
- * @param font_indexs list of font indexs for the given scene 
+ * @param font_indexs list of size_t* HUD text indexs for the given scene 
  * @return * void 
  */
 void scene_set_font_indexs(scene_t *scene, list_t *font_indexs);
@@ -241,6 +196,78 @@ body_t *scene_get_body(scene_t *scene, size_t index);
  */
 void scene_add_body(scene_t *scene, body_t *body);
 
+/**
+ * Finds the bodies whose bounding boxes intersect a given rectangle.
+ * Backed by a spatial index that the scene rebuilds lazily after bodies are
+ * added or ticked, so the work done per body outside the rectangle is small.
+ * Bodies marked for removal are still reported until the next tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param bounds the rectangle to search, which may be unbounded
+ * @return the matching bodies in scene order. The list is owned by the scene
+ *   and is overwritten by the next call or scene_tick(),
+ *   so it must not be freed.
+ */
+list_t *scene_bodies_in_bounds(scene_t *scene, aabb_t bounds);
+
+/**
+ * Finds the bodies whose centroids are within a given distance of a point,
+ * using the same spatial index as scene_bodies_in_bounds().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param center the point to search around
+ * @param radius the largest distance to report a body at
+ * @return the matching bodies in scene order. The list is owned by the scene
+ *   and is overwritten by the next call or scene_tick(),
+ *   so it must not be freed.
+ */
+list_t *scene_bodies_in_radius(scene_t *scene, vector_t center, double radius);
+
+/**
+ * Finds the bodies in some categories (see body_set_collision_filter())
+ * whose bounding boxes intersect a given rectangle.
+ * Unlike scene_bodies_in_bounds(), bodies marked for removal are skipped.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param bounds the rectangle to search, which may be unbounded
+ * @param categories the categories to report bodies in
+ * @return the matching bodies in scene order. The list is owned by the scene
+ *   and is overwritten by the next query or scene_tick(),
+ *   so it must not be freed.
+ */
+list_t *scene_query_aabb(scene_t *scene, aabb_t bounds, uint32_t categories);
+
+/**
+ * Finds the first body in some categories that a line segment touches,
+ * e.g. the ground directly below a point.
+ * Only the bodies whose bounds meet the segment's bounds are tested.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param origin the start of the segment
+ * @param motion the segment's end minus its start
+ * @param categories the categories of the bodies the ray can hit
+ * @return the first body hit, if any; the hit point is
+ *   origin + time * motion
+ */
+scene_hit_t scene_raycast(scene_t *scene, vector_t origin, vector_t motion,
+                          uint32_t categories);
+
+/**
+ * Finds the first body in some categories that a convex polygon touches
+ * while it moves in a straight line, e.g. whether a body would land on
+ * something if it dropped a little.
+ * A body the polygon already overlaps is hit at time 0.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param shape the polygon at the start of the motion, such as
+ *   body_borrow_shape() of a body outside the categories
+ * @param motion how far the polygon moves
+ * @param categories the categories of the bodies the polygon can hit
+ * @return the first body hit, if any
+ */
+scene_hit_t scene_shapecast(scene_t *scene, list_t *shape, vector_t motion,
+                            uint32_t categories);
+
 /**
  * Returns accumulative score of scenes
  * 
@@ -300,10 +327,265 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer);
 
+/**
+ * Adds a force creator like scene_add_bodies_force_creator(), for a force
+ * creator that only reads its bodies and adds forces and impulses to them.
+ * If the scene has a job system, runs of such force creators are split
+ * across its threads. Their forces are still added to the bodies in the
+ * order the force creators were added, so the results match a serial tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function that can run on any thread,
+ *   at the same time as other parallel force creators
+ * @param aux an auxiliary value to pass to forcer when it is called
+ * @param bodies the list of bodies affected by the force creator
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_parallel_force_creator(scene_t *scene, force_creator_t forcer,
+                                      void *aux, list_t *bodies,
+                                      free_func_t freer);
+
+/**
+ * Adds a force creator that reacts to collisions between two bodies.
+ * Every tick, the scene finds the pairs whose bounding boxes overlap with its
+ * spatial index, and tests them all for collision at once with
+ * find_collisions(), on its job system if it has one. Each tester is then
+ * called with its pair's result, in its place among the force creators;
+ * pairs whose bounding boxes do not overlap are not tested, and are passed
+ * a result with collided set to false.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the first body to test
+ * @param body2 the second body to test
+ * @param tester the function to call with the result of the test
+ * @param aux an auxiliary value to pass to tester when it is called
+ * @param bodies the list of bodies affected by the force creator
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_collision_tester(scene_t *scene, body_t *body1, body_t *body2,
+                                collision_tester_t tester, void *aux,
+                                list_t *bodies, free_func_t freer);
+
+/**
+ * Calls handlers as two bodies start touching, keep touching
+ * and stop touching.
+ * The scene caches one entry per ordered pair of bodies, shared by all
+ * the contacts between them, that records whether the bodies touched in the
+ * last tick. Each tick, the pairs whose bounding boxes overlap are found with
+ * the scene's spatial index and tested along with the collision testers,
+ * and then the contacts' handlers are queued with scene_queue_collision(),
+ * in the order the contacts were added.
+ * An end handler is passed the axis the bodies last touched along.
+ * A contact is dropped once either body is removed,
+ * without calling its end handler.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the body passed to the handlers first
+ * @param body2 the body passed to the handlers second
+ * @param handlers the functions to call
+ * @param aux an auxiliary value to pass to the handlers
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_contact(scene_t *scene, body_t *body1, body_t *body2,
+                       contact_handlers_t handlers, void *aux,
+                       free_func_t freer);
+
+/**
+ * Adds a contact like scene_add_contact() to every pair of bodies where
+ * body1 is in category1 and body2 is in category2, including bodies added
+ * later (see body_set_collision_filter()). Pairs are skipped unless each
+ * body's mask includes a category of the other.
+ * Each tick, the scene finds the pairs whose bounding boxes overlap with its
+ * spatial index and adds their contacts, and it drops them again once the
+ * bounding boxes no longer overlap. A pair only gets the category contacts
+ * added before the tick its bounding boxes began to overlap in.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param category1 the categories of the bodies passed to the handlers first
+ * @param category2 the categories of the bodies passed to the handlers second
+ * @param handlers the functions to call
+ * @param aux an auxiliary value to pass to the handlers
+ * @param freer if non-NULL, a function to call in order to free aux
+ *   once the scene is freed or reset
+ */
+void scene_add_category_contact(scene_t *scene, uint32_t category1,
+                                uint32_t category2,
+                                contact_handlers_t handlers, void *aux,
+                                free_func_t freer);
+
+/**
+ * Adds a contact like scene_add_contact() whose bodies are kept from
+ * moving into each other by the scene's contact solver, instead of by
+ * handlers. Each tick, after the collision handlers, the solver gathers
+ * every solid contact whose bodies touch and applies impulses along the
+ * axes they touch on, a few times over all of them, until no pair is moving
+ * into the other and each pair bounces by its coefficient of restitution.
+ * Pairs that overlap are pushed apart a little faster, to undo the overlap
+ * over the next few ticks.
+ * The solver starts from the impulses each contact needed in the last tick,
+ * so a body resting on another is held up from the first iteration.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param elasticity the "coefficient of restitution" of the collision;
+ *   0 is a perfectly inelastic collision and 1 is a perfectly elastic collision
+ */
+void scene_add_solid_contact(scene_t *scene, body_t *body1, body_t *body2,
+                             double elasticity);
+
+/**
+ * Adds scene_add_solid_contact() between every body in category1 and every
+ * body in category2, like scene_add_category_contact().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param category1 the categories of the first bodies
+ * @param category2 the categories of the second bodies
+ * @param elasticity the coefficient of restitution of the collisions
+ */
+void scene_add_category_solid_contact(scene_t *scene, uint32_t category1,
+                                      uint32_t category2, double elasticity);
+
+/**
+ * Adds a contact like scene_add_solid_contact() that the solver only
+ * pushes along one axis, e.g. (0, 1) so that the ground holds a body up
+ * without pushing it sideways. While the bodies touch, the solver pushes
+ * them apart along the axis, and only undoes the part of their overlap
+ * along it. It does not push at all while they touch on an axis more than
+ * 60 degrees from it, e.g. while a body touches the side of the ground.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param elasticity the coefficient of restitution of the collision
+ * @param axis the direction to push in; its length does not matter
+ */
+void scene_add_axis_contact(scene_t *scene, body_t *body1, body_t *body2,
+                            double elasticity, vector_t axis);
+
+/**
+ * Adds scene_add_axis_contact() between every body in category1 and every
+ * body in category2, like scene_add_category_contact().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param category1 the categories of the first bodies
+ * @param category2 the categories of the second bodies
+ * @param elasticity the coefficient of restitution of the collisions
+ * @param axis the direction to push in; its length does not matter
+ */
+void scene_add_category_axis_contact(scene_t *scene, uint32_t category1,
+                                     uint32_t category2, double elasticity,
+                                     vector_t axis);
+
+/**
+ * Gets a force field that acts on the bodies in a scene, adding it if the
+ * scene has no field with the same parameters. Every tick, before the force
+ * creators run, each field adds its force to the bodies it acts on in one
+ * pass, without calling a force creator per body.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param field the force and the bodies it acts on
+ * @return the index of the field, to pass to scene_add_field_body()
+ */
+size_t scene_force_field(scene_t *scene, force_field_t field);
+
+/**
+ * Makes a force field act on a body, even if it is not in the field's
+ * categories. A body in the field's categories that is also added
+ * still gets the force once.
+ * The body is dropped from the field once it is removed from the scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param field an index returned from scene_force_field()
+ * @param body a body in the scene
+ */
+void scene_add_field_body(scene_t *scene, size_t field, body_t *body);
+
+/**
+ * Sets the job system that scene_tick() runs parallel force creators
+ * and collision tests on.
+ * The scene does not own the job system.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param jobs a job system, or NULL to run every force creator
+ *   on the thread that calls scene_tick()
+ */
+void scene_set_job_system(scene_t *scene, job_system_t *jobs);
+
+/**
+ * Sets how scene_tick() moves the scene's bodies.
+ * The schemes that evaluate the forces more than once rerun the force
+ * fields and force creators with the bodies moved part of the way, so the
+ * force creators must only add forces that depend on where the bodies are
+ * and how fast they move. Collision tests, contacts and impulses are only
+ * handled at the start of the tick.
+ * Scenes use INTEGRATOR_AVERAGE_VELOCITY until this is called.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param integrator the scheme to use
+ */
+void scene_set_integrator(scene_t *scene, integrator_t integrator);
+
+/**
+ * Gets how scene_tick() moves the scene's bodies.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the scheme set with scene_set_integrator()
+ */
+integrator_t scene_get_integrator(scene_t *scene);
+
+/**
+ * Sets the number of equal steps each scene_tick() is split into, so stiff
+ * forces stay stable without the caller ticking the scene more often.
+ * Each step handles forces, collisions and removals as a whole tick would.
+ * Scenes take 1 step per tick until this is called.
+ * Asserts that there is at least 1 step.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param substeps the number of steps per tick
+ */
+void scene_set_substeps(scene_t *scene, size_t substeps);
+
+/**
+ * Gets the number of steps each scene_tick() is split into.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of steps set with scene_set_substeps()
+ */
+size_t scene_get_substeps(scene_t *scene);
+
+/**
+ * Queues a collision to be handled in the current tick, after every
+ * force creator has run. Force creators that detect collisions queue them
+ * instead of handling them, so detecting collisions does not change any
+ * body and can be done in any order.
+ * A collision between the same two bodies, in the same order and with the
+ * same handler and aux, is only queued once per tick.
+ * Must be called from a force creator running on the thread that called
+ * scene_tick(); parallel force creators must not call it.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param event the collision; its handler is called with its bodies,
+ *   axis and aux
+ */
+void scene_queue_collision(scene_t *scene, collision_event_t event);
+
 /**
  * Executes a tick of a given scene over a small time interval.
- * This requires executing all the force creators
- * and then ticking each body (see body_tick()).
+ * This requires applying the force fields,
+ * executing all the force creators and updating the contacts,
+ * then the handlers of the collisions they queued, in the order queued,
+ * then solving the solid contacts (see scene_add_solid_contact()) unless dt
+ * is 0,
+ * and then moving each body with the scene's integrator
+ * (see scene_set_integrator()).
+ * The tick is split into the scene's number of substeps
+ * (see scene_set_substeps()), each of which does all of this.
+ * A fast body (see body_set_ccd_categories()) that would touch a body in
+ * its categories during the tick is stopped just inside the first one it
+ * touches, so the collision is found on the next tick. If what it touches
+ * moves towards it, it is pushed along for the rest of the tick, but never
+ * dragged along the surface it touches.
  * If any bodies are marked for removal, they should be removed from the scene
  * and freed, along with any force creators acting on them.
  *
@@ -6,9 +6,20 @@
 #include "scene.h"
 #include "state.h"
 #include "vector.h"
-#include <SDL2/SDL_ttf.h>
 #include <stdbool.h>
 
+/**
+ * The platform the game runs on: its window, input, clock and drawing.
+ * sdl_wrapper.c implements it with SDL; null_wrapper.c implements it
+ * without a window, so scenes can be simulated headless.
+ *
+ * A frame is everything between two calls to sdl_show().
+ * Setting BEAVER_RECORD to a file name makes the SDL platform record the
+ * seed, key events and time steps of a playthrough (see replay.h).
+ * Setting BEAVER_REPLAY to that file makes the headless platform play it
+ * back as fast as it can and report where the time went.
+ */
+
 // Values passed to a key handler when the given arrow key is pressed
 typedef enum {
   LEFT_ARROW = 1,
@@ -40,18 +51,42 @@ typedef enum { KEY_PRESSED, KEY_RELEASED } key_event_type_t;
 typedef void (*key_handler_t)(char key, key_event_type_t type, double held_time,
                               state_t *state);
 
+/**
+ * The parts of a frame that are timed separately when replaying.
+ * Input is time spent in the key handler.
+ */
+typedef enum {
+  PHASE_LOGIC,
+  PHASE_PHYSICS,
+  PHASE_RENDER,
+  PHASE_INPUT,
+  NUM_PHASES
+} frame_phase_t;
+
 /**
  * Initializes the SDL window and renderer.
  * Must be called once before any of the other SDL functions.
+ * Images are decoded in the background after this returns;
+ * pictures are not drawn until their image has finished loading.
+ * Also creates the HUD text containers that scenes refer to by index.
  *
  * @param min the x and y coordinates of the bottom left of the scene
  * @param max the x and y coordinates of the top right of the scene
  */
-void sdl_init(vector_t min, vector_t max, list_t* loaded_surfaces, list_t* loaded_texts);
+void sdl_init(vector_t min, vector_t max);
+
+/**
+ * Gets the seed for the game's random numbers.
+ * A replay returns the seed it was recorded with, so it builds the same levels.
+ *
+ * @return the seed to pass to srand()
+ */
+unsigned sdl_seed(void);
 
 /**
  * Processes all SDL events and returns whether the window has been closed.
  * This function must be called in order to handle keypresses.
+ * Once the window has been closed, this keeps returning true.
  *
  * @return true if the window was closed, false otherwise
  */
@@ -78,13 +113,14 @@ void sdl_show(void);
 
 /**
  * Draws all bodies in a scene.
- * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
+ * This internally calls sdl_clear() and sdl_draw_polygon(),
  * so those functions should not be called directly.
+ * Call sdl_show() afterwards to end the frame.
+ * Drawing does not advance the scene; call scene_tick() for that.
  *
  * @param scene the scene to draw
  */
-void sdl_render_scene(scene_t *scene, double dt);
-// void sdl_render_scene(state_t *state);
+void sdl_render_scene(scene_t *scene);
 
 /**
  * Registers a function to be called every time a key is pressed.
@@ -122,4 +158,13 @@ void sdl_on_key(key_handler_t handler);
  */
 double time_since_last_tick(void);
 
+/**
+ * Marks the start of a part of the frame.
+ * The time until the next call, or until sdl_show(), is counted
+ * towards that phase. Each frame starts in PHASE_LOGIC.
+ *
+ * @param phase the part of the frame that is starting
+ */
+void sdl_begin_phase(frame_phase_t phase);
+
 #endif // #ifndef __SDL_WRAPPER_H__
@@ -0,0 +1,88 @@
+#ifndef __SPATIAL_INDEX_H__
+#define __SPATIAL_INDEX_H__
+
+#include "list.h"
+#include "polygon.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A uniform grid that buckets items by the cells their bounding boxes cover.
+ * Used to find the items near a region without looking at every item.
+ * Items that move are updated in place with spatial_index_update(); the
+ * index is rebuilt by clearing it and inserting every item again when
+ * items are added or removed. Its internal buffers are kept between
+ * rebuilds.
+ */
+typedef struct spatial_index spatial_index_t;
+
+/**
+ * Allocates memory for an empty spatial index.
+ * Asserts that the cell size is positive and that the memory was allocated.
+ *
+ * @param cell_size the width and height of each grid cell
+ * @return the new spatial index
+ */
+spatial_index_t *spatial_index_init(double cell_size);
+
+/**
+ * Releases the memory allocated for a spatial index.
+ * Does not free the items that were inserted.
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ */
+void spatial_index_free(spatial_index_t *index);
+
+/**
+ * Removes every item from a spatial index, keeping its allocated buffers.
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ */
+void spatial_index_clear(spatial_index_t *index);
+
+/**
+ * Adds an item to a spatial index.
+ * Items are remembered in insertion order, which is the order queries
+ * report them in.
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ * @param item the item to store (must be non-NULL)
+ * @param bounds the item's axis-aligned bounding box
+ */
+void spatial_index_insert(spatial_index_t *index, void *item, aabb_t bounds);
+
+/**
+ * Moves an item of a spatial index to new bounds. Only the cells the item
+ * enters are touched, so an item that stays in the same cells costs
+ * nothing beyond storing its bounds. Once moved items have filled the
+ * index's buffers, every item's cells are laid out again instead of
+ * growing them.
+ * Asserts that the position is that of an inserted item.
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ * @param position the item's position in insertion order, from 0
+ * @param bounds the item's new axis-aligned bounding box
+ */
+void spatial_index_update(spatial_index_t *index, size_t position,
+                          aabb_t bounds);
+
+/**
+ * Gets the number of items in a spatial index.
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ * @return the number of items inserted since the last clear
+ */
+size_t spatial_index_size(spatial_index_t *index);
+
+/**
+ * Finds the items whose bounding boxes overlap a given box.
+ * Each matching item is appended once to results, in insertion order.
+ * The box may be unbounded (e.g. use -INFINITY/INFINITY for its corners).
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ * @param box the region to search
+ * @param results the list to append the matching items to
+ */
+void spatial_index_query(spatial_index_t *index, aabb_t box, list_t *results);
+
+#endif // #ifndef __SPATIAL_INDEX_H__
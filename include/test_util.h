@@ -17,6 +17,11 @@
  */
 bool isclose(double d1, double d2);
 
+/**
+ * Returns whether two double values are within epsilon of each other.
+ */
+bool within(double epsilon, double d1, double d2);
+
 /**
  * Return if the components of two vectors are exactly equal.
  * Floating-point math is approximate, so the result of a
@@ -32,6 +37,12 @@ bool vec_equal(vector_t v1, vector_t v2);
  */
 bool vec_isclose(vector_t v1, vector_t v2);
 
+/**
+ * Return if the corresponding components of two vectors are
+ * within epsilon of each other.
+ */
+bool vec_within(double epsilon, vector_t v1, vector_t v2);
+
 /**
  * Open the file 'filename', read one word into 'testname', and close the file.
  * If the file cannot be found, exit with error.
@@ -0,0 +1,250 @@
+#include "alloc_track.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// must be a power of 2 so the hash can be masked instead of divided
+const size_t INITIAL_BLOCK_SLOTS = 1024;
+
+const char *ALLOC_SUBSYSTEM_NAMES[NUM_ALLOC_SUBSYSTEMS] = {
+    "list", "body", "forces", "collision", "scene", "jobs", "platform"};
+
+// a live allocation, in an open-addressing hash table keyed by address
+typedef struct block {
+  void *ptr;
+  size_t size;
+  alloc_subsystem_t subsystem;
+} block_t;
+
+// read without the lock by every allocation, on any thread
+atomic_bool tracking = false;
+alloc_stats_t subsystem_stats[NUM_ALLOC_SUBSYSTEMS];
+block_t *tracked_blocks = NULL;
+size_t tracked_slots = 0;
+size_t num_tracked_blocks = 0;
+// the platform allocates on its loader threads too
+pthread_mutex_t track_lock = PTHREAD_MUTEX_INITIALIZER;
+
+size_t block_hash(void *ptr) {
+  uint64_t h = (uintptr_t)ptr;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdu;
+  h ^= h >> 33;
+  return (size_t)h & (tracked_slots - 1);
+}
+
+size_t block_find(void *ptr) {
+  size_t slot = block_hash(ptr);
+  while (tracked_blocks[slot].ptr != NULL && tracked_blocks[slot].ptr != ptr) {
+    slot = (slot + 1) & (tracked_slots - 1);
+  }
+  return slot;
+}
+
+void blocks_insert(block_t block);
+
+// doubles the table, keeping it at most half full
+void blocks_grow(void) {
+  block_t *old_blocks = tracked_blocks;
+  size_t old_slots = tracked_slots;
+  tracked_slots = old_slots == 0 ? INITIAL_BLOCK_SLOTS : old_slots * 2;
+  tracked_blocks = calloc(tracked_slots, sizeof(block_t));
+  assert(tracked_blocks != NULL);
+  num_tracked_blocks = 0;
+  for (size_t i = 0; i < old_slots; i++) {
+    if (old_blocks[i].ptr != NULL) {
+      blocks_insert(old_blocks[i]);
+    }
+  }
+  free(old_blocks);
+}
+
+// forgets a block that was freed, so its bytes are no longer live
+void block_release(size_t slot) {
+  alloc_stats_t *owner = &subsystem_stats[tracked_blocks[slot].subsystem];
+  owner->live_bytes -= tracked_blocks[slot].size;
+  tracked_blocks[slot].ptr = NULL;
+  num_tracked_blocks--;
+  // shift later tracked_blocks of the probe chain back into the hole
+  size_t hole = slot;
+  for (size_t next = (slot + 1) & (tracked_slots - 1); tracked_blocks[next].ptr != NULL;
+       next = (next + 1) & (tracked_slots - 1)) {
+    size_t home = block_hash(tracked_blocks[next].ptr);
+    bool movable = hole <= next ? home <= hole || home > next
+                                : home <= hole && home > next;
+    if (movable) {
+      tracked_blocks[hole] = tracked_blocks[next];
+      tracked_blocks[next].ptr = NULL;
+      hole = next;
+    }
+  }
+}
+
+void blocks_insert(block_t block) {
+  if (2 * (num_tracked_blocks + 1) > tracked_slots) {
+    blocks_grow();
+  }
+  size_t slot = block_find(block.ptr);
+  if (tracked_blocks[slot].ptr != NULL) {
+    // the address was freed by code that is not tracked and then reused
+    block_release(slot);
+    slot = block_find(block.ptr);
+  }
+  tracked_blocks[slot] = block;
+  num_tracked_blocks++;
+}
+
+// the count functions are called with the lock held, and check tracking
+// again in case it was disabled since it was checked without the lock
+void track_count_allocation(alloc_subsystem_t subsystem, void *ptr, size_t size) {
+  if (!tracking) {
+    return;
+  }
+  alloc_stats_t *owner = &subsystem_stats[subsystem];
+  owner->allocations++;
+  owner->bytes += size;
+  blocks_insert((block_t){.ptr = ptr, .size = size, .subsystem = subsystem});
+  owner->live_bytes += size;
+  if (owner->live_bytes > owner->peak_bytes) {
+    owner->peak_bytes = owner->live_bytes;
+  }
+}
+
+void track_count_free(void *ptr) {
+  if (!tracking) {
+    return;
+  }
+  size_t slot = block_find(ptr);
+  // memory allocated before tracking started is not counted
+  if (tracked_blocks[slot].ptr != NULL) {
+    subsystem_stats[tracked_blocks[slot].subsystem].frees++;
+    block_release(slot);
+  }
+}
+
+void *track_malloc(alloc_subsystem_t subsystem, size_t size) {
+  void *ptr = malloc(size);
+  if (tracking && ptr != NULL) {
+    pthread_mutex_lock(&track_lock);
+    track_count_allocation(subsystem, ptr, size);
+    pthread_mutex_unlock(&track_lock);
+  }
+  return ptr;
+}
+
+void *track_calloc(alloc_subsystem_t subsystem, size_t count, size_t size) {
+  void *ptr = calloc(count, size);
+  if (tracking && ptr != NULL) {
+    pthread_mutex_lock(&track_lock);
+    track_count_allocation(subsystem, ptr, count * size);
+    pthread_mutex_unlock(&track_lock);
+  }
+  return ptr;
+}
+
+void *track_realloc(alloc_subsystem_t subsystem, void *ptr, size_t size) {
+  if (!tracking) {
+    return realloc(ptr, size);
+  }
+  pthread_mutex_lock(&track_lock);
+  // the old block is forgotten before realloc() frees its address;
+  // a move counts as one allocation, not an allocation and a free
+  block_t old = {.ptr = NULL};
+  if (ptr != NULL && tracking) {
+    size_t slot = block_find(ptr);
+    old = tracked_blocks[slot];
+    if (old.ptr != NULL) {
+      block_release(slot);
+    }
+  }
+  void *resized = realloc(ptr, size);
+  if (resized != NULL) {
+    track_count_allocation(subsystem, resized, size);
+  } else if (old.ptr != NULL) {
+    // realloc() failed, so the old block is still live
+    blocks_insert(old);
+    subsystem_stats[old.subsystem].live_bytes += old.size;
+  }
+  pthread_mutex_unlock(&track_lock);
+  return resized;
+}
+
+void track_free(void *ptr) {
+  if (tracking && ptr != NULL) {
+    pthread_mutex_lock(&track_lock);
+    track_count_free(ptr);
+    pthread_mutex_unlock(&track_lock);
+  }
+  free(ptr);
+}
+
+void alloc_track_enable(void) {
+  pthread_mutex_lock(&track_lock);
+  if (tracked_blocks == NULL) {
+    blocks_grow();
+  }
+  tracking = true;
+  pthread_mutex_unlock(&track_lock);
+}
+
+void alloc_track_disable(void) {
+  pthread_mutex_lock(&track_lock);
+  tracking = false;
+  free(tracked_blocks);
+  tracked_blocks = NULL;
+  tracked_slots = 0;
+  num_tracked_blocks = 0;
+  for (alloc_subsystem_t i = 0; i < NUM_ALLOC_SUBSYSTEMS; i++) {
+    subsystem_stats[i] = (alloc_stats_t){0};
+  }
+  pthread_mutex_unlock(&track_lock);
+}
+
+bool alloc_track_enabled(void) { return tracking; }
+
+void alloc_track_reset(void) {
+  pthread_mutex_lock(&track_lock);
+  for (alloc_subsystem_t i = 0; i < NUM_ALLOC_SUBSYSTEMS; i++) {
+    size_t live_bytes = subsystem_stats[i].live_bytes;
+    subsystem_stats[i] = (alloc_stats_t){.live_bytes = live_bytes,
+                               .peak_bytes = live_bytes};
+  }
+  pthread_mutex_unlock(&track_lock);
+}
+
+alloc_stats_t alloc_track_stats(alloc_subsystem_t subsystem) {
+  assert(subsystem < NUM_ALLOC_SUBSYSTEMS);
+  pthread_mutex_lock(&track_lock);
+  alloc_stats_t counts = subsystem_stats[subsystem];
+  pthread_mutex_unlock(&track_lock);
+  return counts;
+}
+
+size_t alloc_track_total(void) {
+  pthread_mutex_lock(&track_lock);
+  size_t total = 0;
+  for (alloc_subsystem_t i = 0; i < NUM_ALLOC_SUBSYSTEMS; i++) {
+    total += subsystem_stats[i].allocations;
+  }
+  pthread_mutex_unlock(&track_lock);
+  return total;
+}
+
+const char *alloc_subsystem_name(alloc_subsystem_t subsystem) {
+  assert(subsystem < NUM_ALLOC_SUBSYSTEMS);
+  return ALLOC_SUBSYSTEM_NAMES[subsystem];
+}
+
+void alloc_track_print(void) {
+  printf("%-10s %12s %12s %14s %12s %12s\n", "subsystem", "allocations",
+         "frees", "bytes", "live bytes", "peak bytes");
+  for (alloc_subsystem_t i = 0; i < NUM_ALLOC_SUBSYSTEMS; i++) {
+    alloc_stats_t s = alloc_track_stats(i);
+    printf("%-10s %12zu %12zu %14zu %12zu %12zu\n", alloc_subsystem_name(i),
+           s.allocations, s.frees, s.bytes, s.live_bytes, s.peak_bytes);
+  }
+  fflush(stdout);
+}
@@ -0,0 +1,366 @@
+#include "asset_pack.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const size_t ASSET_PACK_BYTES_PER_PIXEL = 4;
+const char PACK_MAGIC[4] = {'B', 'R', 'P', 'K'};
+const uint32_t PACK_VERSION = 2;
+// magic, version, page count, image count
+const size_t HEADER_SIZE = 16;
+// width, height, offset of the pixels
+const size_t PAGE_ENTRY_SIZE = 12;
+// page, x, y, width, height, offset and length of the name
+const size_t IMAGE_ENTRY_SIZE = 28;
+// pixel data starts on this boundary so mapped rows are aligned
+const size_t PAGE_ALIGNMENT = 16;
+// images no bigger than this in either direction share atlas pages
+const size_t ATLAS_SPRITE_MAX = 256;
+const size_t ATLAS_PAGE_SIZE = 1024;
+const size_t INITIAL_IMAGE_CAPACITY = 16;
+
+typedef struct pending_image {
+  char *name;
+  size_t width;
+  size_t height;
+  uint8_t *pixels;
+  asset_image_t placement;
+} pending_image_t;
+
+typedef struct asset_pack_writer {
+  pending_image_t *images;
+  size_t num_images;
+  size_t capacity;
+} asset_pack_writer_t;
+
+typedef struct asset_pack {
+  void *data;
+  size_t size;
+  asset_page_t *pages;
+  size_t num_pages;
+  asset_image_t *images;
+  size_t num_images;
+} asset_pack_t;
+
+asset_pack_writer_t *asset_pack_writer_init(void) {
+  asset_pack_writer_t *writer = malloc(sizeof(asset_pack_writer_t));
+  assert(writer != NULL);
+  writer->images = malloc(INITIAL_IMAGE_CAPACITY * sizeof(pending_image_t));
+  assert(writer->images != NULL);
+  writer->num_images = 0;
+  writer->capacity = INITIAL_IMAGE_CAPACITY;
+  return writer;
+}
+
+void asset_pack_writer_free(asset_pack_writer_t *writer) {
+  for (size_t i = 0; i < writer->num_images; i++) {
+    free(writer->images[i].name);
+    free(writer->images[i].pixels);
+  }
+  free(writer->images);
+  free(writer);
+}
+
+size_t asset_pack_writer_add(asset_pack_writer_t *writer, const char *name,
+                             size_t width, size_t height,
+                             const uint8_t *pixels) {
+  assert(name != NULL);
+  assert(width > 0 && height > 0);
+  if (writer->num_images == writer->capacity) {
+    writer->capacity *= 2;
+    pending_image_t *images =
+        realloc(writer->images, writer->capacity * sizeof(pending_image_t));
+    assert(images != NULL);
+    writer->images = images;
+  }
+  size_t size = width * height * ASSET_PACK_BYTES_PER_PIXEL;
+  uint8_t *copy = malloc(size);
+  assert(copy != NULL);
+  memcpy(copy, pixels, size);
+  char *name_copy = malloc(strlen(name) + 1);
+  assert(name_copy != NULL);
+  strcpy(name_copy, name);
+  writer->images[writer->num_images] = (pending_image_t){
+      .name = name_copy, .width = width, .height = height, .pixels = copy};
+  return writer->num_images++;
+}
+
+bool is_sprite(pending_image_t *image) {
+  return image->width <= ATLAS_SPRITE_MAX && image->height <= ATLAS_SPRITE_MAX;
+}
+
+// orders sprites tallest first, so each shelf's first sprite sets its height
+int compare_heights(const void *a, const void *b) {
+  const pending_image_t *image1 = *(pending_image_t *const *)a;
+  const pending_image_t *image2 = *(pending_image_t *const *)b;
+  if (image1->height != image2->height) {
+    return image1->height < image2->height ? 1 : -1;
+  }
+  // keep the order the images were added in, since qsort is not stable
+  return (image1 > image2) - (image1 < image2);
+}
+
+/**
+ * Assigns every image a page and position.
+ * Large images each get their own page, sized to fit;
+ * sprites are packed onto shared pages in rows ("shelves").
+ * Returns the number of pages and fills in their sizes.
+ */
+size_t layout_pages(asset_pack_writer_t *writer, asset_page_t *pages) {
+  size_t num_pages = 0;
+  pending_image_t **sprites =
+      malloc(writer->num_images * sizeof(pending_image_t *));
+  assert(sprites != NULL);
+  size_t num_sprites = 0;
+  for (size_t i = 0; i < writer->num_images; i++) {
+    pending_image_t *image = &writer->images[i];
+    if (is_sprite(image)) {
+      sprites[num_sprites++] = image;
+      continue;
+    }
+    image->placement = (asset_image_t){.page = num_pages,
+                                       .width = image->width,
+                                       .height = image->height};
+    pages[num_pages++] =
+        (asset_page_t){.width = image->width, .height = image->height};
+  }
+
+  qsort(sprites, num_sprites, sizeof(pending_image_t *), compare_heights);
+  asset_page_t *atlas = NULL;
+  size_t shelf_y = 0, shelf_height = 0, pen_x = 0;
+  for (size_t i = 0; i < num_sprites; i++) {
+    pending_image_t *sprite = sprites[i];
+    if (atlas != NULL && pen_x + sprite->width > ATLAS_PAGE_SIZE) {
+      // start a new shelf under the current one
+      shelf_y += shelf_height;
+      shelf_height = 0;
+      pen_x = 0;
+    }
+    if (atlas == NULL || shelf_y + sprite->height > ATLAS_PAGE_SIZE) {
+      atlas = &pages[num_pages++];
+      *atlas = (asset_page_t){0};
+      shelf_y = 0;
+      shelf_height = 0;
+      pen_x = 0;
+    }
+    if (shelf_height == 0) {
+      shelf_height = sprite->height;
+    }
+    sprite->placement = (asset_image_t){.page = atlas - pages,
+                                        .x = pen_x,
+                                        .y = shelf_y,
+                                        .width = sprite->width,
+                                        .height = sprite->height};
+    pen_x += sprite->width;
+    if (pen_x > atlas->width) {
+      atlas->width = pen_x;
+    }
+    if (shelf_y + shelf_height > atlas->height) {
+      atlas->height = shelf_y + shelf_height;
+    }
+  }
+  free(sprites);
+  return num_pages;
+}
+
+void put_u32(uint8_t *buffer, uint32_t value) {
+  for (size_t i = 0; i < 4; i++) {
+    buffer[i] = (value >> (8 * i)) & 0xFF;
+  }
+}
+
+uint32_t get_u32(const uint8_t *buffer) {
+  uint32_t value = 0;
+  for (size_t i = 0; i < 4; i++) {
+    value |= (uint32_t)buffer[i] << (8 * i);
+  }
+  return value;
+}
+
+size_t align_offset(size_t offset) {
+  return (offset + PAGE_ALIGNMENT - 1) / PAGE_ALIGNMENT * PAGE_ALIGNMENT;
+}
+
+size_t page_size(asset_page_t page) {
+  return page.width * page.height * ASSET_PACK_BYTES_PER_PIXEL;
+}
+
+bool asset_pack_writer_save(asset_pack_writer_t *writer, const char *path) {
+  // there can never be more pages than images
+  asset_page_t *pages = malloc((writer->num_images + 1) * sizeof(asset_page_t));
+  assert(pages != NULL);
+  size_t num_pages = layout_pages(writer, pages);
+
+  size_t table_size = HEADER_SIZE + num_pages * PAGE_ENTRY_SIZE +
+                      writer->num_images * IMAGE_ENTRY_SIZE;
+  // the names follow the tables, each with a terminating NUL
+  size_t names_offset = table_size;
+  for (size_t i = 0; i < writer->num_images; i++) {
+    table_size += strlen(writer->images[i].name) + 1;
+  }
+  size_t *offsets = malloc((num_pages + 1) * sizeof(size_t));
+  assert(offsets != NULL);
+  size_t offset = align_offset(table_size);
+  for (size_t i = 0; i < num_pages; i++) {
+    offsets[i] = offset;
+    offset = align_offset(offset + page_size(pages[i]));
+  }
+  assert(offset <= UINT32_MAX);
+
+  // build the whole file in memory, since the layout is already known
+  uint8_t *file = calloc(offset, 1);
+  assert(file != NULL);
+  memcpy(file, PACK_MAGIC, sizeof(PACK_MAGIC));
+  put_u32(file + 4, PACK_VERSION);
+  put_u32(file + 8, num_pages);
+  put_u32(file + 12, writer->num_images);
+  uint8_t *entry = file + HEADER_SIZE;
+  for (size_t i = 0; i < num_pages; i++, entry += PAGE_ENTRY_SIZE) {
+    put_u32(entry, pages[i].width);
+    put_u32(entry + 4, pages[i].height);
+    put_u32(entry + 8, offsets[i]);
+  }
+  for (size_t i = 0; i < writer->num_images; i++, entry += IMAGE_ENTRY_SIZE) {
+    pending_image_t *image = &writer->images[i];
+    asset_image_t placement = image->placement;
+    put_u32(entry, placement.page);
+    put_u32(entry + 4, placement.x);
+    put_u32(entry + 8, placement.y);
+    put_u32(entry + 12, placement.width);
+    put_u32(entry + 16, placement.height);
+    size_t name_length = strlen(image->name);
+    put_u32(entry + 20, names_offset);
+    put_u32(entry + 24, name_length);
+    memcpy(file + names_offset, image->name, name_length + 1);
+    names_offset += name_length + 1;
+
+    size_t row_size = image->width * ASSET_PACK_BYTES_PER_PIXEL;
+    size_t page_row_size = pages[placement.page].width * ASSET_PACK_BYTES_PER_PIXEL;
+    uint8_t *destination = file + offsets[placement.page] +
+                           placement.y * page_row_size +
+                           placement.x * ASSET_PACK_BYTES_PER_PIXEL;
+    for (size_t row = 0; row < image->height; row++) {
+      memcpy(destination + row * page_row_size, image->pixels + row * row_size,
+             row_size);
+    }
+  }
+
+  FILE *out = fopen(path, "wb");
+  bool written = out != NULL && fwrite(file, 1, offset, out) == offset;
+  if (out != NULL && fclose(out) != 0) {
+    written = false;
+  }
+  free(file);
+  free(offsets);
+  free(pages);
+  return written;
+}
+
+/** Checks the tables of a mapped pack and reads them into the pack */
+bool read_tables(asset_pack_t *pack) {
+  const uint8_t *data = pack->data;
+  if (pack->size < HEADER_SIZE ||
+      memcmp(data, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 ||
+      get_u32(data + 4) != PACK_VERSION) {
+    return false;
+  }
+  pack->num_pages = get_u32(data + 8);
+  pack->num_images = get_u32(data + 12);
+  size_t table_size = HEADER_SIZE + pack->num_pages * PAGE_ENTRY_SIZE +
+                      pack->num_images * IMAGE_ENTRY_SIZE;
+  if (table_size > pack->size) {
+    return false;
+  }
+
+  pack->pages = malloc((pack->num_pages + 1) * sizeof(asset_page_t));
+  pack->images = malloc((pack->num_images + 1) * sizeof(asset_image_t));
+  assert(pack->pages != NULL && pack->images != NULL);
+  const uint8_t *entry = data + HEADER_SIZE;
+  for (size_t i = 0; i < pack->num_pages; i++, entry += PAGE_ENTRY_SIZE) {
+    asset_page_t page = {.width = get_u32(entry), .height = get_u32(entry + 4)};
+    size_t offset = get_u32(entry + 8);
+    if (offset > pack->size || page_size(page) > pack->size - offset) {
+      return false;
+    }
+    page.pixels = data + offset;
+    pack->pages[i] = page;
+  }
+  for (size_t i = 0; i < pack->num_images; i++, entry += IMAGE_ENTRY_SIZE) {
+    asset_image_t image = {.page = get_u32(entry),
+                           .x = get_u32(entry + 4),
+                           .y = get_u32(entry + 8),
+                           .width = get_u32(entry + 12),
+                           .height = get_u32(entry + 16)};
+    if (image.page >= pack->num_pages ||
+        image.x + image.width > pack->pages[image.page].width ||
+        image.y + image.height > pack->pages[image.page].height) {
+      return false;
+    }
+    // the name must end in a NUL, and not before its length
+    size_t name_offset = get_u32(entry + 20);
+    size_t name_length = get_u32(entry + 24);
+    if (name_offset > pack->size || name_length >= pack->size - name_offset ||
+        data[name_offset + name_length] != '\0' ||
+        memchr(data + name_offset, '\0', name_length) != NULL) {
+      return false;
+    }
+    image.name = (const char *)data + name_offset;
+    pack->images[i] = image;
+  }
+  return true;
+}
+
+asset_pack_t *asset_pack_open(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    return NULL;
+  }
+  struct stat info;
+  if (fstat(fd, &info) == -1 || info.st_size == 0) {
+    close(fd);
+    return NULL;
+  }
+  void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after the file is closed
+  close(fd);
+  if (data == MAP_FAILED) {
+    return NULL;
+  }
+
+  asset_pack_t *pack = malloc(sizeof(asset_pack_t));
+  assert(pack != NULL);
+  *pack = (asset_pack_t){.data = data, .size = info.st_size};
+  if (!read_tables(pack)) {
+    asset_pack_close(pack);
+    return NULL;
+  }
+  return pack;
+}
+
+void asset_pack_close(asset_pack_t *pack) {
+  munmap(pack->data, pack->size);
+  free(pack->pages);
+  free(pack->images);
+  free(pack);
+}
+
+size_t asset_pack_num_images(asset_pack_t *pack) { return pack->num_images; }
+
+size_t asset_pack_num_pages(asset_pack_t *pack) { return pack->num_pages; }
+
+asset_page_t asset_pack_get_page(asset_pack_t *pack, size_t index) {
+  assert(index < pack->num_pages);
+  return pack->pages[index];
+}
+
+asset_image_t asset_pack_get_image(asset_pack_t *pack, size_t index) {
+  assert(index < pack->num_images);
+  return pack->images[index];
+}
@@ -0,0 +1,80 @@
+#include "audio.h"
+#include <SDL2/SDL_mixer.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+const char MUSIC_PATH[] = "assets/life.wav";
+const char *SOUND_PATHS[NUM_SOUNDS] = {
+    [SOUND_COIN] = "assets/coin.wav",
+    [SOUND_HIT] = "assets/hit.wav",
+};
+// a few overlapping collision sounds are plenty; more just get muddy
+const int SOUND_CHANNELS = 4;
+const int SOUND_GROUP = 1;
+
+Mix_Music *music = NULL;
+Mix_Chunk *sounds[NUM_SOUNDS];
+
+void audio_init(void) {
+  music = Mix_LoadMUS(MUSIC_PATH);
+  if (music == NULL) {
+    fprintf(stderr, "failed to load music %s: %s\n", MUSIC_PATH,
+            Mix_GetError());
+  }
+  for (size_t i = 0; i < NUM_SOUNDS; i++) {
+    sounds[i] = Mix_LoadWAV(SOUND_PATHS[i]);
+    if (sounds[i] == NULL) {
+      fprintf(stderr, "failed to load sound %s: %s\n", SOUND_PATHS[i],
+              Mix_GetError());
+    }
+  }
+  Mix_AllocateChannels(SOUND_CHANNELS);
+  Mix_GroupChannels(0, SOUND_CHANNELS - 1, SOUND_GROUP);
+}
+
+void audio_free(void) {
+  Mix_HaltChannel(-1);
+  Mix_HaltMusic();
+  for (size_t i = 0; i < NUM_SOUNDS; i++) {
+    if (sounds[i] != NULL) {
+      Mix_FreeChunk(sounds[i]);
+      sounds[i] = NULL;
+    }
+  }
+  if (music != NULL) {
+    Mix_FreeMusic(music);
+    music = NULL;
+  }
+}
+
+void audio_play_music(void) {
+  if (music != NULL) {
+    Mix_PlayMusic(music, -1);
+  }
+}
+
+void audio_stop_music(void) { Mix_HaltMusic(); }
+
+void audio_fade_in_music(int ms) {
+  if (music != NULL) {
+    Mix_FadeInMusic(music, -1, ms);
+  }
+}
+
+void audio_fade_out_music(int ms) { Mix_FadeOutMusic(ms); }
+
+bool audio_music_playing(void) { return Mix_PlayingMusic(); }
+
+void audio_play_sound(sound_t sound) {
+  Mix_Chunk *chunk = sounds[sound];
+  if (chunk == NULL) {
+    return;
+  }
+  int channel = Mix_GroupAvailable(SOUND_GROUP);
+  if (channel == -1) {
+    channel = Mix_GroupOldest(SOUND_GROUP);
+    Mix_HaltChannel(channel);
+  }
+  Mix_PlayChannel(channel, chunk, 0);
+}
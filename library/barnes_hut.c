@@ -0,0 +1,243 @@
+#include "barnes_hut.h"
+#include "vector.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define ALLOC_SUBSYSTEM ALLOC_FORCES
+#include "alloc_track.h"
+
+// points this close together are kept in one leaf instead of splitting
+// the tree forever
+#define MAX_TREE_DEPTH 32
+// a query visits at most 3 siblings per level, plus the 4 children it opens
+#define QUERY_STACK_SIZE (3 * MAX_TREE_DEPTH + 4)
+
+const size_t INITIAL_POINT_CAPACITY = 64;
+// marks the end of a leaf's points, and a leaf's missing children
+const size_t TREE_NONE = (size_t)-1;
+
+// a point mass and the next point in the same leaf
+typedef struct point {
+  vector_t position;
+  double mass;
+  size_t next;
+} point_t;
+
+// a square region of the tree
+typedef struct node {
+  vector_t center;
+  double half_width;
+  double mass;
+  // the weighted sum of the positions until the tree is built,
+  // then the center of mass
+  vector_t mass_center;
+  // the first of the node's 4 children, or TREE_NONE for a leaf
+  size_t children;
+  // the first of a leaf's points, or TREE_NONE
+  size_t first;
+} node_t;
+
+typedef struct barnes_hut {
+  point_t *points;
+  size_t num_points;
+  size_t point_capacity;
+  node_t *nodes;
+  size_t num_nodes;
+  size_t node_capacity;
+} barnes_hut_t;
+
+barnes_hut_t *barnes_hut_init(void) {
+  barnes_hut_t *tree = malloc(sizeof(barnes_hut_t));
+  assert(tree != NULL);
+  tree->points = malloc(INITIAL_POINT_CAPACITY * sizeof(point_t));
+  assert(tree->points != NULL);
+  tree->num_points = 0;
+  tree->point_capacity = INITIAL_POINT_CAPACITY;
+  // a tree usually has a couple of nodes per point
+  tree->node_capacity = 2 * INITIAL_POINT_CAPACITY;
+  tree->nodes = malloc(tree->node_capacity * sizeof(node_t));
+  assert(tree->nodes != NULL);
+  tree->num_nodes = 0;
+  return tree;
+}
+
+void barnes_hut_free(barnes_hut_t *tree) {
+  free(tree->points);
+  free(tree->nodes);
+  free(tree);
+}
+
+void barnes_hut_clear(barnes_hut_t *tree) {
+  tree->num_points = 0;
+  tree->num_nodes = 0;
+}
+
+size_t barnes_hut_add(barnes_hut_t *tree, vector_t position, double mass) {
+  assert(mass >= 0 && mass != INFINITY);
+  if (tree->num_points == tree->point_capacity) {
+    tree->point_capacity *= 2;
+    tree->points =
+        realloc(tree->points, tree->point_capacity * sizeof(point_t));
+    assert(tree->points != NULL);
+  }
+  tree->points[tree->num_points] =
+      (point_t){.position = position, .mass = mass, .next = TREE_NONE};
+  return tree->num_points++;
+}
+
+size_t barnes_hut_size(barnes_hut_t *tree) { return tree->num_points; }
+
+size_t tree_add_node(barnes_hut_t *tree, vector_t center, double half_width) {
+  if (tree->num_nodes == tree->node_capacity) {
+    tree->node_capacity *= 2;
+    tree->nodes = realloc(tree->nodes, tree->node_capacity * sizeof(node_t));
+    assert(tree->nodes != NULL);
+  }
+  tree->nodes[tree->num_nodes] = (node_t){.center = center,
+                                          .half_width = half_width,
+                                          .mass = 0,
+                                          .mass_center = VEC_ZERO,
+                                          .children = TREE_NONE,
+                                          .first = TREE_NONE};
+  return tree->num_nodes++;
+}
+
+// the child of a node whose quadrant holds a position
+size_t node_child(node_t *node, vector_t position) {
+  size_t quadrant = (position.x >= node->center.x ? 1 : 0) +
+                    (position.y >= node->center.y ? 2 : 0);
+  return node->children + quadrant;
+}
+
+// gives a leaf 4 children and moves its point into one of them
+void tree_split(barnes_hut_t *tree, size_t leaf) {
+  double quarter = tree->nodes[leaf].half_width / 2;
+  vector_t center = tree->nodes[leaf].center;
+  size_t children = tree_add_node(
+      tree, (vector_t){center.x - quarter, center.y - quarter}, quarter);
+  tree_add_node(tree, (vector_t){center.x + quarter, center.y - quarter},
+                quarter);
+  tree_add_node(tree, (vector_t){center.x - quarter, center.y + quarter},
+                quarter);
+  tree_add_node(tree, (vector_t){center.x + quarter, center.y + quarter},
+                quarter);
+  node_t *node = &tree->nodes[leaf];
+  node->children = children;
+  // only leaves at the deepest level hold more than one point
+  point_t *point = &tree->points[node->first];
+  node_t *child = &tree->nodes[node_child(node, point->position)];
+  child->first = node->first;
+  child->mass = point->mass;
+  child->mass_center = vec_multiply(point->mass, point->position);
+  node->first = TREE_NONE;
+}
+
+void tree_insert(barnes_hut_t *tree, size_t index) {
+  point_t *point = &tree->points[index];
+  vector_t weighted = vec_multiply(point->mass, point->position);
+  size_t current = 0;
+  for (size_t depth = 0;; depth++) {
+    node_t *node = &tree->nodes[current];
+    node->mass += point->mass;
+    node->mass_center = vec_add(node->mass_center, weighted);
+    if (node->children == TREE_NONE) {
+      if (node->first == TREE_NONE || depth == MAX_TREE_DEPTH) {
+        point->next = node->first;
+        node->first = index;
+        return;
+      }
+      tree_split(tree, current);
+      // splitting may have moved the nodes
+      node = &tree->nodes[current];
+    }
+    current = node_child(node, point->position);
+  }
+}
+
+void barnes_hut_build(barnes_hut_t *tree) {
+  tree->num_nodes = 0;
+  if (tree->num_points == 0) {
+    return;
+  }
+  vector_t min = tree->points[0].position;
+  vector_t max = min;
+  for (size_t i = 1; i < tree->num_points; i++) {
+    vector_t position = tree->points[i].position;
+    min.x = fmin(min.x, position.x);
+    min.y = fmin(min.y, position.y);
+    max.x = fmax(max.x, position.x);
+    max.y = fmax(max.y, position.y);
+  }
+  vector_t center = {(min.x + max.x) / 2, (min.y + max.y) / 2};
+  double half_width = fmax(max.x - min.x, max.y - min.y) / 2;
+  tree_add_node(tree, center, half_width);
+  for (size_t i = 0; i < tree->num_points; i++) {
+    tree->points[i].next = TREE_NONE;
+    tree_insert(tree, i);
+  }
+  for (size_t i = 0; i < tree->num_nodes; i++) {
+    node_t *node = &tree->nodes[i];
+    if (node->mass > 0) {
+      node->mass_center = vec_multiply(1 / node->mass, node->mass_center);
+    } else {
+      node->mass_center = node->center;
+    }
+  }
+}
+
+// the field at a position from a mass at another position
+vector_t point_field(vector_t position, vector_t source, double mass,
+                     double min_distance) {
+  vector_t displacement = vec_subtract(source, position);
+  double distance_squared = vec_dot(displacement, displacement);
+  if (distance_squared == 0) {
+    return VEC_ZERO;
+  }
+  double softened = fmax(distance_squared, min_distance * min_distance);
+  return vec_multiply(mass / (softened * sqrt(distance_squared)),
+                      displacement);
+}
+
+bool node_contains(node_t *node, vector_t position) {
+  return fabs(position.x - node->center.x) <= node->half_width &&
+         fabs(position.y - node->center.y) <= node->half_width;
+}
+
+vector_t barnes_hut_field(barnes_hut_t *tree, size_t point, double theta,
+                          double min_distance) {
+  assert(point < tree->num_points);
+  vector_t position = tree->points[point].position;
+  vector_t field = VEC_ZERO;
+  size_t stack[QUERY_STACK_SIZE];
+  size_t size = 0;
+  stack[size++] = 0;
+  while (size > 0) {
+    node_t *node = &tree->nodes[stack[--size]];
+    if (node->mass == 0) {
+      continue;
+    }
+    vector_t offset = vec_subtract(node->mass_center, position);
+    double distance = sqrt(vec_dot(offset, offset));
+    // a node around the point holds the point itself, so it is never merged
+    if (2 * node->half_width < theta * distance &&
+        !node_contains(node, position)) {
+      field = vec_add(field, point_field(position, node->mass_center,
+                                         node->mass, min_distance));
+    } else if (node->children == TREE_NONE) {
+      for (size_t i = node->first; i != TREE_NONE; i = tree->points[i].next) {
+        if (i != point) {
+          point_t *other = &tree->points[i];
+          field = vec_add(field, point_field(position, other->position,
+                                             other->mass, min_distance));
+        }
+      }
+    } else {
+      for (size_t i = 0; i < 4; i++) {
+        stack[size++] = node->children + i;
+      }
+    }
+  }
+  return field;
+}
@@ -0,0 +1,188 @@
+#include "bench_util.h"
+#include "list.h"
+#include "vector.h"
+#include <assert.h>
+#include <malloc.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+
+const size_t DEFAULT_REPETITIONS = 10;
+// a call must take at least this long for the clock to time it accurately
+const double MIN_CALL_SECONDS = 0.02;
+const double NS_PER_S = 1e9;
+const double NS_PER_MS = 1e6;
+const size_t BYTES_PER_KIB = 1024;
+
+volatile double bench_sink;
+// the counts behind bench_alloc_stats(); the job system's workers and the
+// loader threads allocate too, so they are updated atomically
+atomic_size_t num_allocations;
+atomic_size_t num_frees;
+atomic_size_t allocated_bytes;
+atomic_size_t peak_bytes;
+// bytes held by live allocations, as reported by malloc_usable_size()
+atomic_size_t live_bytes;
+size_t live_bytes_at_reset;
+
+// the real allocator, which the linker renames when wrapping it
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void count_allocation(void *ptr, size_t size) {
+  atomic_fetch_add(&num_allocations, 1);
+  atomic_fetch_add(&allocated_bytes, size);
+  size_t usable = malloc_usable_size(ptr);
+  size_t live = atomic_fetch_add(&live_bytes, usable) + usable;
+  size_t peak = atomic_load(&peak_bytes);
+  while (live > peak &&
+         !atomic_compare_exchange_weak(&peak_bytes, &peak, live)) {
+  }
+}
+
+void *__wrap_malloc(size_t size) {
+  void *ptr = __real_malloc(size);
+  if (ptr != NULL) {
+    count_allocation(ptr, size);
+  }
+  return ptr;
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  void *ptr = __real_calloc(count, size);
+  if (ptr != NULL) {
+    count_allocation(ptr, count * size);
+  }
+  return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  size_t old_size = ptr != NULL ? malloc_usable_size(ptr) : 0;
+  void *resized = __real_realloc(ptr, size);
+  if (resized != NULL) {
+    atomic_fetch_sub(&live_bytes, old_size);
+    count_allocation(resized, size);
+  }
+  return resized;
+}
+
+void __wrap_free(void *ptr) {
+  if (ptr != NULL) {
+    atomic_fetch_add(&num_frees, 1);
+    atomic_fetch_sub(&live_bytes, malloc_usable_size(ptr));
+  }
+  __real_free(ptr);
+}
+
+void bench_alloc_reset(void) {
+  live_bytes_at_reset = atomic_load(&live_bytes);
+  atomic_store(&num_allocations, 0);
+  atomic_store(&num_frees, 0);
+  atomic_store(&allocated_bytes, 0);
+  atomic_store(&peak_bytes, live_bytes_at_reset);
+}
+
+bench_alloc_stats_t bench_alloc_stats(void) {
+  // report the growth over what was allocated at the reset
+  return (bench_alloc_stats_t){
+      .allocations = atomic_load(&num_allocations),
+      .frees = atomic_load(&num_frees),
+      .bytes = atomic_load(&allocated_bytes),
+      .peak_bytes = atomic_load(&peak_bytes) - live_bytes_at_reset};
+}
+
+size_t bench_peak_rss_kib(void) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  // Linux reports the maximum resident set size in kibibytes
+  return usage.ru_maxrss;
+}
+
+double bench_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / NS_PER_S;
+}
+
+void bench_consume(double value) { bench_sink = value; }
+
+list_t *bench_regular_polygon(size_t num_vertices, double radius,
+                              vector_t center) {
+  assert(num_vertices >= 3);
+  list_t *polygon = list_init(num_vertices, free);
+  for (size_t i = 0; i < num_vertices; i++) {
+    double angle = 2 * M_PI * i / num_vertices;
+    vector_t *vertex = malloc(sizeof(vector_t));
+    assert(vertex != NULL);
+    *vertex = (vector_t){center.x + radius * cos(angle),
+                         center.y + radius * sin(angle)};
+    list_add(polygon, vertex);
+  }
+  return polygon;
+}
+
+size_t bench_repetitions(void) {
+  const char *reps = getenv("BENCH_REPS");
+  if (reps == NULL || strtoul(reps, NULL, 10) == 0) {
+    return DEFAULT_REPETITIONS;
+  }
+  return strtoul(reps, NULL, 10);
+}
+
+double time_call(bench_func_t func, void *aux, size_t iterations) {
+  double start = bench_now();
+  func(aux, iterations);
+  return bench_now() - start;
+}
+
+bench_result_t bench_run(const char *name, bench_func_t func, void *aux) {
+  // calibrate; this also warms up the caches
+  size_t iterations = 1;
+  while (time_call(func, aux, iterations) < MIN_CALL_SECONDS) {
+    iterations *= 2;
+  }
+
+  bench_result_t result = {.repetitions = bench_repetitions(),
+                           .iterations = iterations,
+                           .min_ns = INFINITY};
+  double sum = 0, sum_squares = 0;
+  bench_alloc_reset();
+  for (size_t i = 0; i < result.repetitions; i++) {
+    double ns = time_call(func, aux, iterations) * NS_PER_S / iterations;
+    sum += ns;
+    sum_squares += ns * ns;
+    result.min_ns = fmin(result.min_ns, ns);
+  }
+  bench_alloc_stats_t stats = bench_alloc_stats();
+  double ops = result.repetitions * iterations;
+  result.allocations_per_op = stats.allocations / ops;
+  result.bytes_per_op = stats.bytes / ops;
+  result.mean_ns = sum / result.repetitions;
+  double variance =
+      sum_squares / result.repetitions - result.mean_ns * result.mean_ns;
+  result.stddev_ns = sqrt(fmax(variance, 0));
+
+  printf("%-40s %12.1f ns/op  +- %8.1f  (min %.1f, %zu x %zu)  "
+         "%.1f allocs/op  %.0f B/op\n",
+         name, result.mean_ns, result.stddev_ns, result.min_ns,
+         result.repetitions, result.iterations, result.allocations_per_op,
+         result.bytes_per_op);
+  fflush(stdout);
+  return result;
+}
+
+double bench_once(const char *name, bench_func_t func, void *aux) {
+  bench_alloc_reset();
+  double ns = time_call(func, aux, 1) * NS_PER_S;
+  bench_alloc_stats_t stats = bench_alloc_stats();
+  printf("%-40s %12.3f ms  %8zu allocs  %10zu B  peak heap %zu KiB\n", name,
+         ns / NS_PER_MS, stats.allocations, stats.bytes,
+         stats.peak_bytes / BYTES_PER_KIB);
+  fflush(stdout);
+  return ns;
+}
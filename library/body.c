@@ -4,12 +4,16 @@
 #include "list.h"
 #include "polygon.h"
 #include "vector.h"
+#include "vector_math.h"
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 
+#define ALLOC_SUBSYSTEM ALLOC_BODY
+#include "alloc_track.h"
+
 typedef struct body {
   list_t *shape;
   vector_t forces;
@@ -19,6 +23,7 @@ typedef struct body {
   vector_t velocity;
   rgb_color_t color;
   vector_t center;
+  aabb_t bounds;
   void *info;
   free_func_t info_freer;
   bool remove;
@@ -28,12 +33,34 @@ typedef struct body {
   bool slow;
   bool double_points;
   bool magnet;
+  // collision categories the body is in, and those it collides with
+  uint32_t category;
+  uint32_t mask;
+  // the categories a fast body is swept against, or 0
+  uint32_t ccd_categories;
 } body_t;
 
 typedef struct info {
   size_t type;
 } info_t;
 
+typedef struct logged_force {
+  body_t *body;
+  vector_t vector;
+  bool impulse;
+} logged_force_t;
+
+typedef struct force_log {
+  logged_force_t *entries;
+  size_t size;
+  size_t capacity;
+} force_log_t;
+
+const size_t INITIAL_LOG_CAPACITY = 64;
+
+// the log body_add_force() and body_add_impulse() record into on this thread
+_Thread_local force_log_t *active_force_log = NULL;
+
 typedef struct picture {
   size_t width;
   size_t length;
@@ -86,6 +113,7 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
   body->impulses = VEC_ZERO;
   body->color = color;
   body->center = polygon_centroid(shape);
+  body->bounds = polygon_bounds(shape);
   // add info and info_freer
   body->info = info;
   body->info_freer = info_freer;
@@ -97,6 +125,9 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
   body->picture= picture;
   body->slow = false;
   body->magnet = false;
+  body->category = 0;
+  body->mask = UINT32_MAX;
+  body->ccd_categories = 0;
   return body;
 }
 
@@ -133,8 +164,12 @@ list_t *body_get_shape(body_t *body) {
   return r_shape;
 }
 
+list_t *body_borrow_shape(body_t *body) { return body->shape; }
+
 vector_t body_get_centroid(body_t *body) { return body->center; }
 
+aabb_t body_get_bounds(body_t *body) { return body->bounds; }
+
 vector_t body_get_velocity(body_t *body) { return body->velocity; }
 
 rgb_color_t body_get_color(body_t *body) { return body->color; }
@@ -144,8 +179,9 @@ double body_get_mass(body_t *body) { return body->mass; }
 double body_get_mu(body_t *body) {return body->friction_coeff;}
 
 void body_set_centroid(body_t *body, vector_t vec) {
-  vector_t translate = vec_subtract(vec, body->center);
+  vector_t translate = vm_subtract(vec, body->center);
   polygon_translate(body->shape, translate);
+  body->bounds = aabb_translate(body->bounds, translate);
   body->center.x = vec.x;
   body->center.y = vec.y;
 }
@@ -157,6 +193,7 @@ void body_set_velocity(body_t *body, vector_t v) { body->velocity = v;
 
 void body_set_rotation(body_t *body, double angle) {
   polygon_rotate(body->shape, angle, body_get_centroid(body));
+  body->bounds = polygon_bounds(body->shape);
 }
 
 void body_set_score(body_t *body, double score){
@@ -196,33 +233,94 @@ void body_negate_score(body_t *body){
   body->score = - body->score;
 }
 
+void force_log_add(force_log_t *log, body_t *body, vector_t vector,
+                   bool impulse) {
+  if (log->size == log->capacity) {
+    log->capacity *= 2;
+    logged_force_t *entries =
+        realloc(log->entries, log->capacity * sizeof(logged_force_t));
+    assert(entries != NULL);
+    log->entries = entries;
+  }
+  log->entries[log->size++] =
+      (logged_force_t){.body = body, .vector = vector, .impulse = impulse};
+}
+
 void body_add_force(body_t *body, vector_t force) {
-  body->forces = vec_add(body->forces, force);
+  if (active_force_log != NULL) {
+    force_log_add(active_force_log, body, force, false);
+    return;
+  }
+  body->forces = vm_add(body->forces, force);
 }
 
 void body_add_impulse(body_t *body, vector_t impulse) {
-  body->impulses = vec_add(body->impulses, impulse);
+  if (active_force_log != NULL) {
+    force_log_add(active_force_log, body, impulse, true);
+    return;
+  }
+  body->impulses = vm_add(body->impulses, impulse);
+}
+
+force_log_t *force_log_init(void) {
+  force_log_t *log = malloc(sizeof(force_log_t));
+  assert(log != NULL);
+  log->entries = malloc(INITIAL_LOG_CAPACITY * sizeof(logged_force_t));
+  assert(log->entries != NULL);
+  log->size = 0;
+  log->capacity = INITIAL_LOG_CAPACITY;
+  return log;
+}
+
+void force_log_free(force_log_t *log) {
+  free(log->entries);
+  free(log);
+}
+
+void force_log_begin(force_log_t *log) {
+  assert(active_force_log == NULL);
+  log->size = 0;
+  active_force_log = log;
+}
+
+void force_log_end(void) { active_force_log = NULL; }
+
+void force_log_apply(force_log_t *log) {
+  for (size_t i = 0; i < log->size; i++) {
+    logged_force_t *entry = &log->entries[i];
+    if (entry->impulse) {
+      body_add_impulse(entry->body, entry->vector);
+    } else {
+      body_add_force(entry->body, entry->vector);
+    }
+  }
+}
+
+// the velocity of a body at the end of the tick
+vector_t body_next_velocity(body_t *body, double dt) {
+  // F = ma
+  vector_t a = vm_multiply(1.0 / (body_get_mass(body)), body->forces);
+  // J (impulse) = delta_v * m if m is constant
+  vector_t delta_v = vm_multiply(1.0 / (body_get_mass(body)), body->impulses);
+  return vm_add(delta_v, vm_add(body->velocity, vm_multiply(dt, a)));
+}
+
+vector_t body_get_motion(body_t *body, double dt) {
+  vector_t new_v = body_next_velocity(body, dt);
+  return vm_multiply(dt / 2, vm_add(body->velocity, new_v));
 }
 
 void body_tick(body_t *body, double dt) {
   if (!body_is_removed(body)) {
-
-    // F = ma
-    vector_t a = vec_multiply(1.0 / (body_get_mass(body)), body->forces);
-    // J (impulse) = delta_v * m if m is constant
-    vector_t delta_v =
-        vec_multiply(1.0 / (body_get_mass(body)), body->impulses);
     vector_t old_v = body->velocity;
-
-    body->velocity = vec_add(delta_v, vec_add(old_v, vec_multiply(dt, a)));
+    body->velocity = body_next_velocity(body, dt);
     // The body should be translated at the *average* of the
     // velocities before and after the tick
-    vector_t distance = vec_multiply(dt / 2, vec_add(old_v, body->velocity));
+    vector_t distance = vm_multiply(dt / 2, vm_add(old_v, body->velocity));
     vector_t old_center = body_get_centroid(body);
-    vector_t new_center = vec_add(old_center, distance);
+    vector_t new_center = vm_add(old_center, distance);
     body_set_centroid(body, new_center);
-    body->forces = VEC_ZERO;
-    body->impulses = VEC_ZERO;
+    body_clear_forces(body);
   }
 }
 
@@ -230,11 +328,16 @@ vector_t body_get_force(body_t *body) { return body->forces; }
 
 vector_t body_get_impulse(body_t *body) { return body->impulses; }
 
+void body_clear_forces(body_t *body) {
+  body->forces = VEC_ZERO;
+  body->impulses = VEC_ZERO;
+}
+
 void body_remove(body_t *body) { body->remove = 1; }
 
 bool body_is_removed(body_t *body) { return body->remove; }
 
-void body_add_velocity(body_t *body, vector_t v) {body->velocity = vec_add(body->velocity, v);}
+void body_add_velocity(body_t *body, vector_t v) {body->velocity = vm_add(body->velocity, v);}
 
 void body_set_slow(body_t *body, bool true_or_false){
   body->slow = true_or_false;
@@ -259,3 +362,18 @@ void body_set_magnet(body_t *body, bool true_or_false){
 bool body_get_magnet(body_t *body){
   return body->magnet;
 }
+
+void body_set_collision_filter(body_t *body, uint32_t category, uint32_t mask) {
+  body->category = category;
+  body->mask = mask;
+}
+
+uint32_t body_get_category(body_t *body) { return body->category; }
+
+uint32_t body_get_mask(body_t *body) { return body->mask; }
+
+void body_set_ccd_categories(body_t *body, uint32_t categories) {
+  body->ccd_categories = categories;
+}
+
+uint32_t body_get_ccd_categories(body_t *body) { return body->ccd_categories; }
@@ -2,12 +2,19 @@
 #include "body.h"
 #include "list.h"
 #include "scene.h"
+#include "vector_math.h"
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#define ALLOC_SUBSYSTEM ALLOC_COLLISION
+#include "alloc_track.h"
+
+// enough pairs that handing a chunk to another thread pays for itself
+const size_t COLLISION_CHUNK_SIZE = 32;
+
 // find the minimum value between 2 doubles
 double find_min(double a, double b) {
   double min = a;
@@ -19,46 +26,42 @@ double find_min(double a, double b) {
 
 // find the perpendicular line of the line connecting p1 and p2
 vector_t find_perpline(vector_t p1, vector_t p2) {
-  vector_t line = vec_subtract(p1, p2);
+  vector_t line = vm_subtract(p1, p2);
   vector_t perpline = {line.y, -line.x};
   return perpline;
 }
 
 // Given two points (a line), project them to a line
 vector_t line_project_to_line(vector_t p1, vector_t p2, vector_t line) {
-  vector_t vec = vec_subtract(p1, p2);
+  vector_t vec = vm_subtract(p1, p2);
   vector_t toreturn =
-      vec_multiply(vec_dot(vec, line) / vec_dot(line, line), line);
+      vm_multiply(vm_dot(vec, line) / vm_dot(line, line), line);
   return toreturn;
 }
 
 // Given a point, project it to a line
 vector_t point_project_to_line(vector_t p, vector_t line) {
   vector_t toreturn =
-      vec_multiply(vec_dot(p, line) / vec_dot(line, line), line);
+      vm_multiply(vm_dot(p, line) / vm_dot(line, line), line);
   return toreturn;
 }
 
 // return the magnitude of a vector
-double vec_magnitude(vector_t vec) { return sqrt(vec_dot(vec, vec)); }
+double vec_magnitude(vector_t vec) { return sqrt(vm_dot(vec, vec)); }
 
 typedef struct projected_line {
   vector_t max;
   vector_t min;
 } projected_line_t;
 
-projected_line_t *shape_project_to_line(list_t *shape, vector_t line) {
-  projected_line_t *toreturn = malloc(sizeof(projected_line_t));
-  assert(toreturn != NULL);
-  vector_t min;
-  vector_t max;
-  for (size_t i = 0; i < list_size(shape); i++) {
+projected_line_t shape_project_to_line(list_t *shape, vector_t line) {
+  projected_line_t toreturn;
+  assert(list_size(shape) > 0);
+  vector_t min = point_project_to_line(*(vector_t *)list_get(shape, 0), line);
+  vector_t max = min;
+  for (size_t i = 1; i < list_size(shape); i++) {
     vector_t *point = (vector_t *)list_get(shape, i);
     vector_t after_projected = point_project_to_line(*point, line);
-    if (i == 0) {
-      max = after_projected;
-      min = after_projected;
-    }
     // If the "line" is parallel to the y axis, then any line projected onto
     // this "line" will all have x_value = 0, so we should compare the y_values
     // of each projected point.
@@ -81,8 +84,8 @@ projected_line_t *shape_project_to_line(list_t *shape, vector_t line) {
       }
     }
   }
-  toreturn->min = min;
-  toreturn->max = max;
+  toreturn.min = min;
+  toreturn.max = max;
   return toreturn;
 }
 
@@ -103,65 +106,189 @@ bool two_segments_not_overlap(projected_line_t *projline1,
 collision_info_t find_collision(list_t *shape1, list_t *shape2) {
   double min_overlap_len = INFINITY;
   vector_t min_overlap_axis = VEC_ZERO;
+  // unlike min_overlap_len, counts axes the shapes only touch along
+  double depth = INFINITY;
   bool overlap = 1;
   for (size_t i = 0; i < list_size(shape1); i++) {
     vector_t p1 = *(vector_t *)list_get(shape1, i);
     vector_t p2 = *(vector_t *)list_get(shape1, (i + 1) % list_size(shape1));
     vector_t perp = find_perpline(p1, p2);
-    projected_line_t *projline1 = shape_project_to_line(shape1, perp);
-    projected_line_t *projline2 = shape_project_to_line(shape2, perp);
+    projected_line_t projline1 = shape_project_to_line(shape1, perp);
+    projected_line_t projline2 = shape_project_to_line(shape2, perp);
     // the projections onto this perpline do not overlap
-    if (two_segments_not_overlap(projline1, projline2)) {
+    if (two_segments_not_overlap(&projline1, &projline2)) {
       overlap = 0;
-      free(projline1);
-      free(projline2);
       break;
     }
     // the projections onto this perpline do not overlap
     else {
-      double overlap_len = find_min(distance(projline1->max, projline2->min),
-                                    distance(projline2->max, projline1->min));
+      double overlap_len = find_min(vm_distance(projline1.max, projline2.min),
+                                    vm_distance(projline2.max, projline1.min));
+      depth = find_min(depth, overlap_len);
       if (overlap_len < min_overlap_len && overlap_len != 0) {
         min_overlap_len = overlap_len;
         min_overlap_axis = perp;
       }
     }
-    free(projline1);
-    free(projline2);
   }
   for (size_t i = 0; i < list_size(shape2); i++) {
     vector_t p1 = *(vector_t *)list_get(shape2, i);
     vector_t p2 = *(vector_t *)list_get(shape2, (i + 1) % list_size(shape2));
     vector_t perp = find_perpline(p1, p2);
-    projected_line_t *projline1 = shape_project_to_line(shape1, perp);
-    projected_line_t *projline2 = shape_project_to_line(shape2, perp);
+    projected_line_t projline1 = shape_project_to_line(shape1, perp);
+    projected_line_t projline2 = shape_project_to_line(shape2, perp);
     // the projections onto this perpline do not overlap
-    if (two_segments_not_overlap(projline1, projline2)) {
+    if (two_segments_not_overlap(&projline1, &projline2)) {
       overlap = 0;
-      free(projline1);
-      free(projline2);
       break;
     }
     // the projections onto this perpline do not overlap
     else {
-      double overlap_len = find_min(distance(projline1->max, projline2->min),
-                                    distance(projline2->max, projline1->min));
+      double overlap_len = find_min(vm_distance(projline1.max, projline2.min),
+                                    vm_distance(projline2.max, projline1.min));
+      depth = find_min(depth, overlap_len);
       if (overlap_len < min_overlap_len && overlap_len != 0) {
         min_overlap_len = overlap_len;
         min_overlap_axis = perp;
       }
     }
-    free(projline1);
-    free(projline2);
   }
 
   // unit overlap_axis
-  min_overlap_axis = normalize(min_overlap_axis);
+  min_overlap_axis = vm_normalize(min_overlap_axis);
 
   // create a struct to store collision info
   collision_info_t collision_info;
   collision_info.collided = overlap;
   collision_info.axis = min_overlap_axis;
+  collision_info.depth = overlap ? depth : 0;
 
   return collision_info;
 }
+
+// the pairs given to find_collisions() and where their results go
+typedef struct narrow_phase {
+  collision_pair_t *pairs;
+  collision_info_t *results;
+} narrow_phase_t;
+
+void find_collisions_range(void *aux, size_t start, size_t end) {
+  narrow_phase_t *narrow_phase = aux;
+  for (size_t i = start; i < end; i++) {
+    collision_pair_t *pair = &narrow_phase->pairs[i];
+    narrow_phase->results[i] = find_collision(pair->shape1, pair->shape2);
+  }
+}
+
+void find_collisions(job_system_t *jobs, collision_pair_t *pairs,
+                     size_t num_pairs, collision_info_t *results) {
+  narrow_phase_t narrow_phase = {.pairs = pairs, .results = results};
+  if (jobs == NULL || num_pairs <= COLLISION_CHUNK_SIZE) {
+    find_collisions_range(&narrow_phase, 0, num_pairs);
+    return;
+  }
+  job_parallel_for(jobs, num_pairs, COLLISION_CHUNK_SIZE,
+                   find_collisions_range, &narrow_phase);
+}
+
+// the range of a shape's vertices along an axis
+void shape_interval(list_t *shape, vector_t axis, double *min, double *max) {
+  *min = INFINITY;
+  *max = -INFINITY;
+  for (size_t i = 0; i < list_size(shape); i++) {
+    double projected = vm_dot(*(vector_t *)list_get(shape, i), axis);
+    *min = find_min(*min, projected);
+    *max = projected > *max ? projected : *max;
+  }
+}
+
+// narrows the times a moving interval [min1, max1] overlaps a still
+// interval [min2, max2] along an axis; returns false if they never overlap
+bool sweep_interval(vector_t axis, double min1, double max1, double min2,
+                    double max2, vector_t motion, collision_sweep_t *sweep,
+                    double *exit) {
+  double speed = vm_dot(motion, axis);
+  if (speed == 0) {
+    return max1 >= min2 && max2 >= min1;
+  }
+  // the moving interval covers [min1, max1] + speed * t along the axis
+  double enter = (speed > 0 ? min2 - max1 : max2 - min1) / speed;
+  double leave = (speed > 0 ? max2 - min1 : min2 - max1) / speed;
+  if (enter > sweep->time) {
+    sweep->time = enter;
+    sweep->axis = speed > 0 ? axis : vm_negate(axis);
+  }
+  *exit = find_min(*exit, leave);
+  return sweep->time <= *exit;
+}
+
+// narrows the times the moving shape overlaps the other along each of the
+// edge normals of a shape; returns false if they never overlap
+bool sweep_edge_normals(list_t *edges, list_t *shape1, list_t *shape2,
+                        vector_t motion, collision_sweep_t *sweep,
+                        double *exit) {
+  size_t size = list_size(edges);
+  for (size_t i = 0; i < size; i++) {
+    vector_t p1 = *(vector_t *)list_get(edges, i);
+    vector_t p2 = *(vector_t *)list_get(edges, (i + 1) % size);
+    vector_t axis = find_perpline(p1, p2);
+    double min1, max1, min2, max2;
+    shape_interval(shape1, axis, &min1, &max1);
+    shape_interval(shape2, axis, &min2, &max2);
+    if (!sweep_interval(axis, min1, max1, min2, max2, motion, sweep, exit)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// turns the overlapping times found by the sweeps into a result
+collision_sweep_t sweep_result(collision_sweep_t sweep, double exit) {
+  if (sweep.time > 1 || exit < 0) {
+    return (collision_sweep_t){.collided = false, .time = 0,
+                               .axis = VEC_ZERO};
+  }
+  sweep.collided = true;
+  if (sweep.time <= 0) {
+    sweep.time = 0;
+  } else {
+    sweep.axis = vm_normalize(sweep.axis);
+  }
+  return sweep;
+}
+
+collision_sweep_t find_time_of_impact(list_t *shape1, vector_t motion1,
+                                      list_t *shape2, vector_t motion2) {
+  vector_t motion = vm_subtract(motion1, motion2);
+  collision_sweep_t sweep = {.collided = false, .time = -INFINITY,
+                             .axis = VEC_ZERO};
+  double exit = INFINITY;
+  if (!sweep_edge_normals(shape1, shape1, shape2, motion, &sweep, &exit) ||
+      !sweep_edge_normals(shape2, shape1, shape2, motion, &sweep, &exit)) {
+    return (collision_sweep_t){.collided = false, .time = 0,
+                               .axis = VEC_ZERO};
+  }
+  return sweep_result(sweep, exit);
+}
+
+collision_sweep_t find_ray_impact(vector_t origin, vector_t motion,
+                                  list_t *shape) {
+  collision_sweep_t sweep = {.collided = false, .time = -INFINITY,
+                             .axis = VEC_ZERO};
+  double exit = INFINITY;
+  size_t size = list_size(shape);
+  for (size_t i = 0; i < size; i++) {
+    vector_t p1 = *(vector_t *)list_get(shape, i);
+    vector_t p2 = *(vector_t *)list_get(shape, (i + 1) % size);
+    vector_t axis = find_perpline(p1, p2);
+    double start = vm_dot(origin, axis);
+    double min, max;
+    shape_interval(shape, axis, &min, &max);
+    if (!sweep_interval(axis, start, start, min, max, motion, &sweep,
+                        &exit)) {
+      return (collision_sweep_t){.collided = false, .time = 0,
+                                 .axis = VEC_ZERO};
+    }
+  }
+  return sweep_result(sweep, exit);
+}
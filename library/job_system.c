@@ -0,0 +1,413 @@
+#include "job_system.h"
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define ALLOC_SUBSYSTEM ALLOC_JOBS
+#include "alloc_track.h"
+
+#define MAX_WORKERS 64
+
+const size_t JOB_SYSTEM_ALL_CORES = SIZE_MAX;
+const size_t INITIAL_QUEUE_CAPACITY = 64;
+const size_t INITIAL_DEPENDENTS = 4;
+// job_parallel_for() splits its range into this many chunks per thread,
+// so threads that finish early can take chunks from slower ones
+const size_t CHUNKS_PER_THREAD = 4;
+
+typedef struct job {
+  job_func_t func;
+  void *aux;
+  // dependencies that have not finished, plus one while being submitted
+  atomic_size_t waiting_on;
+  atomic_bool done;
+  // one for the system until the job finishes and one for the handle
+  atomic_size_t refs;
+  // jobs waiting on this one
+  job_t **dependents;
+  size_t num_dependents;
+  size_t dependent_capacity;
+  // next job in the system's pool of unused jobs
+  job_t *next_free;
+} job_t;
+
+// a ring buffer of queued jobs: the owner takes the newest job,
+// and other threads steal the oldest
+typedef struct job_queue {
+  pthread_mutex_t lock;
+  job_t **jobs;
+  size_t oldest;
+  size_t size;
+  size_t capacity;
+} job_queue_t;
+
+typedef struct worker {
+  job_system_t *system;
+  size_t id;
+  pthread_t thread;
+} worker_t;
+
+typedef struct job_system {
+  size_t num_workers;
+  worker_t workers[MAX_WORKERS];
+  // one per worker, then one shared by every other thread
+  job_queue_t queues[MAX_WORKERS + 1];
+  // workers sleep while nothing is queued
+  pthread_mutex_t sleep_lock;
+  pthread_cond_t wake;
+  atomic_size_t queued;
+  bool stopping;
+  // submitted jobs that have not finished
+  atomic_size_t unfinished;
+  // held while a job finishes or gains a dependent
+  pthread_mutex_t dependents_lock;
+  // finished jobs are kept for reuse, so submitting does not allocate
+  pthread_mutex_t pool_lock;
+  job_t *free_jobs;
+} job_system_t;
+
+// the system the current thread is a worker of, and its queue
+_Thread_local job_system_t *current_system = NULL;
+_Thread_local size_t current_queue = 0;
+
+size_t queue_of_thread(job_system_t *system) {
+  return current_system == system ? current_queue : system->num_workers;
+}
+
+void queue_init(job_queue_t *queue) {
+  pthread_mutex_init(&queue->lock, NULL);
+  queue->jobs = malloc(INITIAL_QUEUE_CAPACITY * sizeof(job_t *));
+  assert(queue->jobs != NULL);
+  queue->oldest = 0;
+  queue->size = 0;
+  queue->capacity = INITIAL_QUEUE_CAPACITY;
+}
+
+void queue_free(job_queue_t *queue) {
+  pthread_mutex_destroy(&queue->lock);
+  free(queue->jobs);
+}
+
+void queue_push(job_queue_t *queue, job_t *job) {
+  pthread_mutex_lock(&queue->lock);
+  if (queue->size == queue->capacity) {
+    // unwrap the ring into a buffer twice the size
+    size_t capacity = queue->capacity * 2;
+    job_t **jobs = malloc(capacity * sizeof(job_t *));
+    assert(jobs != NULL);
+    for (size_t i = 0; i < queue->size; i++) {
+      jobs[i] = queue->jobs[(queue->oldest + i) % queue->capacity];
+    }
+    free(queue->jobs);
+    queue->jobs = jobs;
+    queue->oldest = 0;
+    queue->capacity = capacity;
+  }
+  queue->jobs[(queue->oldest + queue->size) % queue->capacity] = job;
+  queue->size++;
+  pthread_mutex_unlock(&queue->lock);
+}
+
+job_t *queue_take_newest(job_queue_t *queue) {
+  pthread_mutex_lock(&queue->lock);
+  job_t *job = NULL;
+  if (queue->size > 0) {
+    queue->size--;
+    job = queue->jobs[(queue->oldest + queue->size) % queue->capacity];
+  }
+  pthread_mutex_unlock(&queue->lock);
+  return job;
+}
+
+job_t *queue_take_oldest(job_queue_t *queue) {
+  pthread_mutex_lock(&queue->lock);
+  job_t *job = NULL;
+  if (queue->size > 0) {
+    job = queue->jobs[queue->oldest];
+    queue->oldest = (queue->oldest + 1) % queue->capacity;
+    queue->size--;
+  }
+  pthread_mutex_unlock(&queue->lock);
+  return job;
+}
+
+// takes a job from the thread's own queue, or steals one from another
+job_t *job_find(job_system_t *system, size_t self) {
+  if (atomic_load(&system->queued) == 0) {
+    return NULL;
+  }
+  job_t *job = queue_take_newest(&system->queues[self]);
+  size_t num_queues = system->num_workers + 1;
+  for (size_t i = 1; job == NULL && i < num_queues; i++) {
+    job = queue_take_oldest(&system->queues[(self + i) % num_queues]);
+  }
+  if (job != NULL) {
+    atomic_fetch_sub(&system->queued, 1);
+  }
+  return job;
+}
+
+void job_push(job_system_t *system, job_t *job) {
+  pthread_mutex_lock(&system->sleep_lock);
+  queue_push(&system->queues[queue_of_thread(system)], job);
+  atomic_fetch_add(&system->queued, 1);
+  pthread_cond_signal(&system->wake);
+  pthread_mutex_unlock(&system->sleep_lock);
+}
+
+job_t *job_alloc(job_system_t *system) {
+  pthread_mutex_lock(&system->pool_lock);
+  job_t *job = system->free_jobs;
+  if (job != NULL) {
+    system->free_jobs = job->next_free;
+  }
+  pthread_mutex_unlock(&system->pool_lock);
+  if (job == NULL) {
+    job = malloc(sizeof(job_t));
+    assert(job != NULL);
+    job->dependents = NULL;
+    job->dependent_capacity = 0;
+  }
+  job->num_dependents = 0;
+  return job;
+}
+
+void job_release(job_system_t *system, job_t *job) {
+  if (atomic_fetch_sub(&job->refs, 1) == 1) {
+    pthread_mutex_lock(&system->pool_lock);
+    job->next_free = system->free_jobs;
+    system->free_jobs = job;
+    pthread_mutex_unlock(&system->pool_lock);
+  }
+}
+
+void job_add_dependent(job_t *job, job_t *dependent) {
+  if (job->num_dependents == job->dependent_capacity) {
+    size_t capacity = job->dependent_capacity == 0
+                          ? INITIAL_DEPENDENTS
+                          : job->dependent_capacity * 2;
+    job_t **dependents = realloc(job->dependents, capacity * sizeof(job_t *));
+    assert(dependents != NULL);
+    job->dependents = dependents;
+    job->dependent_capacity = capacity;
+  }
+  job->dependents[job->num_dependents++] = dependent;
+}
+
+// runs a job, then queues the dependents it was the last dependency of
+void job_run(job_system_t *system, job_t *job) {
+  job->func(job->aux);
+  pthread_mutex_lock(&system->dependents_lock);
+  atomic_store(&job->done, true);
+  for (size_t i = 0; i < job->num_dependents; i++) {
+    job_t *dependent = job->dependents[i];
+    if (atomic_fetch_sub(&dependent->waiting_on, 1) == 1) {
+      job_push(system, dependent);
+    }
+  }
+  job->num_dependents = 0;
+  pthread_mutex_unlock(&system->dependents_lock);
+  atomic_fetch_sub(&system->unfinished, 1);
+  job_release(system, job);
+}
+
+void *worker_main(void *aux) {
+  worker_t *worker = aux;
+  job_system_t *system = worker->system;
+  current_system = system;
+  current_queue = worker->id;
+  pthread_mutex_lock(&system->sleep_lock);
+  pthread_mutex_unlock(&system->sleep_lock);
+  while (true) {
+    job_t *job = job_find(system, worker->id);
+    if (job != NULL) {
+      job_run(system, job);
+      continue;
+    }
+    pthread_mutex_lock(&system->sleep_lock);
+    while (atomic_load(&system->queued) == 0 && !system->stopping) {
+      pthread_cond_wait(&system->wake, &system->sleep_lock);
+    }
+    bool stop = system->stopping && atomic_load(&system->queued) == 0;
+    pthread_mutex_unlock(&system->sleep_lock);
+    if (stop) {
+      return NULL;
+    }
+  }
+}
+
+job_system_t *job_system_init(size_t num_workers) {
+  if (num_workers == JOB_SYSTEM_ALL_CORES) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    num_workers = cores > 1 ? cores - 1 : 0;
+  }
+  if (num_workers > MAX_WORKERS) {
+    num_workers = MAX_WORKERS;
+  }
+  job_system_t *system = malloc(sizeof(job_system_t));
+  assert(system != NULL);
+  pthread_mutex_init(&system->sleep_lock, NULL);
+  pthread_cond_init(&system->wake, NULL);
+  atomic_init(&system->queued, 0);
+  atomic_init(&system->unfinished, 0);
+  system->stopping = false;
+  pthread_mutex_init(&system->dependents_lock, NULL);
+  pthread_mutex_init(&system->pool_lock, NULL);
+  system->free_jobs = NULL;
+
+  // the workers wait for the lock, so they only look at the queues once
+  // it is known how many of them started
+  pthread_mutex_lock(&system->sleep_lock);
+  system->num_workers = 0;
+  for (size_t i = 0; i < num_workers; i++) {
+    worker_t *worker = &system->workers[i];
+    worker->system = system;
+    worker->id = i;
+    if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0) {
+      break;
+    }
+    system->num_workers++;
+  }
+  for (size_t i = 0; i <= system->num_workers; i++) {
+    queue_init(&system->queues[i]);
+  }
+  pthread_mutex_unlock(&system->sleep_lock);
+  return system;
+}
+
+void job_system_free(job_system_t *system) {
+  job_system_wait_idle(system);
+  pthread_mutex_lock(&system->sleep_lock);
+  system->stopping = true;
+  pthread_cond_broadcast(&system->wake);
+  pthread_mutex_unlock(&system->sleep_lock);
+  for (size_t i = 0; i < system->num_workers; i++) {
+    pthread_join(system->workers[i].thread, NULL);
+  }
+  for (size_t i = 0; i <= system->num_workers; i++) {
+    queue_free(&system->queues[i]);
+  }
+  while (system->free_jobs != NULL) {
+    job_t *job = system->free_jobs;
+    system->free_jobs = job->next_free;
+    free(job->dependents);
+    free(job);
+  }
+  pthread_mutex_destroy(&system->sleep_lock);
+  pthread_cond_destroy(&system->wake);
+  pthread_mutex_destroy(&system->dependents_lock);
+  pthread_mutex_destroy(&system->pool_lock);
+  free(system);
+}
+
+size_t job_system_num_threads(job_system_t *system) {
+  return system->num_workers + 1;
+}
+
+job_t *job_submit(job_system_t *system, job_func_t func, void *aux,
+                  job_t **dependencies, size_t num_dependencies) {
+  assert(func != NULL);
+  job_t *job = job_alloc(system);
+  job->func = func;
+  job->aux = aux;
+  atomic_init(&job->waiting_on, 1);
+  atomic_init(&job->done, false);
+  atomic_init(&job->refs, 2);
+  atomic_fetch_add(&system->unfinished, 1);
+
+  pthread_mutex_lock(&system->dependents_lock);
+  for (size_t i = 0; i < num_dependencies; i++) {
+    job_t *dependency = dependencies[i];
+    assert(dependency != NULL);
+    if (!atomic_load(&dependency->done)) {
+      job_add_dependent(dependency, job);
+      atomic_fetch_add(&job->waiting_on, 1);
+    }
+  }
+  pthread_mutex_unlock(&system->dependents_lock);
+  if (atomic_fetch_sub(&job->waiting_on, 1) == 1) {
+    job_push(system, job);
+  }
+  return job;
+}
+
+// runs one queued job if there is one, or lets other threads run
+void job_help(job_system_t *system) {
+  job_t *job = job_find(system, queue_of_thread(system));
+  if (job != NULL) {
+    job_run(system, job);
+  } else {
+    sched_yield();
+  }
+}
+
+void job_wait(job_system_t *system, job_t *job) {
+  while (!atomic_load(&job->done)) {
+    job_help(system);
+  }
+  job_release(system, job);
+}
+
+void job_system_wait_idle(job_system_t *system) {
+  while (atomic_load(&system->unfinished) > 0) {
+    job_help(system);
+  }
+}
+
+typedef struct parallel_for {
+  job_range_func_t func;
+  void *aux;
+  size_t count;
+  size_t grain;
+  // the first index not yet handed out
+  atomic_size_t next;
+} parallel_for_t;
+
+// processes chunks until every index has been handed out
+void parallel_for_chunks(void *aux) {
+  parallel_for_t *loop = aux;
+  while (true) {
+    size_t start = atomic_fetch_add(&loop->next, loop->grain);
+    if (start >= loop->count) {
+      return;
+    }
+    size_t end = loop->count - start < loop->grain ? loop->count
+                                                   : start + loop->grain;
+    loop->func(loop->aux, start, end);
+  }
+}
+
+void job_parallel_for(job_system_t *system, size_t count, size_t grain,
+                      job_range_func_t func, void *aux) {
+  assert(func != NULL);
+  if (count == 0) {
+    return;
+  }
+  size_t num_threads = job_system_num_threads(system);
+  if (grain == 0) {
+    grain = count / (num_threads * CHUNKS_PER_THREAD);
+    if (grain == 0) {
+      grain = 1;
+    }
+  }
+  parallel_for_t loop = {.func = func, .aux = aux, .count = count,
+                         .grain = grain};
+  atomic_init(&loop.next, 0);
+  size_t num_chunks = (count - 1) / grain + 1;
+  // the calling thread takes chunks too, so it needs one fewer helper
+  size_t num_helpers = num_chunks - 1 < system->num_workers
+                           ? num_chunks - 1
+                           : system->num_workers;
+  job_t *helpers[MAX_WORKERS];
+  for (size_t i = 0; i < num_helpers; i++) {
+    helpers[i] = job_submit(system, parallel_for_chunks, &loop, NULL, 0);
+  }
+  parallel_for_chunks(&loop);
+  for (size_t i = 0; i < num_helpers; i++) {
+    job_wait(system, helpers[i]);
+  }
+}
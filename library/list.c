@@ -3,6 +3,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#define ALLOC_SUBSYSTEM ALLOC_LIST
+#include "alloc_track.h"
+
 const size_t RESIZE_RATE = 2;
 
 typedef struct list {
@@ -65,6 +68,8 @@ void list_add(list_t *list, void *value) {
   list->size++;
 }
 
+void list_clear(list_t *list) { list->size = 0; }
+
 void list_resize(list_t *list) {
   size_t new_capacity;
   if (list->capacity == 0) {
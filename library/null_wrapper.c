@@ -0,0 +1,284 @@
+#include "alloc_track.h"
+#include "audio.h"
+#include "replay.h"
+#include "sdl_wrapper.h"
+#include "state.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// the headless platform steps at a steady 60 frames per second
+const double HEADLESS_DT = 1.0 / 60.0;
+// runs this many frames unless HEADLESS_FRAMES is set in the environment
+const size_t DEFAULT_HEADLESS_FRAMES = 3600;
+// headless runs without a replay always build the same levels
+const unsigned HEADLESS_SEED = 0;
+// without a replay, space is tapped this often, which leaves the title
+// pages, jumps during the levels and moves on from the pages between them
+const size_t HEADLESS_TAP_FRAMES = 90;
+// names a recording to play back instead of running HEADLESS_FRAMES frames
+const char REPLAY_ENV[] = "BEAVER_REPLAY";
+// makes the platform check that frames stop allocating once warmed up
+const char CHECK_ALLOCS_ENV[] = "BEAVER_CHECK_ALLOCS";
+// frames a scene is shown for before its physics must stop allocating
+const size_t ALLOC_WARMUP_FRAMES = 60;
+const char *PHASE_NAMES[NUM_PHASES] = {"logic", "physics", "render", "input"};
+const double SECONDS_PER_NS = 1e-9;
+const double MS_PER_S = 1e3;
+
+/**
+ * The keypress handler, or NULL if none has been configured.
+ * Keys are pressed by the recording being replayed, or by tap_space().
+ */
+key_handler_t key_handler = NULL;
+/**
+ * The number of frames shown so far and the number to stop after.
+ */
+size_t frames_shown = 0;
+size_t frame_limit = 0;
+/**
+ * The recording being played back, or NULL if there is none.
+ */
+replay_reader_t *replay = NULL;
+/**
+ * Whether the tick and key events still match the recording.
+ */
+bool in_sync = true;
+/**
+ * The phase the frame is in, when it started, and the time spent in each.
+ */
+frame_phase_t phase = PHASE_LOGIC;
+double phase_start;
+double phase_seconds[NUM_PHASES];
+double run_start;
+bool reported = false;
+/**
+ * The scene last rendered and the frames it has been shown for,
+ * and the allocations made by this frame's physics and render phases.
+ */
+scene_t *steady_scene = NULL;
+size_t steady_frames = 0;
+size_t alloc_mark = 0;
+size_t frame_allocations = 0;
+
+double now_seconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * SECONDS_PER_NS;
+}
+
+void sdl_init(vector_t min, vector_t max) {
+  // Check parameters
+  assert(min.x < max.x);
+  assert(min.y < max.y);
+
+  const char *frames = getenv("HEADLESS_FRAMES");
+  frame_limit = frames != NULL ? strtoul(frames, NULL, 10)
+                               : DEFAULT_HEADLESS_FRAMES;
+
+  const char *replay_path = getenv(REPLAY_ENV);
+  if (replay_path != NULL) {
+    replay = replay_reader_init(replay_path);
+    if (replay == NULL) {
+      fprintf(stderr, "failed to read recording %s\n", replay_path);
+      exit(1);
+    }
+  }
+  if (getenv(CHECK_ALLOCS_ENV) != NULL) {
+    alloc_track_enable();
+  }
+  run_start = now_seconds();
+  phase_start = run_start;
+}
+
+unsigned sdl_seed(void) {
+  return replay != NULL ? replay_seed(replay) : HEADLESS_SEED;
+}
+
+/**
+ * Notes the first event that does not line up with the frame it was
+ * recorded in, since everything after it plays out differently.
+ */
+void check_sync(replay_event_t event, const char *expected) {
+  if (in_sync) {
+    fprintf(stderr, "replay diverged at frame %zu: expected %s from frame %zu\n",
+            frames_shown, expected, event.frame);
+    in_sync = false;
+  }
+}
+
+/**
+ * Prints the time taken by the whole run and by each phase of the frames.
+ */
+void report_timing(void) {
+  // count the time since the phase last changed
+  sdl_begin_phase(phase);
+  double total = now_seconds() - run_start;
+  printf("%s: %zu frames in %.3f s (%.3f ms/frame)\n",
+         replay != NULL ? "replay" : "headless", frames_shown, total,
+         frames_shown > 0 ? total * MS_PER_S / frames_shown : 0.0);
+  for (frame_phase_t i = 0; i < NUM_PHASES; i++) {
+    printf("  %-8s %9.3f s %6.1f%%\n", PHASE_NAMES[i], phase_seconds[i],
+           total > 0 ? 100 * phase_seconds[i] / total : 0.0);
+  }
+  if (alloc_track_enabled()) {
+    alloc_track_print();
+  }
+  fflush(stdout);
+}
+
+bool is_finished(void) {
+  if (replay == NULL) {
+    return frames_shown >= frame_limit;
+  }
+  replay_event_t next = replay_peek(replay);
+  return next.type == REPLAY_END && next.frame <= frames_shown;
+}
+
+/**
+ * Taps space every HEADLESS_TAP_FRAMES frames, starting with the first,
+ * so runs without a replay play through the levels instead of waiting on
+ * the welcome page.
+ */
+void tap_space(state_t *state) {
+  if (key_handler == NULL || frames_shown % HEADLESS_TAP_FRAMES != 0) {
+    return;
+  }
+  frame_phase_t interrupted = phase;
+  sdl_begin_phase(PHASE_INPUT);
+  key_handler(SPACE, KEY_PRESSED, 0, state);
+  key_handler(SPACE, KEY_RELEASED, 0, state);
+  sdl_begin_phase(interrupted);
+}
+
+bool sdl_is_done(state_t *state) {
+  if (is_finished()) {
+    if (!reported) {
+      report_timing();
+      reported = true;
+      if (replay != NULL) {
+        replay_reader_free(replay);
+        replay = NULL;
+        // the run has ended, so stop on the frame it ended in
+        frame_limit = frames_shown;
+      }
+    }
+    return true;
+  }
+  if (replay == NULL) {
+    tap_space(state);
+    return false;
+  }
+
+  frame_phase_t interrupted = phase;
+  sdl_begin_phase(PHASE_INPUT);
+  while (true) {
+    replay_event_t next = replay_peek(replay);
+    if (next.type == REPLAY_KEY && next.frame <= frames_shown) {
+      replay_next(replay);
+      if (next.frame < frames_shown) {
+        check_sync(next, "a key");
+      }
+      if (key_handler != NULL) {
+        key_handler(next.key, next.key_type, next.held_time, state);
+      }
+    } else if (next.type == REPLAY_TICK && next.frame < frames_shown) {
+      // the game skipped a tick it took when recording
+      replay_next(replay);
+      check_sync(next, "a tick");
+    } else {
+      break;
+    }
+  }
+  sdl_begin_phase(interrupted);
+  return false;
+}
+
+void sdl_clear(void) {}
+
+void sdl_draw_polygon(list_t *points, rgb_color_t color) {}
+
+/**
+ * Fails if a scene that has been shown for ALLOC_WARMUP_FRAMES frames
+ * allocated during this frame's physics or render phase.
+ */
+void check_frame_allocations(void) {
+  if (steady_frames >= ALLOC_WARMUP_FRAMES && frame_allocations > 0) {
+    fprintf(stderr, "frame %zu allocated %zu times outside the logic phase\n",
+            frames_shown, frame_allocations);
+    alloc_track_print();
+    assert(frame_allocations == 0);
+  }
+  frame_allocations = 0;
+  steady_frames++;
+}
+
+void sdl_show(void) {
+  sdl_begin_phase(PHASE_LOGIC);
+  if (alloc_track_enabled()) {
+    check_frame_allocations();
+  }
+  frames_shown++;
+}
+
+void sdl_render_scene(scene_t *scene) {
+  if (scene != steady_scene) {
+    steady_scene = scene;
+    steady_frames = 0;
+  }
+}
+
+void sdl_on_key(key_handler_t handler) { key_handler = handler; }
+
+double time_since_last_tick(void) {
+  if (replay == NULL) {
+    return HEADLESS_DT;
+  }
+  replay_event_t next = replay_peek(replay);
+  while (next.type == REPLAY_TICK && next.frame < frames_shown) {
+    // the game skipped a tick it took when recording
+    replay_next(replay);
+    check_sync(next, "a tick");
+    next = replay_peek(replay);
+  }
+  if (next.type != REPLAY_TICK || next.frame != frames_shown) {
+    // the game ticked where it did not when recording
+    check_sync(next, "no tick");
+    return HEADLESS_DT;
+  }
+  replay_next(replay);
+  return next.dt;
+}
+
+void sdl_begin_phase(frame_phase_t next_phase) {
+  double now = now_seconds();
+  phase_seconds[phase] += now - phase_start;
+  if (alloc_track_enabled()) {
+    size_t total = alloc_track_total();
+    if (phase == PHASE_PHYSICS || phase == PHASE_RENDER) {
+      frame_allocations += total - alloc_mark;
+    }
+    alloc_mark = total;
+  }
+  phase = next_phase;
+  phase_start = now;
+}
+
+// there is no audio device headless, so audio is silently skipped
+
+void audio_init(void) {}
+
+void audio_free(void) {}
+
+void audio_play_music(void) {}
+
+void audio_stop_music(void) {}
+
+void audio_fade_in_music(int ms) {}
+
+void audio_fade_out_music(int ms) {}
+
+bool audio_music_playing(void) { return false; }
+
+void audio_play_sound(sound_t sound) {}
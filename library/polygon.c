@@ -1,5 +1,6 @@
 #include "polygon.h"
 #include "list.h"
+#include "vector_math.h"
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
@@ -12,7 +13,7 @@ double polygon_area(list_t *polygon) {
   for (size_t i = 0; i < num; i++) {
     vector_t p1 = *(vector_t *)list_get(polygon, i % num);
     vector_t p2 = *(vector_t *)list_get(polygon, (i + 1) % num);
-    area += (1.0 / 2.0) * vec_cross(p1, p2);
+    area += (1.0 / 2.0) * vm_cross(p1, p2);
   }
   return fabs(area);
 }
@@ -26,10 +27,10 @@ vector_t polygon_centroid(list_t *polygon) {
   for (size_t i = 0; i < num; i++) {
     vector_t p1 = *(vector_t *)list_get(polygon, i);
     vector_t p2 = *(vector_t *)list_get(polygon, (i + 1) % num);
-    toreturn.x += (p1.x + p2.x) * (vec_cross(p1, p2));
-    toreturn.y += (p1.y + p2.y) * (vec_cross(p1, p2));
+    toreturn.x += (p1.x + p2.x) * (vm_cross(p1, p2));
+    toreturn.y += (p1.y + p2.y) * (vm_cross(p1, p2));
   }
-  toreturn = vec_multiply(1 / (6.0 * A), toreturn);
+  toreturn = vm_multiply(1 / (6.0 * A), toreturn);
   return toreturn;
 }
 
@@ -37,13 +38,13 @@ void polygon_translate(list_t *polygon, vector_t translation) {
   size_t num = list_size(polygon);
   for (size_t i = 0; i < num; i++) {
     vector_t *p = list_get(polygon, i);
-    *p = vec_add(*p, translation);
+    *p = vm_add(*p, translation);
   }
 }
 
 void polygon_rotate(list_t *polygon, double angle, vector_t point) {
   // translate the polygon so that it rotates around the origin
-  vector_t neg_point = vec_multiply(-1, point);
+  vector_t neg_point = vm_negate(point);
   polygon_translate(polygon, neg_point);
 
   // then rotate every vector
@@ -56,3 +57,37 @@ void polygon_rotate(list_t *polygon, double angle, vector_t point) {
   // then translate the polygon back so that it rotates around the given point
   polygon_translate(polygon, point);
 }
+
+aabb_t polygon_bounds(list_t *polygon) {
+  size_t num = list_size(polygon);
+  assert(num > 0);
+  vector_t first = *(vector_t *)list_get(polygon, 0);
+  aabb_t box = {.min = first, .max = first};
+  for (size_t i = 1; i < num; i++) {
+    vector_t p = *(vector_t *)list_get(polygon, i);
+    box.min.x = fmin(box.min.x, p.x);
+    box.min.y = fmin(box.min.y, p.y);
+    box.max.x = fmax(box.max.x, p.x);
+    box.max.y = fmax(box.max.y, p.y);
+  }
+  return box;
+}
+
+bool aabb_overlap(aabb_t box1, aabb_t box2) {
+  return box1.min.x <= box2.max.x && box2.min.x <= box1.max.x &&
+         box1.min.y <= box2.max.y && box2.min.y <= box1.max.y;
+}
+
+aabb_t aabb_translate(aabb_t box, vector_t translation) {
+  box.min = vm_add(box.min, translation);
+  box.max = vm_add(box.max, translation);
+  return box;
+}
+
+aabb_t aabb_sweep(aabb_t box, vector_t motion) {
+  aabb_t moved = aabb_translate(box, motion);
+  return (aabb_t){.min = {fmin(box.min.x, moved.min.x),
+                          fmin(box.min.y, moved.min.y)},
+                  .max = {fmax(box.max.x, moved.max.x),
+                          fmax(box.max.y, moved.max.y)}};
+}
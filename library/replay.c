@@ -0,0 +1,219 @@
+#include "replay.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char REPLAY_MAGIC[4] = {'B', 'R', 'R', 'P'};
+const uint8_t REPLAY_VERSION = 1;
+// magic, version, seed
+const size_t REPLAY_HEADER_SIZE = 9;
+// the low 7 bits of each varint byte hold data; the high bit means "more"
+const uint8_t VARINT_MORE = 0x80;
+const size_t VARINT_BITS = 7;
+const size_t MAX_VARINT_SIZE = 10;
+const size_t DOUBLE_SIZE = 8;
+
+typedef struct replay_writer {
+  FILE *file;
+  size_t last_frame;
+} replay_writer_t;
+
+typedef struct replay_reader {
+  uint8_t *data;
+  size_t size;
+  size_t offset;
+  unsigned seed;
+  replay_event_t next;
+} replay_reader_t;
+
+void write_varint(FILE *file, uint64_t value) {
+  uint8_t bytes[MAX_VARINT_SIZE];
+  size_t size = 0;
+  do {
+    bytes[size] = value & ~VARINT_MORE;
+    value >>= VARINT_BITS;
+    if (value != 0) {
+      bytes[size] |= VARINT_MORE;
+    }
+    size++;
+  } while (value != 0);
+  fwrite(bytes, 1, size, file);
+}
+
+/** Doubles are stored bit for bit, so replayed time steps are exact */
+void write_double(FILE *file, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  uint8_t bytes[DOUBLE_SIZE];
+  for (size_t i = 0; i < DOUBLE_SIZE; i++) {
+    bytes[i] = bits >> (8 * i);
+  }
+  fwrite(bytes, 1, DOUBLE_SIZE, file);
+}
+
+/** Each record starts with its type and the frames since the last record */
+void write_record_start(replay_writer_t *writer, replay_event_type_t type,
+                        size_t frame) {
+  assert(frame >= writer->last_frame);
+  fputc(type, writer->file);
+  write_varint(writer->file, frame - writer->last_frame);
+  writer->last_frame = frame;
+}
+
+replay_writer_t *replay_writer_init(const char *path, unsigned seed) {
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    return NULL;
+  }
+  replay_writer_t *writer = malloc(sizeof(replay_writer_t));
+  assert(writer != NULL);
+  writer->file = file;
+  writer->last_frame = 0;
+
+  fwrite(REPLAY_MAGIC, 1, sizeof(REPLAY_MAGIC), file);
+  fputc(REPLAY_VERSION, file);
+  uint32_t seed_bits = seed;
+  for (size_t i = 0; i < sizeof(seed_bits); i++) {
+    fputc((seed_bits >> (8 * i)) & 0xff, file);
+  }
+  return writer;
+}
+
+void replay_write_key(replay_writer_t *writer, size_t frame, char key,
+                      int key_type, double held_time) {
+  write_record_start(writer, REPLAY_KEY, frame);
+  fputc((uint8_t)key, writer->file);
+  fputc(key_type, writer->file);
+  write_double(writer->file, held_time);
+}
+
+void replay_write_tick(replay_writer_t *writer, size_t frame, double dt) {
+  write_record_start(writer, REPLAY_TICK, frame);
+  write_double(writer->file, dt);
+}
+
+void replay_writer_free(replay_writer_t *writer, size_t frame) {
+  write_record_start(writer, REPLAY_END, frame);
+  fclose(writer->file);
+  free(writer);
+}
+
+bool read_varint(replay_reader_t *reader, uint64_t *value) {
+  *value = 0;
+  for (size_t i = 0; i < MAX_VARINT_SIZE; i++) {
+    if (reader->offset == reader->size) {
+      return false;
+    }
+    uint8_t byte = reader->data[reader->offset++];
+    *value |= (uint64_t)(byte & ~VARINT_MORE) << (VARINT_BITS * i);
+    if (!(byte & VARINT_MORE)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool read_double(replay_reader_t *reader, double *value) {
+  if (reader->size - reader->offset < DOUBLE_SIZE) {
+    return false;
+  }
+  uint64_t bits = 0;
+  for (size_t i = 0; i < DOUBLE_SIZE; i++) {
+    bits |= (uint64_t)reader->data[reader->offset++] << (8 * i);
+  }
+  memcpy(value, &bits, sizeof(bits));
+  return true;
+}
+
+/**
+ * Decodes the record at the reader's offset into reader->next.
+ * A truncated or unknown record ends the recording at the last frame read.
+ */
+void read_record(replay_reader_t *reader) {
+  replay_event_t *event = &reader->next;
+  uint64_t frames;
+  bool valid = reader->offset < reader->size;
+  if (valid) {
+    event->type = reader->data[reader->offset++];
+    valid = read_varint(reader, &frames);
+  }
+  if (valid) {
+    switch (event->type) {
+    case REPLAY_KEY:
+      valid = reader->size - reader->offset >= 2;
+      if (valid) {
+        event->key = (char)reader->data[reader->offset++];
+        event->key_type = reader->data[reader->offset++];
+        valid = read_double(reader, &event->held_time);
+      }
+      break;
+    case REPLAY_TICK:
+      valid = read_double(reader, &event->dt);
+      break;
+    case REPLAY_END:
+      break;
+    default:
+      valid = false;
+    }
+  }
+  if (valid) {
+    event->frame += frames;
+  } else {
+    event->type = REPLAY_END;
+  }
+}
+
+replay_reader_t *replay_reader_init(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  if (size < (long)REPLAY_HEADER_SIZE) {
+    fclose(file);
+    return NULL;
+  }
+  uint8_t *data = malloc(size);
+  assert(data != NULL);
+  bool read = fread(data, 1, size, file) == (size_t)size;
+  fclose(file);
+  if (!read || memcmp(data, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0 ||
+      data[sizeof(REPLAY_MAGIC)] != REPLAY_VERSION) {
+    free(data);
+    return NULL;
+  }
+
+  replay_reader_t *reader = malloc(sizeof(replay_reader_t));
+  assert(reader != NULL);
+  reader->data = data;
+  reader->size = size;
+  reader->seed = 0;
+  for (size_t i = 0; i < sizeof(uint32_t); i++) {
+    reader->seed |= (unsigned)data[sizeof(REPLAY_MAGIC) + 1 + i] << (8 * i);
+  }
+  reader->offset = REPLAY_HEADER_SIZE;
+  reader->next = (replay_event_t){.frame = 0};
+  read_record(reader);
+  return reader;
+}
+
+void replay_reader_free(replay_reader_t *reader) {
+  free(reader->data);
+  free(reader);
+}
+
+unsigned replay_seed(replay_reader_t *reader) { return reader->seed; }
+
+replay_event_t replay_peek(replay_reader_t *reader) { return reader->next; }
+
+replay_event_t replay_next(replay_reader_t *reader) {
+  replay_event_t event = reader->next;
+  if (event.type != REPLAY_END) {
+    read_record(reader);
+  }
+  return event;
+}
@@ -1,17 +1,143 @@
 #include "scene.h"
 #include "body.h"
 #include "list.h"
+#include "polygon.h"
+#include "spatial_index.h"
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <SDL2/SDL.h>
-// #include <SDL2/SDL_ttf.h>
 
+#define ALLOC_SUBSYSTEM ALLOC_SCENE
+#include "alloc_track.h"
 
 const size_t initial_num_bodies = 50;
 const size_t initial_num_forces = 10;
+// roughly the size of the larger sprites, so most bodies cover 1-4 cells
+const double INDEX_CELL_SIZE = 128.0;
+// parallel force creators are run in chunks of this many, each chunk
+// recording into its own force log; the chunks do not depend on the number
+// of threads, so neither does the order forces are added in
+const size_t FORCE_CHUNK_SIZE = 64;
+// shorter runs of parallel force creators are cheaper to run serially
+const size_t MIN_PARALLEL_FORCE_CREATORS = 256;
+// must be powers of 2 so the hashes can be masked instead of divided
+const size_t INITIAL_EVENT_SLOTS = 64;
+const size_t INITIAL_CONTACT_SLOTS = 64;
+// how far a swept body is left overlapping what it hit, so the next tick's
+// collision test finds the overlap along the axis it hit on
+const double CCD_SKIN = 1e-3;
+// scenes rarely have more than a few fast bodies
+const size_t INITIAL_CCD_STOPS = 4;
+// sequential impulses converge quickly once warm started
+const size_t SOLVER_ITERATIONS = 8;
+// the share of a solid contact's overlap undone each tick, and the overlap
+// left alone so resting bodies do not jitter
+const double SOLVER_BAUMGARTE = 0.2;
+const double SOLVER_SLOP = 0.01;
+// slower collisions do not bounce, so resting bodies stay at rest
+const double RESTITUTION_THRESHOLD = 1.0;
+// a contact held to an axis is not solved while the bodies touch on an axis
+// further than 60 degrees from it, e.g. a floor hitting a body side-on
+const double AXIS_CONTACT_MIN_COSINE = 0.5;
+
+// an entry in the table used to find duplicate collision events
+typedef struct event_slot {
+  size_t event;
+  size_t tick;
+} event_slot_t;
+
+// an ordered pair of bodies that some contact watches
+typedef struct contact_pair {
+  body_t *body1;
+  body_t *body2;
+  // whether the bodies touch in this tick
+  bool touching;
+  // the axis and depth from the last tick they touched in
+  vector_t axis;
+  double depth;
+  // the index of this tick's test in the scene's pair results,
+  // or SIZE_MAX if the bodies' bounds do not overlap
+  size_t result;
+  // whether the category contacts that apply have been added
+  bool discovered;
+  // the number of contacts that will be kept, while pruning
+  size_t num_kept;
+} contact_pair_t;
+
+// a contact added with scene_add_contact()
+typedef struct contact {
+  size_t pair;
+  contact_handlers_t handlers;
+  void *aux;
+  free_func_t freer;
+  // whether the bodies touched when the handlers were last queued
+  bool touching;
+  // added for a category contact, which owns the aux
+  bool discovered;
+  // kept apart by the contact solver, with this coefficient of restitution
+  bool solid;
+  double elasticity;
+  // if non-zero, the only direction the solver pushes the bodies in
+  vector_t axis;
+  // the impulse the solver applied to body2 along the axis last tick
+  double impulse;
+} contact_t;
+
+// a contact added with scene_add_category_contact()
+typedef struct category_contact {
+  uint32_t category1;
+  uint32_t category2;
+  contact_handlers_t handlers;
+  void *aux;
+  free_func_t freer;
+  bool solid;
+  double elasticity;
+  vector_t axis;
+} category_contact_t;
+
+// a force field and the bodies added to it
+typedef struct stored_field {
+  force_field_t field;
+  body_t **bodies;
+  size_t num_bodies;
+  size_t body_capacity;
+} stored_field_t;
+
+// a touching solid contact, as the solver sees it
+typedef struct solver_row {
+  contact_t *contact;
+  body_t *body1;
+  body_t *body2;
+  // points from body1 towards body2
+  vector_t normal;
+  double inverse_mass1;
+  double inverse_mass2;
+  // the speed along the normal the bodies should separate at
+  double target;
+} solver_row_t;
+
+// where a fast body is stopped at the end of the tick
+typedef struct ccd_stop {
+  body_t *body;
+  vector_t centroid;
+} ccd_stop_t;
+
+// a body's state at the start of a step, for the integrators that
+// evaluate the forces more than once per step
+typedef struct stage_state {
+  // where the body starts, and its velocity once the impulses are applied
+  vector_t centroid;
+  vector_t velocity;
+  // the body's velocity and acceleration at the latest stage
+  vector_t stage_velocity;
+  vector_t stage_acceleration;
+  // the weighted sums of every stage's velocity and acceleration so far
+  vector_t velocity_sum;
+  vector_t acceleration_sum;
+} stage_state_t;
 
 // stores information for creating forces between bodies
 typedef struct store_force_creator {
@@ -19,6 +145,15 @@ typedef struct store_force_creator {
   void *aux;
   free_func_t freer;
   list_t *bodies;
+  bool parallel;
+  // set for collision testers, which are called instead of forcer
+  collision_tester_t tester;
+  body_t *body1;
+  body_t *body2;
+  // whether the tester's bodies were looked up this tick, and the index of
+  // their test result, or SIZE_MAX if their bounds do not overlap
+  bool tested;
+  size_t result;
 } store_force_creator_t;
 
 
@@ -26,105 +161,69 @@ typedef struct scene {
   list_t *bodies;
   list_t *force_creators;
   double score;
-  // stores all surfaces needed in game
-  list_t *loaded_surfaces;
-  // stores all fonts needed in game
-  list_t *fonts;
-  // stores index in fonts of text needed for specific scene
+  // stores index of the platform's HUD texts shown in this scene
   list_t *font_indexs;
   bool slow_speed;
   bool have_double_points;
   double total_points;
+  // bounds of every body, brought up to date lazily when a query follows
+  // a change: rebuilt once bodies are added or removed, and updated in
+  // place once they may have moved
+  spatial_index_t *index;
+  bool index_dirty;
+  bool index_moved;
+  list_t *query_results;
+  // the bodies of query_results that pass a finer test
+  list_t *filter_results;
+  // runs parallel force creators, if set; each chunk has a force log
+  job_system_t *jobs;
+  list_t *force_logs;
+  // collisions queued this tick, and a hash table of them by pair and
+  // handler; a slot is only in use when its tick matches the current one
+  collision_event_t *events;
+  size_t num_events;
+  size_t event_capacity;
+  event_slot_t *event_slots;
+  size_t num_event_slots;
+  size_t event_tick;
+  // the shapes of the collision testers' bodies and of the contact pairs
+  // whose bounds overlap, packed for find_collisions(), and their results
+  collision_pair_t *pairs;
+  collision_info_t *pair_results;
+  size_t pair_capacity;
+  // the pairs watched by contacts, and a hash table of their indices + 1,
+  // where 0 marks an empty slot
+  contact_pair_t *contact_pairs;
+  size_t num_contact_pairs;
+  size_t contact_pair_capacity;
+  size_t *contact_slots;
+  size_t num_contact_slots;
+  // contacts, in the order they were added
+  contact_t *contacts;
+  size_t num_contacts;
+  size_t contact_capacity;
+  // category contacts, and every category1 they have
+  category_contact_t *category_contacts;
+  size_t num_category_contacts;
+  size_t category_contact_capacity;
+  uint32_t contact_categories;
+  stored_field_t *fields;
+  size_t num_fields;
+  size_t field_capacity;
+  // the solid contacts being solved this tick
+  solver_row_t *solver_rows;
+  size_t solver_row_capacity;
+  // fast bodies that hit something this tick
+  ccd_stop_t *ccd_stops;
+  size_t num_ccd_stops;
+  size_t ccd_stop_capacity;
+  integrator_t integrator;
+  size_t substeps;
+  // one per body, in scene order
+  stage_state_t *stages;
+  size_t stage_capacity;
 } scene_t;
 
-// stores information for kind of text needed for each scene
-typedef struct text {
-  size_t width;
-  size_t length;
-  vector_t center;
-  void* font;
-  SDL_Color color;
-} text_t;
-
-// initializes text struct with the font, size, and position
-text_t *text_init (size_t length, size_t width, vector_t center, void* font, SDL_Color color)
-{
-  text_t* text = malloc(sizeof(text_t));
-  text->length = length;
-  text->width = width;
-  text->center = center;
-  text->font = font;
-  text->color = color;
-  return text;
-}
-
-// frees stext
-void free_text(text_t *text)
-{
-  free(text->font);
-  free(text);
-}
-
-// returns width of container for text
-size_t text_get_width(text_t *text)
-{
-  return text->width;
-}
-
-// returns length of container for text
-size_t text_get_length(text_t *text)
-{
-  return text->length;
-}
-
-// returns positino for text
-vector_t text_get_center(text_t *text)
-{
-  return text->center;
-}
-
-// returns font type for text
-void* text_get_font(text_t *text)
-{
-  return text->font;
-}
-
-// returns color of text
-SDL_Color text_get_color(text_t *text)
-{
-  return text->color;
-}
-
-// sets container width for text
-void text_set_width(text_t *text, size_t width)
-{
-  text->width = width;
-}
-
-// sets container length for text
-void text_set_length(text_t *text, size_t length)
-{
-  text->length = length;
-}
-
-// sets text position on scene
-void text_set_center(text_t *text, vector_t center)
-{
-  text->center = center;
-}
-
-// sets text font 
-void text_set_font(text_t *text, void* font)
-{
-  text->font = font;
-}
-
-// sets text color
-void text_set_color(text_t *text, SDL_Color color)
-{
-  text->color = color;
-}
-
 void list_freer(void *ptr) { list_free((list_t *)ptr); }
 
 // frees forces struct
@@ -147,16 +246,121 @@ scene_t *scene_init(void) {
   scene->bodies = list_init(initial_num_bodies, (free_func_t)body_free);
   scene->force_creators = list_init(initial_num_forces, (free_func_t)force_creator_freer);
   scene->score = 0.0;
+  scene->font_indexs = NULL;
+  scene->slow_speed = false;
+  scene->have_double_points = false;
+  scene->index = spatial_index_init(INDEX_CELL_SIZE);
+  scene->index_dirty = true;
+  scene->index_moved = false;
+  scene->query_results = list_init(initial_num_bodies, NULL);
+  scene->filter_results = list_init(initial_num_bodies, NULL);
+  scene->jobs = NULL;
+  scene->force_logs = list_init(1, (free_func_t)force_log_free);
+  // the table is kept at least twice as big as the queue
+  scene->event_capacity = INITIAL_EVENT_SLOTS / 2;
+  scene->events = malloc(scene->event_capacity * sizeof(collision_event_t));
+  assert(scene->events != NULL);
+  scene->num_events = 0;
+  scene->event_slots = calloc(INITIAL_EVENT_SLOTS, sizeof(event_slot_t));
+  assert(scene->event_slots != NULL);
+  scene->num_event_slots = INITIAL_EVENT_SLOTS;
+  scene->event_tick = 1;
+  // the tests and contacts are sized up front, like the tables that find
+  // them, so a scene only allocates in a tick once it has more of them
+  // than ever before
+  scene->pair_capacity = initial_num_bodies;
+  scene->pairs = malloc(scene->pair_capacity * sizeof(collision_pair_t));
+  scene->pair_results =
+      malloc(scene->pair_capacity * sizeof(collision_info_t));
+  assert(scene->pairs != NULL && scene->pair_results != NULL);
+  scene->contact_pair_capacity = INITIAL_CONTACT_SLOTS / 2;
+  scene->contact_pairs =
+      malloc(scene->contact_pair_capacity * sizeof(contact_pair_t));
+  assert(scene->contact_pairs != NULL);
+  scene->num_contact_pairs = 0;
+  scene->contact_slots = calloc(INITIAL_CONTACT_SLOTS, sizeof(size_t));
+  assert(scene->contact_slots != NULL);
+  scene->num_contact_slots = INITIAL_CONTACT_SLOTS;
+  scene->contact_capacity = INITIAL_CONTACT_SLOTS;
+  scene->contacts = malloc(scene->contact_capacity * sizeof(contact_t));
+  assert(scene->contacts != NULL);
+  scene->num_contacts = 0;
+  scene->category_contacts = NULL;
+  scene->num_category_contacts = 0;
+  scene->category_contact_capacity = 0;
+  scene->contact_categories = 0;
+  scene->fields = NULL;
+  scene->num_fields = 0;
+  scene->field_capacity = 0;
+  scene->solver_row_capacity = scene->contact_capacity;
+  scene->solver_rows =
+      malloc(scene->solver_row_capacity * sizeof(solver_row_t));
+  assert(scene->solver_rows != NULL);
+  scene->ccd_stops = malloc(INITIAL_CCD_STOPS * sizeof(ccd_stop_t));
+  assert(scene->ccd_stops != NULL);
+  scene->num_ccd_stops = 0;
+  scene->ccd_stop_capacity = INITIAL_CCD_STOPS;
+  scene->integrator = INTEGRATOR_AVERAGE_VELOCITY;
+  scene->substeps = 1;
+  scene->stages = NULL;
+  scene->stage_capacity = 0;
   return scene;
 }
 
+// frees the contacts' aux values and forgets every contact
+void scene_clear_contacts(scene_t *scene) {
+  for (size_t i = 0; i < scene->num_contacts; i++) {
+    contact_t *contact = &scene->contacts[i];
+    if (contact->freer != NULL) {
+      contact->freer(contact->aux);
+    }
+  }
+  for (size_t i = 0; i < scene->num_category_contacts; i++) {
+    category_contact_t *contact = &scene->category_contacts[i];
+    if (contact->freer != NULL) {
+      contact->freer(contact->aux);
+    }
+  }
+  scene->num_contacts = 0;
+  scene->num_category_contacts = 0;
+  scene->contact_categories = 0;
+  scene->num_contact_pairs = 0;
+  for (size_t i = 0; i < scene->num_contact_slots; i++) {
+    scene->contact_slots[i] = 0;
+  }
+}
+
+// forgets every force field
+void scene_clear_fields(scene_t *scene) {
+  for (size_t i = 0; i < scene->num_fields; i++) {
+    free(scene->fields[i].bodies);
+  }
+  scene->num_fields = 0;
+}
+
 // frees variables in scene
 void scene_free(scene_t *scene) {
+  scene_clear_contacts(scene);
+  scene_clear_fields(scene);
   list_free(scene->force_creators);
   list_free(scene->bodies);
-  list_free(scene->loaded_surfaces);
-  list_free(scene->fonts);
   list_free(scene->font_indexs);
+  spatial_index_free(scene->index);
+  list_free(scene->query_results);
+  list_free(scene->filter_results);
+  list_free(scene->force_logs);
+  free(scene->events);
+  free(scene->event_slots);
+  free(scene->pairs);
+  free(scene->pair_results);
+  free(scene->contact_pairs);
+  free(scene->contact_slots);
+  free(scene->contacts);
+  free(scene->category_contacts);
+  free(scene->fields);
+  free(scene->solver_rows);
+  free(scene->ccd_stops);
+  free(scene->stages);
   free(scene);
 }
 
@@ -169,6 +373,8 @@ void scene_reset(scene_t *scene)
     list_free(scene->force_creators);
     scene->force_creators = list_init(initial_num_forces, (free_func_t)force_creator_freer);
   }
+  scene_clear_contacts(scene);
+  scene_clear_fields(scene);
 
   // frees all body in scenes apart from welcome page and gameplay page
   if (scene_bodies(scene) > 1)
@@ -176,6 +382,7 @@ void scene_reset(scene_t *scene)
     list_free(scene->bodies);
     scene->bodies = list_init(initial_num_bodies, (free_func_t)body_free);
   }
+  scene->index_dirty = true;
 
   // reset scene score
   scene->score = 0.0;
@@ -190,36 +397,12 @@ body_t *scene_get_body(scene_t *scene, size_t index) {
   return list_get(scene->bodies, index);
 }
 
-// sets scene surface
-void scene_set_surfaces(scene_t *scene, list_t *loaded_surfaces)
-{
-  scene->loaded_surfaces = loaded_surfaces;
-}
-
-// returns scene surface
-list_t *scene_get_surfaces(scene_t *scene)
-{
-  return scene->loaded_surfaces;
-}
-
-// returns scene fonts
-list_t *scene_get_fonts(scene_t *scene)
-{
-  return scene->fonts;
-}
-
 // return indexes of fonts needed in scene
 list_t *scene_get_font_indexs(scene_t *scene)
 {
   return scene->font_indexs;
 }
 
-// set scene fonts
-void scene_set_fonts(scene_t *scene, list_t *fonts)
-{
-  scene->fonts = fonts;
-}
-
 // set scene font indexes
 void scene_set_font_indexs(scene_t *scene, list_t *font_indexs)
 {
@@ -229,6 +412,113 @@ void scene_set_font_indexs(scene_t *scene, list_t *font_indexs)
 // adds a body to scene body list 
 void scene_add_body(scene_t *scene, body_t *body) {
   list_add(scene->bodies, body);
+  scene->index_dirty = true;
+}
+
+// reinserts every body's bounds into the spatial index
+void scene_rebuild_index(scene_t *scene) {
+  spatial_index_clear(scene->index);
+  // room for every body, so no later query has to grow the results
+  while (list_capacity(scene->query_results) < scene_bodies(scene)) {
+    list_resize(scene->query_results);
+  }
+  while (list_capacity(scene->filter_results) < scene_bodies(scene)) {
+    list_resize(scene->filter_results);
+  }
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    spatial_index_insert(scene->index, body, body_get_bounds(body));
+  }
+  scene->index_dirty = false;
+  scene->index_moved = false;
+}
+
+// brings the spatial index up to date before a query; only the bodies
+// whose bounds changed touch the index when none were added or removed
+void scene_update_index(scene_t *scene) {
+  if (scene->index_dirty) {
+    scene_rebuild_index(scene);
+    return;
+  }
+  if (scene->index_moved) {
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+      spatial_index_update(scene->index, i,
+                           body_get_bounds(scene_get_body(scene, i)));
+    }
+    scene->index_moved = false;
+  }
+}
+
+list_t *scene_bodies_in_bounds(scene_t *scene, aabb_t bounds) {
+  scene_update_index(scene);
+  list_clear(scene->query_results);
+  spatial_index_query(scene->index, bounds, scene->query_results);
+  return scene->query_results;
+}
+
+list_t *scene_bodies_in_radius(scene_t *scene, vector_t center, double radius) {
+  vector_t corner = {radius, radius};
+  list_t *nearby = scene_bodies_in_bounds(
+      scene, (aabb_t){.min = vec_subtract(center, corner),
+                      .max = vec_add(center, corner)});
+  list_clear(scene->filter_results);
+  for (size_t i = 0; i < list_size(nearby); i++) {
+    body_t *body = list_get(nearby, i);
+    vector_t offset = vec_subtract(body_get_centroid(body), center);
+    if (vec_dot(offset, offset) <= radius * radius) {
+      list_add(scene->filter_results, body);
+    }
+  }
+  return scene->filter_results;
+}
+
+list_t *scene_query_aabb(scene_t *scene, aabb_t bounds, uint32_t categories) {
+  list_t *nearby = scene_bodies_in_bounds(scene, bounds);
+  list_clear(scene->filter_results);
+  for (size_t i = 0; i < list_size(nearby); i++) {
+    body_t *body = list_get(nearby, i);
+    if (!body_is_removed(body) && (body_get_category(body) & categories) != 0) {
+      list_add(scene->filter_results, body);
+    }
+  }
+  return scene->filter_results;
+}
+
+// keeps the earlier of a hit and the sweep of a motion against a body
+void hit_keep_first(scene_hit_t *hit, body_t *body, collision_sweep_t sweep) {
+  if (sweep.collided && sweep.time < hit->time) {
+    *hit = (scene_hit_t){.body = body,
+                         .time = sweep.time,
+                         .normal = vec_negate(sweep.axis)};
+  }
+}
+
+scene_hit_t scene_raycast(scene_t *scene, vector_t origin, vector_t motion,
+                          uint32_t categories) {
+  scene_hit_t hit = {.body = NULL, .time = 1, .normal = VEC_ZERO};
+  aabb_t start = {.min = origin, .max = origin};
+  list_t *nearby = scene_query_aabb(scene, aabb_sweep(start, motion),
+                                    categories);
+  for (size_t i = 0; i < list_size(nearby); i++) {
+    body_t *body = list_get(nearby, i);
+    hit_keep_first(&hit, body,
+                   find_ray_impact(origin, motion, body_borrow_shape(body)));
+  }
+  return hit;
+}
+
+scene_hit_t scene_shapecast(scene_t *scene, list_t *shape, vector_t motion,
+                            uint32_t categories) {
+  scene_hit_t hit = {.body = NULL, .time = 1, .normal = VEC_ZERO};
+  list_t *nearby = scene_query_aabb(
+      scene, aabb_sweep(polygon_bounds(shape), motion), categories);
+  for (size_t i = 0; i < list_size(nearby); i++) {
+    body_t *body = list_get(nearby, i);
+    hit_keep_first(&hit, body,
+                   find_time_of_impact(shape, motion, body_borrow_shape(body),
+                                       VEC_ZERO));
+  }
+  return hit;
 }
 
 double scene_get_score(scene_t *scene){
@@ -262,6 +552,12 @@ store_force_creator_t *force_creator_init(force_creator_t forcer, void *aux,
   fc->aux = aux;
   fc->freer = freer;
   fc->bodies = bodies;
+  fc->parallel = false;
+  fc->tester = NULL;
+  fc->body1 = NULL;
+  fc->body2 = NULL;
+  fc->tested = false;
+  fc->result = SIZE_MAX;
   return fc;
 }
 
@@ -275,6 +571,150 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
   list_add(scene->force_creators, fc);
 }
 
+void scene_add_parallel_force_creator(scene_t *scene, force_creator_t forcer,
+                                      void *aux, list_t *bodies,
+                                      free_func_t freer) {
+  store_force_creator_t *fc = force_creator_init(forcer, aux, bodies, freer);
+  fc->parallel = true;
+  list_add(scene->force_creators, fc);
+}
+
+void scene_add_collision_tester(scene_t *scene, body_t *body1, body_t *body2,
+                                collision_tester_t tester, void *aux,
+                                list_t *bodies, free_func_t freer) {
+  assert(tester != NULL);
+  store_force_creator_t *fc = force_creator_init(NULL, aux, bodies, freer);
+  fc->tester = tester;
+  fc->body1 = body1;
+  fc->body2 = body2;
+  list_add(scene->force_creators, fc);
+}
+
+bool same_point(vector_t v1, vector_t v2) {
+  return v1.x == v2.x && v1.y == v2.y;
+}
+
+bool same_field(force_field_t *field1, force_field_t *field2) {
+  if (field1->bounded != field2->bounded ||
+      (field1->bounded &&
+       !(same_point(field1->region.min, field2->region.min) &&
+         same_point(field1->region.max, field2->region.max)))) {
+    return false;
+  }
+  return same_point(field1->acceleration, field2->acceleration) &&
+         field1->drag == field2->drag &&
+         field1->categories == field2->categories;
+}
+
+size_t scene_force_field(scene_t *scene, force_field_t field) {
+  for (size_t i = 0; i < scene->num_fields; i++) {
+    if (same_field(&scene->fields[i].field, &field)) {
+      return i;
+    }
+  }
+  if (scene->num_fields == scene->field_capacity) {
+    scene->field_capacity =
+        scene->field_capacity == 0 ? 4 : scene->field_capacity * 2;
+    scene->fields =
+        realloc(scene->fields, scene->field_capacity * sizeof(stored_field_t));
+    assert(scene->fields != NULL);
+  }
+  scene->fields[scene->num_fields] = (stored_field_t){.field = field,
+                                                      .bodies = NULL,
+                                                      .num_bodies = 0,
+                                                      .body_capacity = 0};
+  return scene->num_fields++;
+}
+
+void scene_add_field_body(scene_t *scene, size_t field, body_t *body) {
+  assert(field < scene->num_fields);
+  stored_field_t *stored = &scene->fields[field];
+  if (stored->num_bodies == stored->body_capacity) {
+    stored->body_capacity =
+        stored->body_capacity == 0 ? initial_num_forces
+                                   : stored->body_capacity * 2;
+    stored->bodies =
+        realloc(stored->bodies, stored->body_capacity * sizeof(body_t *));
+    assert(stored->bodies != NULL);
+  }
+  stored->bodies[stored->num_bodies++] = body;
+}
+
+// adds a field's force to a body, if the body is in the field
+void field_apply(force_field_t *field, body_t *body) {
+  double mass = body_get_mass(body);
+  if (isinf(mass)) {
+    return;
+  }
+  if (field->bounded) {
+    vector_t center = body_get_centroid(body);
+    if (center.x < field->region.min.x || center.x > field->region.max.x ||
+        center.y < field->region.min.y || center.y > field->region.max.y) {
+      return;
+    }
+  }
+  vector_t force = vec_multiply(mass, field->acceleration);
+  if (field->drag != 0) {
+    force = vec_subtract(force,
+                         vec_multiply(field->drag, body_get_velocity(body)));
+  }
+  body_add_force(body, force);
+}
+
+// adds the force of every field to the bodies it acts on
+void scene_apply_fields(scene_t *scene) {
+  for (size_t i = 0; i < scene->num_fields; i++) {
+    stored_field_t *stored = &scene->fields[i];
+    for (size_t j = 0; j < stored->num_bodies; j++) {
+      body_t *body = stored->bodies[j];
+      // an added body in the field's categories gets the force below
+      if ((body_get_category(body) & stored->field.categories) == 0) {
+        field_apply(&stored->field, body);
+      }
+    }
+    if (stored->field.categories == 0) {
+      continue;
+    }
+    for (size_t j = 0; j < scene_bodies(scene); j++) {
+      body_t *body = scene_get_body(scene, j);
+      if ((body_get_category(body) & stored->field.categories) != 0) {
+        field_apply(&stored->field, body);
+      }
+    }
+  }
+}
+
+// drops removed bodies from the fields
+void scene_prune_fields(scene_t *scene) {
+  for (size_t i = 0; i < scene->num_fields; i++) {
+    stored_field_t *stored = &scene->fields[i];
+    size_t num_bodies = 0;
+    for (size_t j = 0; j < stored->num_bodies; j++) {
+      if (!body_is_removed(stored->bodies[j])) {
+        stored->bodies[num_bodies++] = stored->bodies[j];
+      }
+    }
+    stored->num_bodies = num_bodies;
+  }
+}
+
+void scene_set_job_system(scene_t *scene, job_system_t *jobs) {
+  scene->jobs = jobs;
+}
+
+void scene_set_integrator(scene_t *scene, integrator_t integrator) {
+  scene->integrator = integrator;
+}
+
+integrator_t scene_get_integrator(scene_t *scene) { return scene->integrator; }
+
+void scene_set_substeps(scene_t *scene, size_t substeps) {
+  assert(substeps >= 1);
+  scene->substeps = substeps;
+}
+
+size_t scene_get_substeps(scene_t *scene) { return scene->substeps; }
+
 // mark a store_force_creator for removal
 bool force_to_removed(store_force_creator_t *fc, body_t *body_removed) {
   list_t *bodies = fc->bodies;
@@ -330,13 +770,939 @@ void scene_set_double_points(scene_t *scene, bool result){
 }
 
 
-void scene_tick(scene_t *scene, double dt) {
-  // apply all forces
-  for (size_t i = 0; i < list_size(scene->force_creators); i++) {
+// hashes an ordered pair of bodies
+uint64_t pair_hash(body_t *body1, body_t *body2) {
+  return (uintptr_t)body1 * 0x9e3779b97f4a7c15u ^
+         (uintptr_t)body2 * 0xc2b2ae3d27d4eb4fu;
+}
+
+// hashes the pair, handler and aux of an event, which identify duplicates
+size_t event_hash(scene_t *scene, collision_event_t *event) {
+  uint64_t h = pair_hash(event->body1, event->body2);
+  h ^= (uintptr_t)event->handler;
+  h ^= (uintptr_t)event->aux * 0x165667b19e3779f9u;
+  h ^= h >> 29;
+  return (size_t)h & (scene->num_event_slots - 1);
+}
+
+bool same_collision(collision_event_t *event1, collision_event_t *event2) {
+  return event1->body1 == event2->body1 && event1->body2 == event2->body2 &&
+         event1->handler == event2->handler && event1->aux == event2->aux;
+}
+
+// returns the slot holding a duplicate of the event, or the empty slot
+// where the event belongs
+event_slot_t *event_find_slot(scene_t *scene, collision_event_t *event) {
+  size_t slot = event_hash(scene, event);
+  while (scene->event_slots[slot].tick == scene->event_tick &&
+         !same_collision(&scene->events[scene->event_slots[slot].event],
+                         event)) {
+    slot = (slot + 1) & (scene->num_event_slots - 1);
+  }
+  return &scene->event_slots[slot];
+}
+
+// doubles the event table, keeping it at most half full
+void event_slots_grow(scene_t *scene) {
+  free(scene->event_slots);
+  scene->num_event_slots *= 2;
+  scene->event_slots = calloc(scene->num_event_slots, sizeof(event_slot_t));
+  assert(scene->event_slots != NULL);
+  for (size_t i = 0; i < scene->num_events; i++) {
+    *event_find_slot(scene, &scene->events[i]) =
+        (event_slot_t){.event = i, .tick = scene->event_tick};
+  }
+}
+
+void scene_queue_collision(scene_t *scene, collision_event_t event) {
+  assert(event.handler != NULL);
+  event_slot_t *slot = event_find_slot(scene, &event);
+  if (slot->tick == scene->event_tick) {
+    return;
+  }
+  if (scene->num_events == scene->event_capacity) {
+    scene->event_capacity *= 2;
+    collision_event_t *events = realloc(
+        scene->events, scene->event_capacity * sizeof(collision_event_t));
+    assert(events != NULL);
+    scene->events = events;
+  }
+  *slot = (event_slot_t){.event = scene->num_events, .tick = scene->event_tick};
+  scene->events[scene->num_events++] = event;
+  if (2 * scene->num_events > scene->num_event_slots) {
+    event_slots_grow(scene);
+  }
+}
+
+// calls the handlers of the collisions queued this tick, in order
+void scene_dispatch_collisions(scene_t *scene) {
+  for (size_t i = 0; i < scene->num_events; i++) {
+    collision_event_t *event = &scene->events[i];
+    event->handler(event->body1, event->body2, event->axis, event->aux);
+  }
+  scene->num_events = 0;
+  // forgets every slot of the table at once
+  scene->event_tick++;
+}
+
+// returns the slot holding the index of a pair of bodies,
+// or the empty slot where it belongs
+size_t *contact_find_slot(scene_t *scene, body_t *body1, body_t *body2) {
+  uint64_t h = pair_hash(body1, body2);
+  size_t slot = (size_t)(h ^ h >> 29) & (scene->num_contact_slots - 1);
+  while (scene->contact_slots[slot] != 0) {
+    contact_pair_t *pair =
+        &scene->contact_pairs[scene->contact_slots[slot] - 1];
+    if (pair->body1 == body1 && pair->body2 == body2) {
+      break;
+    }
+    slot = (slot + 1) & (scene->num_contact_slots - 1);
+  }
+  return &scene->contact_slots[slot];
+}
+
+// refills the pair table, which is kept at most half full
+void contact_slots_rebuild(scene_t *scene) {
+  if (2 * scene->num_contact_pairs > scene->num_contact_slots) {
+    free(scene->contact_slots);
+    while (2 * scene->num_contact_pairs > scene->num_contact_slots) {
+      scene->num_contact_slots *= 2;
+    }
+    scene->contact_slots = malloc(scene->num_contact_slots * sizeof(size_t));
+    assert(scene->contact_slots != NULL);
+  }
+  for (size_t i = 0; i < scene->num_contact_slots; i++) {
+    scene->contact_slots[i] = 0;
+  }
+  for (size_t i = 0; i < scene->num_contact_pairs; i++) {
+    contact_pair_t *pair = &scene->contact_pairs[i];
+    *contact_find_slot(scene, pair->body1, pair->body2) = i + 1;
+  }
+}
+
+// returns the index of a pair of bodies, adding the pair if it is new
+size_t scene_contact_pair(scene_t *scene, body_t *body1, body_t *body2) {
+  size_t *slot = contact_find_slot(scene, body1, body2);
+  if (*slot != 0) {
+    return *slot - 1;
+  }
+  if (scene->num_contact_pairs == scene->contact_pair_capacity) {
+    scene->contact_pair_capacity *= 2;
+    scene->contact_pairs =
+        realloc(scene->contact_pairs,
+                scene->contact_pair_capacity * sizeof(contact_pair_t));
+    assert(scene->contact_pairs != NULL);
+  }
+  size_t index = scene->num_contact_pairs++;
+  scene->contact_pairs[index] = (contact_pair_t){.body1 = body1,
+                                                 .body2 = body2,
+                                                 .touching = false,
+                                                 .result = SIZE_MAX,
+                                                 .discovered = false};
+  *slot = index + 1;
+  if (2 * scene->num_contact_pairs > scene->num_contact_slots) {
+    contact_slots_rebuild(scene);
+  }
+  return index;
+}
+
+// adds a contact on a pair of bodies; returns the contact
+contact_t *scene_add_pair_contact(scene_t *scene, size_t pair,
+                                  contact_handlers_t handlers, void *aux) {
+  if (scene->num_contacts == scene->contact_capacity) {
+    scene->contact_capacity *= 2;
+    scene->contacts =
+        realloc(scene->contacts, scene->contact_capacity * sizeof(contact_t));
+    assert(scene->contacts != NULL);
+  }
+  contact_t *contact = &scene->contacts[scene->num_contacts++];
+  *contact = (contact_t){.pair = pair,
+                         .handlers = handlers,
+                         .aux = aux,
+                         .freer = NULL,
+                         .touching = false,
+                         .discovered = false,
+                         .solid = false,
+                         .elasticity = 0,
+                         .axis = VEC_ZERO,
+                         .impulse = 0};
+  return contact;
+}
+
+void scene_add_contact(scene_t *scene, body_t *body1, body_t *body2,
+                       contact_handlers_t handlers, void *aux,
+                       free_func_t freer) {
+  size_t pair = scene_contact_pair(scene, body1, body2);
+  scene_add_pair_contact(scene, pair, handlers, aux)->freer = freer;
+}
+
+void scene_add_category_contact(scene_t *scene, uint32_t category1,
+                                uint32_t category2,
+                                contact_handlers_t handlers, void *aux,
+                                free_func_t freer) {
+  if (scene->num_category_contacts == scene->category_contact_capacity) {
+    scene->category_contact_capacity =
+        scene->category_contact_capacity == 0
+            ? initial_num_forces
+            : scene->category_contact_capacity * 2;
+    scene->category_contacts = realloc(
+        scene->category_contacts,
+        scene->category_contact_capacity * sizeof(category_contact_t));
+    assert(scene->category_contacts != NULL);
+  }
+  scene->category_contacts[scene->num_category_contacts++] =
+      (category_contact_t){.category1 = category1,
+                           .category2 = category2,
+                           .handlers = handlers,
+                           .aux = aux,
+                           .freer = freer,
+                           .solid = false,
+                           .elasticity = 0,
+                           .axis = VEC_ZERO};
+  scene->contact_categories |= category1;
+}
+
+void scene_add_solid_contact(scene_t *scene, body_t *body1, body_t *body2,
+                             double elasticity) {
+  scene_add_axis_contact(scene, body1, body2, elasticity, VEC_ZERO);
+}
+
+void scene_add_axis_contact(scene_t *scene, body_t *body1, body_t *body2,
+                            double elasticity, vector_t axis) {
+  size_t pair = scene_contact_pair(scene, body1, body2);
+  contact_t *contact =
+      scene_add_pair_contact(scene, pair, (contact_handlers_t){0}, NULL);
+  contact->solid = true;
+  contact->elasticity = elasticity;
+  contact->axis = normalize(axis);
+}
+
+void scene_add_category_solid_contact(scene_t *scene, uint32_t category1,
+                                      uint32_t category2, double elasticity) {
+  scene_add_category_axis_contact(scene, category1, category2, elasticity,
+                                  VEC_ZERO);
+}
+
+void scene_add_category_axis_contact(scene_t *scene, uint32_t category1,
+                                     uint32_t category2, double elasticity,
+                                     vector_t axis) {
+  scene_add_category_contact(scene, category1, category2,
+                             (contact_handlers_t){0}, NULL, NULL);
+  category_contact_t *contact =
+      &scene->category_contacts[scene->num_category_contacts - 1];
+  contact->solid = true;
+  contact->elasticity = elasticity;
+  contact->axis = normalize(axis);
+}
+
+// whether a category contact applies to a pair of bodies
+bool category_contact_applies(category_contact_t *contact, body_t *body1,
+                              body_t *body2) {
+  uint32_t category1 = body_get_category(body1);
+  uint32_t category2 = body_get_category(body2);
+  return (category1 & contact->category1) != 0 &&
+         (category2 & contact->category2) != 0 &&
+         (body_get_mask(body1) & category2) != 0 &&
+         (body_get_mask(body2) & category1) != 0;
+}
+
+// adds the category contacts of a pair of bodies, unless they already have
+// them or none apply
+void scene_discover_pair(scene_t *scene, body_t *body1, body_t *body2) {
+  size_t num_applying = 0;
+  for (size_t i = 0; i < scene->num_category_contacts; i++) {
+    if (category_contact_applies(&scene->category_contacts[i], body1, body2)) {
+      num_applying++;
+    }
+  }
+  if (num_applying == 0) {
+    return;
+  }
+  size_t pair = scene_contact_pair(scene, body1, body2);
+  if (scene->contact_pairs[pair].discovered) {
+    return;
+  }
+  scene->contact_pairs[pair].discovered = true;
+  for (size_t i = 0; i < scene->num_category_contacts; i++) {
+    category_contact_t *category_contact = &scene->category_contacts[i];
+    if (category_contact_applies(category_contact, body1, body2)) {
+      contact_t *contact = scene_add_pair_contact(
+          scene, pair, category_contact->handlers, category_contact->aux);
+      contact->discovered = true;
+      contact->solid = category_contact->solid;
+      contact->elasticity = category_contact->elasticity;
+      contact->axis = category_contact->axis;
+    }
+  }
+}
+
+// finds the pairs of bodies with overlapping bounds that category contacts
+// apply to
+void scene_discover_contacts(scene_t *scene) {
+  if (scene->num_category_contacts == 0) {
+    return;
+  }
+  scene_update_index(scene);
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body1 = scene_get_body(scene, i);
+    if ((body_get_category(body1) & scene->contact_categories) == 0) {
+      continue;
+    }
+    list_clear(scene->query_results);
+    spatial_index_query(scene->index, body_get_bounds(body1),
+                        scene->query_results);
+    for (size_t j = 0; j < list_size(scene->query_results); j++) {
+      body_t *body2 = list_get(scene->query_results, j);
+      if (body2 != body1 && !body_is_removed(body1) &&
+          !body_is_removed(body2)) {
+        scene_discover_pair(scene, body1, body2);
+      }
+    }
+  }
+}
+
+// queues a handler of a contact, if it has one
+void contact_queue(scene_t *scene, contact_t *contact,
+                   collision_handler_t handler) {
+  if (handler == NULL) {
+    return;
+  }
+  contact_pair_t *pair = &scene->contact_pairs[contact->pair];
+  scene_queue_collision(scene, (collision_event_t){.body1 = pair->body1,
+                                                   .body2 = pair->body2,
+                                                   .axis = pair->axis,
+                                                   .depth = pair->depth,
+                                                   .handler = handler,
+                                                   .aux = contact->aux});
+}
+
+// reads the tests of the contact pairs, then queues the handlers of every
+// contact whose bodies began, kept or stopped touching
+void scene_update_contacts(scene_t *scene) {
+  for (size_t i = 0; i < scene->num_contact_pairs; i++) {
+    contact_pair_t *pair = &scene->contact_pairs[i];
+    pair->touching = false;
+    if (pair->result != SIZE_MAX) {
+      collision_info_t *info = &scene->pair_results[pair->result];
+      pair->touching = info->collided;
+      if (info->collided) {
+        pair->axis = info->axis;
+        pair->depth = info->depth;
+      }
+    }
+  }
+  for (size_t i = 0; i < scene->num_contacts; i++) {
+    contact_t *contact = &scene->contacts[i];
+    bool touching = scene->contact_pairs[contact->pair].touching;
+    if (touching && !contact->touching) {
+      contact_queue(scene, contact, contact->handlers.begin);
+    } else if (touching) {
+      contact_queue(scene, contact, contact->handlers.stay);
+    } else if (contact->touching) {
+      contact_queue(scene, contact, contact->handlers.end);
+    }
+    contact->touching = touching;
+  }
+}
+
+// whether a contact is dropped: when either body is removed, or when it
+// came from a category contact and the bounds stopped overlapping
+bool contact_dropped(contact_pair_t *pair, contact_t *contact) {
+  return body_is_removed(pair->body1) || body_is_removed(pair->body2) ||
+         (contact->discovered && pair->result == SIZE_MAX);
+}
+
+// drops the contacts of removed bodies and of pairs that separated,
+// and the pairs left without contacts
+void scene_prune_contacts(scene_t *scene) {
+  for (size_t i = 0; i < scene->num_contact_pairs; i++) {
+    scene->contact_pairs[i].num_kept = 0;
+  }
+  size_t num_dropped = 0;
+  for (size_t i = 0; i < scene->num_contacts; i++) {
+    contact_t *contact = &scene->contacts[i];
+    contact_pair_t *pair = &scene->contact_pairs[contact->pair];
+    if (contact_dropped(pair, contact)) {
+      num_dropped++;
+    } else {
+      pair->num_kept++;
+    }
+  }
+  if (num_dropped == 0) {
+    return;
+  }
+  // the result field of each pair is reused to hold its new index
+  size_t num_pairs = 0;
+  for (size_t i = 0; i < scene->num_contact_pairs; i++) {
+    contact_pair_t *pair = &scene->contact_pairs[i];
+    bool dropped = pair->num_kept == 0;
+    // a pair that separated can have its category contacts added again
+    if (pair->result == SIZE_MAX) {
+      pair->discovered = false;
+    }
+    pair->result = dropped ? SIZE_MAX : num_pairs++;
+  }
+  size_t num_contacts = 0;
+  for (size_t i = 0; i < scene->num_contacts; i++) {
+    contact_t contact = scene->contacts[i];
+    contact_pair_t *pair = &scene->contact_pairs[contact.pair];
+    if (pair->result == SIZE_MAX ||
+        (contact.discovered && !pair->discovered)) {
+      if (contact.freer != NULL) {
+        contact.freer(contact.aux);
+      }
+      continue;
+    }
+    contact.pair = pair->result;
+    scene->contacts[num_contacts++] = contact;
+  }
+  scene->num_contacts = num_contacts;
+  for (size_t i = 0; i < scene->num_contact_pairs; i++) {
+    contact_pair_t *pair = &scene->contact_pairs[i];
+    if (pair->result != SIZE_MAX) {
+      scene->contact_pairs[pair->result] = *pair;
+    }
+  }
+  scene->num_contact_pairs = num_pairs;
+  contact_slots_rebuild(scene);
+}
+
+// the parallel force creators [start, end) of a scene
+typedef struct force_run {
+  scene_t *scene;
+  size_t start;
+  size_t end;
+} force_run_t;
+
+// runs chunks of a force run, each into its own force log
+void run_force_chunks(void *aux, size_t first_chunk, size_t end_chunk) {
+  force_run_t *run = aux;
+  for (size_t chunk = first_chunk; chunk < end_chunk; chunk++) {
+    size_t start = run->start + chunk * FORCE_CHUNK_SIZE;
+    size_t end = run->end - start < FORCE_CHUNK_SIZE ? run->end
+                                                     : start + FORCE_CHUNK_SIZE;
+    force_log_begin(list_get(run->scene->force_logs, chunk));
+    for (size_t i = start; i < end; i++) {
+      store_force_creator_t *fc = list_get(run->scene->force_creators, i);
+      fc->forcer(fc->aux);
+    }
+    force_log_end();
+  }
+}
+
+// runs the parallel force creators [start, end) on the scene's job system,
+// then adds their forces to the bodies in order
+void scene_run_parallel_forces(scene_t *scene, size_t start, size_t end) {
+  size_t num_chunks = (end - start - 1) / FORCE_CHUNK_SIZE + 1;
+  while (list_size(scene->force_logs) < num_chunks) {
+    list_add(scene->force_logs, force_log_init());
+  }
+  force_run_t run = {.scene = scene, .start = start, .end = end};
+  job_parallel_for(scene->jobs, num_chunks, 1, run_force_chunks, &run);
+  for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+    force_log_apply(list_get(scene->force_logs, chunk));
+  }
+}
+
+// adds a pair of bodies to this tick's batch of collision tests
+// and returns the index of its result
+size_t scene_add_test(scene_t *scene, size_t num_tests, body_t *body1,
+                      body_t *body2) {
+  if (num_tests == scene->pair_capacity) {
+    scene->pair_capacity *= 2;
+    scene->pairs = realloc(scene->pairs,
+                           scene->pair_capacity * sizeof(collision_pair_t));
+    scene->pair_results = realloc(
+        scene->pair_results, scene->pair_capacity * sizeof(collision_info_t));
+    assert(scene->pairs != NULL && scene->pair_results != NULL);
+  }
+  scene->pairs[num_tests] =
+      (collision_pair_t){.shape1 = body_borrow_shape(body1),
+                         .shape2 = body_borrow_shape(body2)};
+  return num_tests;
+}
+
+// finds the bodies whose bounds overlap a body's with the spatial index,
+// into query_results; the body last queried is passed back in, so the
+// pairs that share a first body, which are usually added together, only
+// query the index once
+void scene_query_neighbours(scene_t *scene, body_t *body, body_t **queried) {
+  if (*queried != body) {
+    list_clear(scene->query_results);
+    spatial_index_query(scene->index, body_get_bounds(body),
+                        scene->query_results);
+    *queried = body;
+  }
+}
+
+// whether a body was found by the last scene_query_neighbours()
+bool scene_is_neighbour(scene_t *scene, body_t *body) {
+  for (size_t i = 0; i < list_size(scene->query_results); i++) {
+    if (list_get(scene->query_results, i) == body) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// whether two bodies' bounds overlap; with the spatial index, body1's
+// neighbours are looked up, otherwise the bounds are compared directly
+bool scene_bounds_overlap(scene_t *scene, bool use_index, body_t *body1,
+                          body_t *body2, body_t **queried) {
+  if (!use_index) {
+    return aabb_overlap(body_get_bounds(body1), body_get_bounds(body2));
+  }
+  scene_query_neighbours(scene, body1, queried);
+  return scene_is_neighbour(scene, body2);
+}
+
+// tests the collision testers and contact pairs whose bodies overlap for
+// collision, in one batch so the tests can be spread over the job system.
+// The spatial index is used when it is already up to date for this tick,
+// or when category contacts need it anyway; updating it only for explicit
+// pairs costs more than checking each pair's bounds.
+void scene_find_collisions(scene_t *scene) {
+  bool use_index = (!scene->index_dirty && !scene->index_moved) ||
+                   scene->num_category_contacts > 0;
+  if (use_index) {
+    scene_update_index(scene);
+  }
+  body_t *queried = NULL;
+  size_t num_creators = list_size(scene->force_creators);
+  size_t num_tests = 0;
+  for (size_t i = 0; i < num_creators; i++) {
     store_force_creator_t *fc = list_get(scene->force_creators, i);
-    force_creator_t forcer = fc->forcer;
-    forcer(fc->aux);
+    if (fc->tester == NULL) {
+      continue;
+    }
+    fc->tested = true;
+    fc->result = SIZE_MAX;
+    if (scene_bounds_overlap(scene, use_index, fc->body1, fc->body2,
+                             &queried)) {
+      fc->result = scene_add_test(scene, num_tests++, fc->body1, fc->body2);
+    }
+  }
+  for (size_t i = 0; i < scene->num_contact_pairs; i++) {
+    contact_pair_t *pair = &scene->contact_pairs[i];
+    pair->result = SIZE_MAX;
+    if (!use_index &&
+        aabb_overlap(body_get_bounds(pair->body1),
+                     body_get_bounds(pair->body2))) {
+      pair->result =
+          scene_add_test(scene, num_tests++, pair->body1, pair->body2);
+    }
   }
+  if (use_index) {
+    // each overlapping pair is found from its first body's neighbours
+    body_t *matched = NULL;
+    for (size_t i = 0; i < scene->num_contact_pairs; i++) {
+      body_t *body1 = scene->contact_pairs[i].body1;
+      if (body1 == matched) {
+        continue;
+      }
+      matched = body1;
+      scene_query_neighbours(scene, body1, &queried);
+      for (size_t j = 0; j < list_size(scene->query_results); j++) {
+        body_t *body2 = list_get(scene->query_results, j);
+        size_t slot = *contact_find_slot(scene, body1, body2);
+        if (slot == 0 || scene->contact_pairs[slot - 1].result != SIZE_MAX) {
+          continue;
+        }
+        contact_pair_t *pair = &scene->contact_pairs[slot - 1];
+        pair->result = scene_add_test(scene, num_tests++, body1, body2);
+      }
+    }
+  }
+  find_collisions(scene->jobs, scene->pairs, num_tests, scene->pair_results);
+}
+
+// runs the force creators, and the collision testers if asked to;
+// runs of parallel force creators go to the job system
+void scene_run_force_creators(scene_t *scene, bool run_testers) {
+  size_t num_creators = list_size(scene->force_creators);
+  // logging forces only pays off when there are threads to share the work
+  bool parallel =
+      scene->jobs != NULL && job_system_num_threads(scene->jobs) > 1;
+  size_t i = 0;
+  while (i < num_creators) {
+    size_t end = i;
+    while (parallel && end < num_creators &&
+           ((store_force_creator_t *)list_get(scene->force_creators, end))
+               ->parallel) {
+      end++;
+    }
+    if (end - i >= MIN_PARALLEL_FORCE_CREATORS) {
+      scene_run_parallel_forces(scene, i, end);
+      i = end;
+      continue;
+    }
+    // a short run, or a force creator that must run alone
+    end = end > i ? end : i + 1;
+    for (; i < end; i++) {
+      store_force_creator_t *fc = list_get(scene->force_creators, i);
+      if (fc->tester != NULL) {
+        // testers added during this tick are first tested in the next one
+        if (!run_testers || !fc->tested) {
+          continue;
+        }
+        collision_info_t info = fc->result == SIZE_MAX
+                                    ? (collision_info_t){.collided = false}
+                                    : scene->pair_results[fc->result];
+        fc->tester(fc->aux, info);
+      } else {
+        fc->forcer(fc->aux);
+      }
+    }
+  }
+}
+
+// applies all forces
+void scene_apply_forces(scene_t *scene) {
+  scene_apply_fields(scene);
+  scene_discover_contacts(scene);
+  scene_find_collisions(scene);
+  scene_run_force_creators(scene, true);
+  scene_update_contacts(scene);
+}
+
+// recomputes the forces of the fields and force creators on the bodies
+// where they are now, for the integrators that look ahead
+void scene_reapply_forces(scene_t *scene) {
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_clear_forces(scene_get_body(scene, i));
+  }
+  // force creators may look bodies up by position
+  scene->index_moved = true;
+  scene_apply_fields(scene);
+  scene_run_force_creators(scene, false);
+}
+
+// the velocity a body will have after this tick's forces and impulses
+vector_t solver_velocity(body_t *body, double dt) {
+  vector_t change = vec_add(body_get_impulse(body),
+                            vec_multiply(dt, body_get_force(body)));
+  return vec_add(body_get_velocity(body),
+                 vec_multiply(1 / body_get_mass(body), change));
+}
+
+// how fast a row's bodies move apart along its normal
+double row_separation_speed(solver_row_t *row, double dt) {
+  return vec_dot(vec_subtract(solver_velocity(row->body2, dt),
+                              solver_velocity(row->body1, dt)),
+                 row->normal);
+}
+
+// applies an impulse to a row's bodies, pushing body2 along the normal
+void row_apply_impulse(solver_row_t *row, double impulse) {
+  vector_t push = vec_multiply(impulse, row->normal);
+  body_add_impulse(row->body1, vec_negate(push));
+  body_add_impulse(row->body2, push);
+}
+
+// gathers the solid contacts whose bodies touch; returns how many there are
+size_t scene_gather_solver_rows(scene_t *scene, double dt) {
+  // room for every contact, so rows are only allocated as contacts are
+  if (scene->solver_row_capacity < scene->contact_capacity) {
+    scene->solver_row_capacity = scene->contact_capacity;
+    scene->solver_rows = realloc(
+        scene->solver_rows, scene->solver_row_capacity * sizeof(solver_row_t));
+    assert(scene->solver_rows != NULL);
+  }
+  size_t num_rows = 0;
+  for (size_t i = 0; i < scene->num_contacts; i++) {
+    contact_t *contact = &scene->contacts[i];
+    if (!contact->solid) {
+      continue;
+    }
+    contact_pair_t *pair = &scene->contact_pairs[contact->pair];
+    double inverse_mass1 = 1 / body_get_mass(pair->body1);
+    double inverse_mass2 = 1 / body_get_mass(pair->body2);
+    if (!pair->touching || body_is_removed(pair->body1) ||
+        body_is_removed(pair->body2) || inverse_mass1 + inverse_mass2 == 0) {
+      contact->impulse = 0;
+      continue;
+    }
+    vector_t normal = pair->axis;
+    double depth = pair->depth;
+    if (contact->axis.x != 0 || contact->axis.y != 0) {
+      // only the part of the push along the contact's axis
+      double cosine = vec_dot(normal, contact->axis);
+      if (fabs(cosine) < AXIS_CONTACT_MIN_COSINE) {
+        contact->impulse = 0;
+        continue;
+      }
+      normal = vec_multiply(cosine < 0 ? -1 : 1, contact->axis);
+      depth *= fabs(cosine);
+    }
+    vector_t between = vec_subtract(body_get_centroid(pair->body2),
+                                    body_get_centroid(pair->body1));
+    if (vec_dot(normal, between) < 0) {
+      normal = vec_negate(normal);
+    }
+    solver_row_t *row = &scene->solver_rows[num_rows++];
+    *row = (solver_row_t){.contact = contact,
+                          .body1 = pair->body1,
+                          .body2 = pair->body2,
+                          .normal = normal,
+                          .inverse_mass1 = inverse_mass1,
+                          .inverse_mass2 = inverse_mass2,
+                          .target = 0};
+    double speed = row_separation_speed(row, dt);
+    if (speed < -RESTITUTION_THRESHOLD) {
+      row->target = -contact->elasticity * speed;
+    }
+    double overlap = depth - SOLVER_SLOP;
+    if (overlap > 0) {
+      row->target = fmax(row->target, SOLVER_BAUMGARTE * overlap / dt);
+    }
+  }
+  return num_rows;
+}
+
+// applies impulses to the touching solid contacts until their bodies no
+// longer move into each other, one contact at a time, starting from the
+// impulses they needed last tick; a tick of no time moves nothing, so
+// nothing is solved and the overlap is not divided by it
+void scene_solve_contacts(scene_t *scene, double dt) {
+  if (dt <= 0) {
+    return;
+  }
+  size_t num_rows = scene_gather_solver_rows(scene, dt);
+  for (size_t i = 0; i < num_rows; i++) {
+    solver_row_t *row = &scene->solver_rows[i];
+    row_apply_impulse(row, row->contact->impulse);
+  }
+  for (size_t iteration = 0; iteration < SOLVER_ITERATIONS; iteration++) {
+    for (size_t i = 0; i < num_rows; i++) {
+      solver_row_t *row = &scene->solver_rows[i];
+      double speed = row_separation_speed(row, dt);
+      double change = (row->target - speed) /
+                      (row->inverse_mass1 + row->inverse_mass2);
+      // contacts only push, so the total impulse cannot go below 0
+      double impulse = fmax(row->contact->impulse + change, 0);
+      row_apply_impulse(row, impulse - row->contact->impulse);
+      row->contact->impulse = impulse;
+    }
+  }
+}
+
+// the first time a fast body touches a body it must not pass through
+// during a tick, or 1 if it does not; the bodies it could hit are found
+// by its swept bounds, so obstacles are assumed to move much less
+collision_sweep_t ccd_first_hit(scene_t *scene, body_t *body, vector_t motion,
+                                double dt, vector_t *hit_motion) {
+  collision_sweep_t first = {.collided = false, .time = 1, .axis = VEC_ZERO};
+  uint32_t categories = body_get_ccd_categories(body);
+  list_t *nearby =
+      scene_bodies_in_bounds(scene, aabb_sweep(body_get_bounds(body), motion));
+  for (size_t i = 0; i < list_size(nearby); i++) {
+    body_t *other = list_get(nearby, i);
+    if (other == body || body_is_removed(other) ||
+        (body_get_category(other) & categories) == 0) {
+      continue;
+    }
+    vector_t other_motion = body_get_motion(other, dt);
+    collision_sweep_t sweep =
+        find_time_of_impact(body_borrow_shape(body), motion,
+                            body_borrow_shape(other), other_motion);
+    // bodies that already overlap are left to the collision tests
+    if (sweep.collided && sweep.time > 0 && sweep.time < first.time) {
+      first = sweep;
+      *hit_motion = other_motion;
+    }
+  }
+  return first;
+}
+
+// finds where each fast body must stop so it does not pass through
+// anything this tick
+void scene_sweep_fast_bodies(scene_t *scene, double dt) {
+  scene->num_ccd_stops = 0;
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (body_get_ccd_categories(body) == 0 || body_is_removed(body)) {
+      continue;
+    }
+    vector_t motion = body_get_motion(body, dt);
+    vector_t hit_motion = VEC_ZERO;
+    collision_sweep_t hit = ccd_first_hit(scene, body, motion, dt, &hit_motion);
+    if (!hit.collided) {
+      continue;
+    }
+    if (scene->num_ccd_stops == scene->ccd_stop_capacity) {
+      scene->ccd_stop_capacity *= 2;
+      scene->ccd_stops = realloc(scene->ccd_stops,
+                                 scene->ccd_stop_capacity * sizeof(ccd_stop_t));
+      assert(scene->ccd_stops != NULL);
+    }
+    // from where they touch, what it hit pushes the body along the axis they
+    // touch on, but does not drag it along its surface
+    vector_t pushed = vec_project(hit_motion, hit.axis);
+    vector_t travelled = vec_add(vec_multiply(hit.time, motion),
+                                 vec_multiply(1 - hit.time, pushed));
+    vector_t centroid = vec_add(body_get_centroid(body), travelled);
+    scene->ccd_stops[scene->num_ccd_stops++] = (ccd_stop_t){
+        .body = body,
+        .centroid = vec_add(centroid, vec_multiply(CCD_SKIN, hit.axis))};
+  }
+}
+
+vector_t body_acceleration(body_t *body) {
+  return vec_multiply(1 / body_get_mass(body), body_get_force(body));
+}
+
+// moves each body at its velocity after the step's forces and impulses
+void scene_integrate_euler(scene_t *scene, double dt) {
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (body_is_removed(body)) {
+      continue;
+    }
+    vector_t velocity = solver_velocity(body, dt);
+    body_set_velocity(body, velocity);
+    body_set_centroid(body, vec_add(body_get_centroid(body),
+                                    vec_multiply(dt, velocity)));
+    body_clear_forces(body);
+  }
+}
+
+// records where each body starts the step and its acceleration there,
+// with the impulses already applied to its velocity
+void scene_begin_stages(scene_t *scene) {
+  size_t num_bodies = scene_bodies(scene);
+  if (scene->stage_capacity < num_bodies) {
+    scene->stage_capacity = num_bodies > 2 * scene->stage_capacity
+                                ? num_bodies
+                                : 2 * scene->stage_capacity;
+    scene->stages = realloc(scene->stages,
+                            scene->stage_capacity * sizeof(stage_state_t));
+    assert(scene->stages != NULL);
+  }
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = scene_get_body(scene, i);
+    vector_t velocity =
+        vec_add(body_get_velocity(body),
+                vec_multiply(1 / body_get_mass(body), body_get_impulse(body)));
+    vector_t acceleration = body_acceleration(body);
+    scene->stages[i] = (stage_state_t){.centroid = body_get_centroid(body),
+                                       .velocity = velocity,
+                                       .stage_velocity = velocity,
+                                       .stage_acceleration = acceleration,
+                                       .velocity_sum = velocity,
+                                       .acceleration_sum = acceleration};
+  }
+}
+
+// moves each body from the start of the step for a time at the latest
+// stage's velocity and acceleration, then adds the ones found there to the
+// sums with a weight
+void scene_run_stage(scene_t *scene, double dt, double weight) {
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    stage_state_t *stage = &scene->stages[i];
+    if (!body_is_removed(body)) {
+      body_set_centroid(body, vec_add(stage->centroid,
+                                      vec_multiply(dt, stage->stage_velocity)));
+      body_set_velocity(body,
+                        vec_add(stage->velocity,
+                                vec_multiply(dt, stage->stage_acceleration)));
+    }
+  }
+  scene_reapply_forces(scene);
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    stage_state_t *stage = &scene->stages[i];
+    stage->stage_velocity = body_get_velocity(body);
+    stage->stage_acceleration = body_acceleration(body);
+    stage->velocity_sum = vec_add(
+        stage->velocity_sum, vec_multiply(weight, stage->stage_velocity));
+    stage->acceleration_sum =
+        vec_add(stage->acceleration_sum,
+                vec_multiply(weight, stage->stage_acceleration));
+  }
+}
+
+// the classic Runge-Kutta method: each body moves from the start of the
+// step at a weighted average of the velocities and accelerations of four
+// stages
+void scene_integrate_rk4(scene_t *scene, double dt) {
+  scene_begin_stages(scene);
+  scene_run_stage(scene, dt / 2, 2);
+  scene_run_stage(scene, dt / 2, 2);
+  scene_run_stage(scene, dt, 1);
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    stage_state_t *stage = &scene->stages[i];
+    if (!body_is_removed(body)) {
+      body_set_centroid(body,
+                        vec_add(stage->centroid,
+                                vec_multiply(dt / 6, stage->velocity_sum)));
+      body_set_velocity(body,
+                        vec_add(stage->velocity,
+                                vec_multiply(dt / 6, stage->acceleration_sum)));
+    }
+    body_clear_forces(body);
+  }
+}
+
+// each body moves under its acceleration at the start of the step, then
+// its velocity changes by the average of that and the one where it ends up
+void scene_integrate_verlet(scene_t *scene, double dt) {
+  scene_begin_stages(scene);
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    stage_state_t *stage = &scene->stages[i];
+    if (!body_is_removed(body)) {
+      vector_t moved =
+          vec_add(vec_multiply(dt, stage->velocity),
+                  vec_multiply(dt * dt / 2, stage->stage_acceleration));
+      body_set_centroid(body, vec_add(stage->centroid, moved));
+      // a guess for forces that depend on velocity
+      body_set_velocity(body,
+                        vec_add(stage->velocity,
+                                vec_multiply(dt, stage->stage_acceleration)));
+    }
+  }
+  scene_reapply_forces(scene);
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    stage_state_t *stage = &scene->stages[i];
+    if (!body_is_removed(body)) {
+      vector_t acceleration =
+          vec_add(stage->stage_acceleration, body_acceleration(body));
+      body_set_velocity(body, vec_add(stage->velocity,
+                                      vec_multiply(dt / 2, acceleration)));
+    }
+    body_clear_forces(body);
+  }
+}
+
+// moves every body by the forces and impulses on it with the scene's
+// integrator
+void scene_integrate(scene_t *scene, double dt) {
+  switch (scene->integrator) {
+  case INTEGRATOR_AVERAGE_VELOCITY:
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+      body_tick(scene_get_body(scene, i), dt);
+    }
+    break;
+  case INTEGRATOR_SEMI_IMPLICIT_EULER:
+    scene_integrate_euler(scene, dt);
+    break;
+  case INTEGRATOR_VELOCITY_VERLET:
+    scene_integrate_verlet(scene, dt);
+    break;
+  case INTEGRATOR_RK4:
+    scene_integrate_rk4(scene, dt);
+    break;
+  }
+}
+
+// one step of scene_tick()
+void scene_step(scene_t *scene, double dt) {
+  scene_apply_forces(scene);
+  scene_dispatch_collisions(scene);
+  scene_solve_contacts(scene, dt);
 
   for (size_t i = 0; i < scene_bodies(scene); i++) {
     body_t *body = scene_get_body(scene, i);
@@ -346,12 +1712,15 @@ void scene_tick(scene_t *scene, double dt) {
     }
   }
 
-  // body tick for the rest of bodies
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *body = scene_get_body(scene, i);
-    body_tick(body, dt);
+  scene_sweep_fast_bodies(scene, dt);
+  scene_integrate(scene, dt);
+  for (size_t i = 0; i < scene->num_ccd_stops; i++) {
+    ccd_stop_t *stop = &scene->ccd_stops[i];
+    body_set_centroid(stop->body, stop->centroid);
   }
 
+  scene_prune_contacts(scene);
+  scene_prune_fields(scene);
   // remove force creators if associated bodies are removed
   for (size_t i = 0; i < scene_bodies(scene); i++) {
     body_t *body = scene_get_body(scene, i);
@@ -369,9 +1738,20 @@ void scene_tick(scene_t *scene, double dt) {
       double score = body_get_score(removed);
       scene_change_score(scene, score);
       body_free(removed);
+      // the index holds bodies by position, so it is rebuilt
+      scene->index_dirty = true;
       i--;
     }
   }
+
+  // every body may have moved, so the index is updated on the next query
+  scene->index_moved = true;
+}
+
+void scene_tick(scene_t *scene, double dt) {
+  for (size_t i = 0; i < scene->substeps; i++) {
+    scene_step(scene, dt / scene->substeps);
+  }
 }
 
 size_t scene_forcer_count(scene_t *scene) {
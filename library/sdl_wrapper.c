@@ -1,10 +1,14 @@
 #include "sdl_wrapper.h"
+#include "asset_pack.h"
+#include "audio.h"
 #include "state.h"
 #include "body.h"
+#include "replay.h"
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h> // for debugging
 #include <SDL2/SDL.h>
@@ -12,14 +16,51 @@
 #include <SDL2/SDL_mixer.h>
 #include <SDL2/SDL_ttf.h>
 
+#define ALLOC_SUBSYSTEM ALLOC_PLATFORM
+#include "alloc_track.h"
+
 const char WINDOW_TITLE[] = "CS 3";
 const int WINDOW_WIDTH = 1000;
 const int WINDOW_HEIGHT = 500;
 const double MS_PER_S = 1e3;
-const double REMOVE_X_POSITION = -100.0;
 const double RENDER_INTERVAL = 50;
 int WIDTH = 800;
 int HEIGHT = 600;
+const char HUD_FONT_PATH[] = "assets/OpenSans.ttf";
+const int HUD_FONT_SIZE = 10;
+// every character the HUD labels and numbers are made of
+const char GLYPH_ATLAS_CHARS[] = "0123456789-: ScoreLiv";
+
+#define GLYPH_COUNT 128
+#define TEXT_CACHE_SIZE 16
+#define TEXT_LENGTH 32
+#define HUD_MAX_LINES 8
+#define NUM_TEXTS 8
+#define NUM_IMAGES 19
+#define NUM_IMAGE_LOADERS 2
+
+// indexed by the picture index bodies are created with
+const char *IMAGE_PATHS[NUM_IMAGES] = {
+    "assets/beaver.png",      "assets/ground.png",      "assets/water.png",
+    "assets/space.png",       "assets/welcome.png",     "assets/gameplay.png",
+    "assets/transition1.png", "assets/transition2.png", "assets/endgame.png",
+    "assets/losegame.png",    "assets/coin.png",        "assets/boba.png",
+    "assets/coffee.png",      "assets/ice_cube.png",    "assets/job_offer.png",
+    "assets/crow.png",        "assets/deadline.png",    "assets/shark.png",
+    "assets/trash.png"};
+// names the file to record the playthrough to, if set
+const char RECORD_ENV[] = "BEAVER_RECORD";
+// makes the platform check that frames stop allocating once warmed up
+const char CHECK_ALLOCS_ENV[] = "BEAVER_CHECK_ALLOCS";
+// frames a scene is shown for before drawing it must stop allocating;
+// pictures finish loading and the text cache fills in this time
+const size_t ALLOC_WARMUP_FRAMES = 120;
+// prebaked pixels for IMAGE_PATHS, written by "make pack"
+const char IMAGE_PACK_PATH[] = "assets/images.pack";
+// the welcome page is shown first, so it is decoded first; the rest follow
+// roughly in the order the game needs them
+const size_t IMAGE_LOAD_ORDER[NUM_IMAGES] = {4, 5, 0,  1,  10, 11, 12, 13, 14, 15,
+                                             16, 6, 2, 17, 18, 7, 3,  8,  9};
 
 
 /**
@@ -52,16 +93,141 @@ uint32_t key_start_timestamp;
  * Initially 0.
  */
 clock_t last_clock = 0;
+/**
+ * Screen coordinates of the polygon being drawn, kept between frames
+ * so drawing does not allocate once the largest polygon has been seen.
+ */
+int16_t *polygon_x_points = NULL;
+int16_t *polygon_y_points = NULL;
+size_t polygon_capacity = 0;
+/**
+ * Whether the window has been closed.
+ */
+bool quit = false;
+/**
+ * The seed the game's random numbers are drawn from.
+ */
+unsigned seed;
+/**
+ * The recording of this playthrough, or NULL if it is not being recorded.
+ */
+replay_writer_t *recording = NULL;
+/**
+ * The number of frames shown so far, which stamps recorded events.
+ */
+size_t frames_shown = 0;
+/**
+ * The part of the frame that is running. Only followed when
+ * BEAVER_CHECK_ALLOCS is set, along with the scene last rendered,
+ * the frames it has been shown for, and the allocations made by this
+ * frame's physics and render phases.
+ */
+frame_phase_t phase = PHASE_LOGIC;
+scene_t *steady_scene = NULL;
+size_t steady_frames = 0;
+size_t alloc_mark = 0;
+size_t frame_allocations = 0;
+
+/**
+ * Where a character sits in the glyph atlas.
+ * Glyphs are baked white and tinted with the text color when drawn.
+ */
+typedef struct glyph {
+  SDL_Rect source;
+  bool baked;
+} glyph_t;
+
+/**
+ * The HUD characters of one font, rendered once into a single texture
+ * so numbers can be drawn as quads without calling SDL_ttf every frame.
+ */
+typedef struct glyph_atlas {
+  TTF_Font *font;
+  SDL_Texture *texture;
+  int height;
+  glyph_t glyphs[GLYPH_COUNT];
+} glyph_atlas_t;
+glyph_atlas_t glyph_atlas;
+
+/**
+ * A rendered string, keyed by its font, color and contents.
+ * Used for text that cannot be composed from the glyph atlas.
+ */
+typedef struct text_cache_entry {
+  TTF_Font *font;
+  SDL_Color color;
+  char string[TEXT_LENGTH];
+  SDL_Texture *texture;
+  size_t last_used;
+} text_cache_entry_t;
+text_cache_entry_t text_cache[TEXT_CACHE_SIZE];
+size_t text_cache_clock = 0;
+
+/**
+ * A HUD text container: the rectangle a string is stretched to fill,
+ * and the font and color it is drawn with.
+ */
+typedef struct text {
+  SDL_Rect container;
+  TTF_Font *font;
+  SDL_Color color;
+} text_t;
+/**
+ * The HUD text containers, in the order of the HUD indexes scenes store.
+ */
+list_t *texts = NULL;
+
+/**
+ * The last value shown by a HUD text container.
+ * The string is only reformatted when the value changes.
+ */
+typedef struct hud_line {
+  text_t *text;
+  long value;
+  char string[TEXT_LENGTH];
+} hud_line_t;
+hud_line_t hud_lines[HUD_MAX_LINES];
+size_t num_hud_lines = 0;
+
+/**
+ * An image asset. Loader threads decode it into a surface,
+ * then the main thread uploads it into a texture once.
+ * The texture is NULL until the image is ready to draw.
+ */
+typedef struct image {
+  SDL_Surface *surface;
+  SDL_Texture *texture;
+  // the part of the texture the image covers
+  SDL_Rect source;
+  bool failed;
+} image_t;
+image_t images[NUM_IMAGES];
+/**
+ * Textures of the asset pack's pages, shared by the images on them.
+ * Empty if the images were decoded from their files instead.
+ */
+SDL_Texture *page_textures[NUM_IMAGES];
+size_t num_page_textures = 0;
+
+/**
+ * Shared between the loader threads and the main thread; guarded by image_lock.
+ * Loaders take images from IMAGE_LOAD_ORDER starting at next_image_load
+ * and append each decoded image to the completion queue,
+ * which the main thread drains from decoded_head.
+ */
+SDL_mutex *image_lock = NULL;
+SDL_Thread *image_loaders[NUM_IMAGE_LOADERS];
+size_t next_image_load = 0;
+size_t decoded_images[NUM_IMAGES];
+size_t decoded_tail = 0;
+size_t decoded_head = 0;
+bool image_loading_cancelled = false;
 
 /** Computes the center of the window in pixel coordinates */
 vector_t get_window_center(void) {
-  int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-  assert(width != NULL);
-  assert(height != NULL);
-  SDL_GetWindowSize(window, width, height);
-  vector_t dimensions = {.x = *width, .y = *height};
-  free(width);
-  free(height);
+  int width, height;
+  SDL_GetWindowSize(window, &width, &height);
+  vector_t dimensions = {.x = width, .y = height};
   return vec_multiply(0.5, dimensions);
 }
 
@@ -113,8 +279,341 @@ char get_keycode(SDL_Keycode key) {
   }
 }
 
+/**
+ * Renders each HUD character of a font once and packs them side by side
+ * into the glyph atlas texture.
+ */
+void glyph_atlas_bake(TTF_Font *font) {
+  SDL_Color white = {255, 255, 255, 255};
+  size_t num_chars = strlen(GLYPH_ATLAS_CHARS);
+  SDL_Surface *glyph_surfaces[GLYPH_COUNT];
+  int atlas_width = 0;
+  glyph_atlas.font = font;
+  glyph_atlas.height = TTF_FontHeight(font);
+  for (size_t i = 0; i < num_chars; i++) {
+    unsigned char c = GLYPH_ATLAS_CHARS[i];
+    glyph_surfaces[i] = TTF_RenderGlyph_Blended(font, c, white);
+    if (glyph_surfaces[i] == NULL) {
+      continue;
+    }
+    glyph_atlas.glyphs[c] = (glyph_t){
+        .source = {atlas_width, 0, glyph_surfaces[i]->w, glyph_surfaces[i]->h},
+        .baked = true};
+    atlas_width += glyph_surfaces[i]->w;
+  }
+
+  SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(
+      0, atlas_width, glyph_atlas.height, 32, SDL_PIXELFORMAT_RGBA32);
+  assert(atlas != NULL);
+  for (size_t i = 0; i < num_chars; i++) {
+    if (glyph_surfaces[i] == NULL) {
+      continue;
+    }
+    unsigned char c = GLYPH_ATLAS_CHARS[i];
+    // copy the glyph's alpha as-is instead of blending it onto the atlas
+    SDL_SetSurfaceBlendMode(glyph_surfaces[i], SDL_BLENDMODE_NONE);
+    SDL_BlitSurface(glyph_surfaces[i], NULL, atlas,
+                    &glyph_atlas.glyphs[c].source);
+    SDL_FreeSurface(glyph_surfaces[i]);
+  }
+  glyph_atlas.texture = SDL_CreateTextureFromSurface(renderer, atlas);
+  assert(glyph_atlas.texture != NULL);
+  SDL_SetTextureBlendMode(glyph_atlas.texture, SDL_BLENDMODE_BLEND);
+  SDL_FreeSurface(atlas);
+}
+
+/** Returns whether a string can be drawn entirely from the glyph atlas */
+bool glyph_atlas_has(TTF_Font *font, const char *string) {
+  if (font != glyph_atlas.font || glyph_atlas.texture == NULL) {
+    return false;
+  }
+  for (const char *c = string; *c != '\0'; c++) {
+    if ((unsigned char)*c >= GLYPH_COUNT ||
+        !glyph_atlas.glyphs[(unsigned char)*c].baked) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Draws a string from atlas quads, stretched to fill the container
+ * the same way a single rendered texture would be.
+ */
+void glyph_atlas_draw(const char *string, SDL_Color color, SDL_Rect container) {
+  int natural_width = 0;
+  for (const char *c = string; *c != '\0'; c++) {
+    natural_width += glyph_atlas.glyphs[(unsigned char)*c].source.w;
+  }
+  if (natural_width == 0) {
+    return;
+  }
+  double x_scale = (double)container.w / natural_width;
+  SDL_SetTextureColorMod(glyph_atlas.texture, color.r, color.g, color.b);
+  int pen = 0;
+  for (const char *c = string; *c != '\0'; c++) {
+    SDL_Rect source = glyph_atlas.glyphs[(unsigned char)*c].source;
+    // round both edges so neighbouring quads never leave gaps
+    int left = container.x + (int)round(pen * x_scale);
+    int right = container.x + (int)round((pen + source.w) * x_scale);
+    SDL_Rect quad = {left, container.y, right - left, container.h};
+    SDL_RenderCopy(renderer, glyph_atlas.texture, &source, &quad);
+    pen += source.w;
+  }
+}
+
+/**
+ * Returns a texture for a string, rendering it only if the same font,
+ * color and contents are not already cached.
+ * The least recently used entry is replaced on a miss.
+ */
+SDL_Texture *text_cache_get(TTF_Font *font, SDL_Color color,
+                            const char *string) {
+  text_cache_clock++;
+  text_cache_entry_t *victim = &text_cache[0];
+  for (size_t i = 0; i < TEXT_CACHE_SIZE; i++) {
+    text_cache_entry_t *entry = &text_cache[i];
+    if (entry->texture != NULL && entry->font == font &&
+        entry->color.r == color.r && entry->color.g == color.g &&
+        entry->color.b == color.b && strcmp(entry->string, string) == 0) {
+      entry->last_used = text_cache_clock;
+      return entry->texture;
+    }
+    if (entry->last_used < victim->last_used) {
+      victim = entry;
+    }
+  }
+
+  SDL_Surface *surface = TTF_RenderText_Solid(font, string, color);
+  if (surface == NULL) {
+    return NULL;
+  }
+  if (victim->texture != NULL) {
+    SDL_DestroyTexture(victim->texture);
+  }
+  victim->texture = SDL_CreateTextureFromSurface(renderer, surface);
+  SDL_FreeSurface(surface);
+  victim->font = font;
+  victim->color = color;
+  snprintf(victim->string, TEXT_LENGTH, "%s", string);
+  victim->last_used = text_cache_clock;
+  return victim->texture;
+}
+
+/** Draws a string stretched to fill a text's container */
+void sdl_draw_text(text_t *text, const char *string) {
+  SDL_Rect container = text->container;
+  TTF_Font *font = text->font;
+  SDL_Color color = text->color;
+  if (glyph_atlas_has(font, string)) {
+    glyph_atlas_draw(string, color, container);
+    return;
+  }
+  SDL_Texture *texture = text_cache_get(font, color, string);
+  if (texture != NULL) {
+    SDL_RenderCopy(renderer, texture, NULL, &container);
+  }
+}
+
+/**
+ * Returns the string a HUD text should show for a value,
+ * formatting it again only when the value differs from the last frame.
+ */
+const char *hud_line_string(text_t *text, const char *format, long value) {
+  hud_line_t *line = NULL;
+  for (size_t i = 0; i < num_hud_lines; i++) {
+    if (hud_lines[i].text == text) {
+      line = &hud_lines[i];
+      break;
+    }
+  }
+  if (line == NULL) {
+    assert(num_hud_lines < HUD_MAX_LINES);
+    line = &hud_lines[num_hud_lines++];
+    line->text = text;
+  } else if (line->value == value) {
+    return line->string;
+  }
+  line->value = value;
+  snprintf(line->string, TEXT_LENGTH, format, value);
+  return line->string;
+}
+
+/**
+ * Decodes the next image in the load order, if any are left.
+ * Returns false once every image has been taken.
+ */
+bool image_load_next(void) {
+  SDL_LockMutex(image_lock);
+  if (image_loading_cancelled || next_image_load == NUM_IMAGES) {
+    SDL_UnlockMutex(image_lock);
+    return false;
+  }
+  size_t image = IMAGE_LOAD_ORDER[next_image_load++];
+  SDL_UnlockMutex(image_lock);
+
+  SDL_Surface *surface = IMG_Load(IMAGE_PATHS[image]);
+
+  SDL_LockMutex(image_lock);
+  images[image].surface = surface;
+  images[image].failed = surface == NULL;
+  decoded_images[decoded_tail++] = image;
+  SDL_UnlockMutex(image_lock);
+  return true;
+}
+
+/** Loader thread: decodes images until none are left */
+int image_loader(void *data) {
+  while (image_load_next()) {
+  }
+  return 0;
+}
+
+/**
+ * Whether a pack holds the images of IMAGE_PATHS, in the same order.
+ */
+bool images_match_pack(asset_pack_t *pack) {
+  if (asset_pack_num_images(pack) != NUM_IMAGES ||
+      asset_pack_num_pages(pack) > NUM_IMAGES) {
+    return false;
+  }
+  for (size_t i = 0; i < NUM_IMAGES; i++) {
+    if (strcmp(asset_pack_get_image(pack, i).name, IMAGE_PATHS[i]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Creates every image's texture straight from the pixels of an asset pack.
+ * Returns false, creating nothing, if the pack does not match IMAGE_PATHS.
+ */
+bool images_load_pack(asset_pack_t *pack) {
+  if (!images_match_pack(pack)) {
+    fprintf(stderr, "%s is out of date, run \"make pack\"\n", IMAGE_PACK_PATH);
+    return false;
+  }
+  for (size_t i = 0; i < asset_pack_num_pages(pack); i++) {
+    asset_page_t page = asset_pack_get_page(pack, i);
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(
+        (void *)page.pixels, page.width, page.height,
+        8 * ASSET_PACK_BYTES_PER_PIXEL, page.width * ASSET_PACK_BYTES_PER_PIXEL,
+        SDL_PIXELFORMAT_RGBA32);
+    assert(surface != NULL);
+    page_textures[num_page_textures++] =
+        SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+  }
+  for (size_t i = 0; i < NUM_IMAGES; i++) {
+    asset_image_t image = asset_pack_get_image(pack, i);
+    images[i].texture = page_textures[image.page];
+    images[i].source =
+        (SDL_Rect){image.x, image.y, image.width, image.height};
+  }
+  return true;
+}
+
+/**
+ * Starts decoding every image in the background.
+ * Without threads (the web build), images are decoded one per frame instead.
+ */
+void images_start_loading(void) {
+  image_lock = SDL_CreateMutex();
+  assert(image_lock != NULL);
+
+  // a prebaked pack needs no decoding, so it is used whenever it is present
+  asset_pack_t *pack = asset_pack_open(IMAGE_PACK_PATH);
+  if (pack != NULL) {
+    bool loaded = images_load_pack(pack);
+    // the textures hold their own copy of the pixels
+    asset_pack_close(pack);
+    if (loaded) {
+      next_image_load = NUM_IMAGES;
+      return;
+    }
+  }
+#ifndef __EMSCRIPTEN__
+  for (size_t i = 0; i < NUM_IMAGE_LOADERS; i++) {
+    image_loaders[i] = SDL_CreateThread(image_loader, "image_loader", NULL);
+    if (image_loaders[i] == NULL) {
+      fprintf(stderr, "failed to start image loader: %s\n", SDL_GetError());
+    }
+  }
+#endif
+}
+
+/**
+ * Turns the images decoded since the last call into textures.
+ * Must be called on the main thread, since it uses the renderer.
+ */
+void images_poll(void) {
+#ifdef __EMSCRIPTEN__
+  image_load_next();
+#else
+  // fall back to loading on this thread if no loader could be started
+  if (image_loaders[0] == NULL) {
+    image_load_next();
+  }
+#endif
+  SDL_LockMutex(image_lock);
+  size_t tail = decoded_tail;
+  SDL_UnlockMutex(image_lock);
+  for (; decoded_head < tail; decoded_head++) {
+    image_t *image = &images[decoded_images[decoded_head]];
+    if (image->failed) {
+      fprintf(stderr, "failed to load image %s: %s\n",
+              IMAGE_PATHS[decoded_images[decoded_head]], IMG_GetError());
+      continue;
+    }
+    image->texture = SDL_CreateTextureFromSurface(renderer, image->surface);
+    image->source = (SDL_Rect){0, 0, image->surface->w, image->surface->h};
+    SDL_FreeSurface(image->surface);
+    image->surface = NULL;
+  }
+}
+
+/** Stops the loader threads and releases every image */
+void images_free(void) {
+  SDL_LockMutex(image_lock);
+  image_loading_cancelled = true;
+  SDL_UnlockMutex(image_lock);
+  for (size_t i = 0; i < NUM_IMAGE_LOADERS; i++) {
+    if (image_loaders[i] != NULL) {
+      SDL_WaitThread(image_loaders[i], NULL);
+      image_loaders[i] = NULL;
+    }
+  }
+  for (size_t i = 0; i < NUM_IMAGES; i++) {
+    if (images[i].surface != NULL) {
+      SDL_FreeSurface(images[i].surface);
+    }
+    // textures of packed images belong to their pages
+    if (images[i].texture != NULL && num_page_textures == 0) {
+      SDL_DestroyTexture(images[i].texture);
+    }
+    images[i] = (image_t){0};
+  }
+  for (size_t i = 0; i < num_page_textures; i++) {
+    SDL_DestroyTexture(page_textures[i]);
+  }
+  num_page_textures = 0;
+  SDL_DestroyMutex(image_lock);
+  image_lock = NULL;
+}
+
+/** Adds a HUD text container with its top left corner at (x, y) */
+void add_text(int x, int y, int length, int width, TTF_Font *font,
+              SDL_Color color) {
+  text_t *text = malloc(sizeof(text_t));
+  assert(text != NULL);
+  *text = (text_t){
+      .container = {x, y, length, width}, .font = font, .color = color};
+  list_add(texts, text);
+}
+
 /*Initializes all surfaces, music, fonts, and window*/
-void sdl_init(vector_t min, vector_t max, list_t *loaded_surfaces, list_t *fonts) {
+void sdl_init(vector_t min, vector_t max) {
   int w = 10;
   int h = 20; 
 
@@ -124,6 +623,20 @@ void sdl_init(vector_t min, vector_t max, list_t *loaded_surfaces, list_t *fonts
 
   center = vec_multiply(0.5, vec_add(min, max));
   max_diff = vec_subtract(max, center);
+
+  seed = time(NULL);
+  const char *record_path = getenv(RECORD_ENV);
+  if (record_path != NULL) {
+    recording = replay_writer_init(record_path, seed);
+    if (recording == NULL) {
+      fprintf(stderr, "failed to create recording %s\n", record_path);
+    }
+  }
+
+  if (getenv(CHECK_ALLOCS_ENV) != NULL) {
+    alloc_track_enable();
+  }
+
   SDL_Init(SDL_INIT_EVERYTHING);
   window = SDL_CreateWindow(WINDOW_TITLE, SDL_WINDOWPOS_CENTERED,
                             SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT,
@@ -134,127 +647,74 @@ void sdl_init(vector_t min, vector_t max, list_t *loaded_surfaces, list_t *fonts
   //// Music initialization
   if(Mix_OpenAudio( 22050, MIX_DEFAULT_FORMAT, 2, 4096 ) == -1 ) 
     fprintf(stderr, "\n failed to open audio \n"); 
+  else
+    audio_init();
 
   //// Image initialization
   SDL_Rect texr; texr.x = WIDTH/2; texr.y = HEIGHT/2; texr.w = w*2; texr.h = h*2; 
 
   IMG_Init(IMG_INIT_PNG);
 
-  // create beaver surface
-  SDL_Surface *surface =  IMG_Load( "assets/beaver.png");
-  list_add(loaded_surfaces, surface);
-
-  // create ground surface
-  surface =  IMG_Load( "assets/ground.png");
-  list_add(loaded_surfaces, surface);
-
-  // create water surface
-  surface =  IMG_Load( "assets/water.png");
-  list_add(loaded_surfaces, surface);
-
-  // create sky surface
-  surface =  IMG_Load( "assets/space.png");
-  list_add(loaded_surfaces, surface); 
-
-  // create welcome page
-  surface =  IMG_Load( "assets/welcome.png");
-  list_add(loaded_surfaces, surface); 
-
-  // create gameplay page
-  surface =  IMG_Load( "assets/gameplay.png");
-  list_add(loaded_surfaces, surface); 
-
-  // create transition page for level 1
-  surface =  IMG_Load( "assets/transition1.png");
-  list_add(loaded_surfaces, surface); 
-
-  // create transition page for level 2
-  surface =  IMG_Load( "assets/transition2.png");
-  list_add(loaded_surfaces, surface); 
-
-  // create ending page
-  surface =  IMG_Load( "assets/endgame.png");
-  list_add(loaded_surfaces, surface); 
-
-  // create lose game page
-  surface =  IMG_Load( "assets/losegame.png");
-  list_add(loaded_surfaces, surface); 
-
-
-  // coin
-  surface =  IMG_Load( "assets/coin.png");
-  list_add(loaded_surfaces, surface); 
-
-  // power-ups
-  surface =  IMG_Load( "assets/boba.png");
-  list_add(loaded_surfaces, surface); 
-  surface =  IMG_Load( "assets/coffee.png");
-  list_add(loaded_surfaces, surface); 
-  surface =  IMG_Load( "assets/ice_cube.png");
-  list_add(loaded_surfaces, surface); 
-  surface =  IMG_Load( "assets/job_offer.png");
-  list_add(loaded_surfaces, surface); 
-
-  // enemies
-  surface =  IMG_Load( "assets/crow.png");
-  list_add(loaded_surfaces, surface);
-  surface =  IMG_Load( "assets/deadline.png");
-  list_add(loaded_surfaces, surface); 
-  surface =  IMG_Load( "assets/shark.png");
-  list_add(loaded_surfaces, surface); 
-  surface =  IMG_Load( "assets/trash.png");
-  list_add(loaded_surfaces, surface); 
+  // decode images in the background so the first frame is not held up
+  images_start_loading();
 
   // Text initialization
   TTF_Init();
 
   // Text colors
   // black
-  SDL_Color black = {0, 0, 0};
+  SDL_Color black = {0, 0, 0, 255};
   // white
-  SDL_Color white = {255, 255, 255};
+  SDL_Color white = {255, 255, 255, 255};
 
   //Fonts for score and lives for ground
-  TTF_Font* Sans = TTF_OpenFont("assets/OpenSans.ttf", 10);
+  TTF_Font* Sans = TTF_OpenFont(HUD_FONT_PATH, HUD_FONT_SIZE);
   assert(Sans != NULL);
-  
-  text_t *text = text_init(150,50, (vector_t) {.x = 10, .y = 10},(void *)Sans, black);
-  list_add(fonts, text);
-  
-  text = text_init(80,50,(vector_t) {.x = 10, .y = 50}, (void *)Sans, black);
-  list_add(fonts, text);
+  glyph_atlas_bake(Sans);
+  texts = list_init(NUM_TEXTS, free);
+
+  add_text(10, 10, 150, 50, Sans, black);
+  add_text(10, 50, 80, 50, Sans, black);
 
   //Fonts for score and lives for water
-  text = text_init(150,50,(vector_t) {.x = 10, .y = 10}, (void *)Sans, black);
-  list_add(fonts, text);
-  
-  text = text_init(80,50,(vector_t) {.x = 10, .y = 50}, (void *)Sans, black);
-  list_add(fonts, text);
+  add_text(10, 10, 150, 50, Sans, black);
+  add_text(10, 50, 80, 50, Sans, black);
 
   //Fonts for score and lives for sky
-  text = text_init(150,50,(vector_t) {.x = 10, .y = 10}, (void *)Sans, white);
-  list_add(fonts, text);
-  
-  text = text_init(80,50,(vector_t) {.x = 10, .y = 50}, (void *)Sans, white);
-  list_add(fonts, text);
-  
+  add_text(10, 10, 150, 50, Sans, white);
+  add_text(10, 50, 80, 50, Sans, white);
+
   //Fonts for score and lives for transition
-  text = text_init(200,100,(vector_t) {.x = 210, .y = 180}, (void *)Sans, black);
-  list_add(fonts, text);
+  add_text(210, 180, 200, 100, Sans, black);
 
   //Fonts for score and lives for endgame and lost game
-  text = text_init(200,100,(vector_t) {.x = 430, .y = 250}, (void *)Sans, black);
-  list_add(fonts, text);
+  add_text(430, 250, 200, 100, Sans, black);
 }
 
+unsigned sdl_seed(void) { return seed; }
+
 bool sdl_is_done(state_t *state) {
-  SDL_Event *event = malloc(sizeof(*event));
-  assert(event != NULL);
+  // the demo checks again after the frame, so closing must stick
+  if (quit) {
+    return true;
+  }
+  SDL_Event event_storage;
+  SDL_Event *event = &event_storage;
   while (SDL_PollEvent(event)) {
     switch (event->type) {
     case SDL_QUIT:
-      free(event);
+      quit = true;
+      if (recording != NULL) {
+        replay_writer_free(recording, frames_shown);
+        recording = NULL;
+      }
+      images_free();
+      audio_free();
       Mix_CloseAudio();
+      list_free(texts);
+      free(polygon_x_points);
+      free(polygon_y_points);
+      TTF_CloseFont(glyph_atlas.font);
       return true;
     case SDL_KEYDOWN:
     case SDL_KEYUP:
@@ -274,11 +734,13 @@ bool sdl_is_done(state_t *state) {
       key_event_type_t type =
           event->type == SDL_KEYDOWN ? KEY_PRESSED : KEY_RELEASED;
       double held_time = (timestamp - key_start_timestamp) / MS_PER_S;
+      if (recording != NULL) {
+        replay_write_key(recording, frames_shown, key, type, held_time);
+      }
       key_handler(key, type, held_time, state);
       break;
     }
   }
-  free(event);
   return false;
 }
 
@@ -298,10 +760,16 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
   vector_t window_center = get_window_center();
 
   // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
+  if (n > polygon_capacity) {
+    polygon_capacity = n;
+    int16_t *x_points = realloc(polygon_x_points, sizeof(int16_t) * n),
+            *y_points = realloc(polygon_y_points, sizeof(int16_t) * n);
+    assert(x_points != NULL);
+    assert(y_points != NULL);
+    polygon_x_points = x_points;
+    polygon_y_points = y_points;
+  }
+  int16_t *x_points = polygon_x_points, *y_points = polygon_y_points;
   for (size_t i = 0; i < n; i++) {
     vector_t *vertex = list_get(points, i);
     vector_t pixel = get_window_position(*vertex, window_center);
@@ -312,155 +780,112 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
   // Draw polygon with the given color
   filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
                     color.g * 255, color.b * 255, 255);
-  free(x_points);
-  free(y_points);
+}
+
+/**
+ * Fails if a scene that has been shown for ALLOC_WARMUP_FRAMES frames
+ * allocated during this frame's physics or render phase.
+ */
+void check_frame_allocations(void) {
+  if (steady_frames >= ALLOC_WARMUP_FRAMES && frame_allocations > 0) {
+    fprintf(stderr, "frame %zu allocated %zu times outside the logic phase\n",
+            frames_shown, frame_allocations);
+    alloc_track_print();
+    assert(frame_allocations == 0);
+  }
+  frame_allocations = 0;
+  steady_frames++;
 }
 
 void sdl_show(void) {
-  // Draw boundary lines
-  vector_t window_center = get_window_center();
-  vector_t max = vec_add(center, max_diff),
-           min = vec_subtract(center, max_diff);
-  vector_t max_pixel = get_window_position(max, window_center),
-           min_pixel = get_window_position(min, window_center);
-  SDL_Rect *boundary = malloc(sizeof(*boundary));
-  boundary->x = min_pixel.x;
-  boundary->y = max_pixel.y;
-  boundary->w = max_pixel.x - min_pixel.x;
-  boundary->h = min_pixel.y - max_pixel.y;
   SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-  free(boundary);
-
   SDL_RenderPresent(renderer);
+  if (alloc_track_enabled()) {
+    sdl_begin_phase(PHASE_LOGIC);
+    check_frame_allocations();
+  }
+  frames_shown++;
 }
 
-void sdl_render_scene(scene_t *scene, double dt) 
+void sdl_render_scene(scene_t *scene) 
 {
+  if (scene != steady_scene) {
+    steady_scene = scene;
+    steady_frames = 0;
+  }
 
-  sdl_clear();
-  scene_tick(scene, dt);
 
-  Mix_Music *music = NULL;
-  music = Mix_LoadMUS("assets/life.wav");
+  sdl_clear();
 
   // If music is not playing, play music
-  if ( !Mix_PlayingMusic())
-  {  
-    if (music == NULL)
-      fprintf(stderr, "\n music path is empty\n");
-    Mix_PlayMusic( music, -1);
-  }
-
-  // Free music chunks
-  else if (music != NULL)
+  if (!audio_music_playing())
   {
-    // clean up our resources
-    Mix_FreeMusic(music);
-    
+    audio_play_music();
   }
 
-  int bodies = scene_bodies(scene);
-  
-  list_t *surfaces = scene_get_surfaces(scene);
-
-// draw all the bodies
-  for (int i = 0; i <bodies; i++) {
-    // do not draw the beaver for transition level
-    if (bodies == 2 && i == 1){
-      break;
+  images_poll();
+
+  // only bodies that can reach the window are drawn; RENDER_INTERVAL leaves
+  // room for pictures that are wider than their body's shape
+  vector_t view_min = vec_subtract(center, max_diff),
+           view_max = vec_add(center, max_diff);
+  aabb_t view = {.min = {view_min.x - RENDER_INTERVAL, view_min.y},
+                 .max = {view_max.x + RENDER_INTERVAL, view_max.y}};
+  // do not draw the beaver for transition level
+  body_t *hidden = scene_bodies(scene) == 2 ? scene_get_body(scene, 1) : NULL;
+
+  // draw the visible bodies
+  list_t *visible = scene_bodies_in_bounds(scene, view);
+  for (size_t i = 0; i < list_size(visible); i++) {
+    body_t *body = list_get(visible, i);
+    if (body == hidden) {
+      continue;
     }
-
-    body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
-
     picture_t *picture = body_get_picture(body);
-    vector_t pos = body_get_centroid(body);
-
 
     // If no picture data saved, render as polygon
-    if (picture == NULL && (pos.x < WINDOW_WIDTH + RENDER_INTERVAL && pos.x > -RENDER_INTERVAL))
+    if (picture == NULL)
     {
-      sdl_draw_polygon(shape, body_get_color(body));
+      sdl_draw_polygon(body_borrow_shape(body), body_get_color(body));
     }
 
     //Rendering photos
-    else if ((pos.x < WINDOW_WIDTH + RENDER_INTERVAL && pos.x > -RENDER_INTERVAL))
+    else
     {
+      vector_t pos = body_get_centroid(body);
       size_t pic_l = pic_length(picture);
       size_t pic_w = pic_width(picture);
 
       // the position of the picture is the position of the lower corner
       SDL_Rect img_container = {pos.x - pic_l/2, WINDOW_HEIGHT - (pos.y + pic_w/2), pic_l, pic_w};
 
-      SDL_RenderCopy(renderer, SDL_CreateTextureFromSurface(renderer, list_get(surfaces, pic_index(picture))), NULL, &img_container);
-	    
-    }
-
-    // delete body if out of scene
-    vector_t add = body_get_centroid(body);
-    if (add.x < REMOVE_X_POSITION)
-    {
-      body_remove(body);
+      // images that are still loading are skipped until they are ready
+      image_t *image = &images[pic_index(picture)];
+      if (image->texture != NULL)
+      {
+        SDL_RenderCopy(renderer, image->texture, &image->source, &img_container);
+      }
     }
-
-    list_free(shape);
   }
 
-
   // showing text for all scenes 
-  if (scene_get_fonts(scene) != NULL)
+  if (scene_get_font_indexs(scene) != NULL)
   {
-
     for(size_t i = 0; i<list_size(scene_get_font_indexs(scene)); i++)
     {
-
-      const char *context_string = malloc(sizeof(char)*20);
-
+      text_t *text = (text_t*)list_get(texts, *((size_t*)(list_get(scene_get_font_indexs(scene),i))));
+      const char *context_string;
       if (i == 0)
       {
-        // converting score from int to string
-        sprintf(context_string, "Score : %zu", (int)scene_get_score(scene));
-
+        context_string = hud_line_string(text, "Score : %ld", (int)scene_get_score(scene));
       }
       else
       {
-        // converting lives from int to string
-        sprintf(context_string, "Live: %zu", body_get_lives(scene_get_body(scene, 1)));
-
+        context_string = hud_line_string(text, "Live: %ld", body_get_lives(scene_get_body(scene, 1)));
       }
-
-      // rendering text
-      text_t *text = (text_t*)list_get(scene_get_fonts(scene), *((size_t*)(list_get(scene_get_font_indexs(scene),i))));
-      
-      SDL_Surface* surfaceMessage =
-          TTF_RenderText_Solid((TTF_Font*)text_get_font(text), context_string, (SDL_Color)text_get_color(text)); 
-
-      if (surfaceMessage >=0 && renderer!=NULL)
-      {
-        // now you can convert it into a texture
-        SDL_Texture* Message = SDL_CreateTextureFromSurface(renderer, surfaceMessage);
-
-        assert(Message != NULL);
-        
-        SDL_Rect Message_rect; //create a rect
-        vector_t text_center = text_get_center(text);
-        Message_rect.x = text_center.x;  //controls the rect's x coordinate 
-        Message_rect.y = text_center.y; // controls the rect's y coordinte
-
-        Message_rect.w = text_get_length(text); // controls the width of the rect
-
-        Message_rect.h = text_get_width(text); // controls the height of the rect
-
-        SDL_RenderCopy(renderer, Message, NULL, &Message_rect);
-
-        SDL_FreeSurface(surfaceMessage);
-        SDL_DestroyTexture(Message);
-      }
-
-      free(context_string);
+      sdl_draw_text(text, context_string);
     }
   }
-  sdl_show();
 }
 
 
@@ -472,5 +897,22 @@ double time_since_last_tick(void) {
                           ? (double)(now - last_clock) / CLOCKS_PER_SEC
                           : 0.0; // return 0 the first time this is called
   last_clock = now;
+  if (recording != NULL) {
+    replay_write_tick(recording, frames_shown, difference);
+  }
   return difference;
 }
+
+// frames are only timed when replaying headless, but their allocations
+// are counted when BEAVER_CHECK_ALLOCS is set
+void sdl_begin_phase(frame_phase_t next_phase) {
+  if (!alloc_track_enabled()) {
+    return;
+  }
+  size_t total = alloc_track_total();
+  if (phase == PHASE_PHYSICS || phase == PHASE_RENDER) {
+    frame_allocations += total - alloc_mark;
+  }
+  alloc_mark = total;
+  phase = next_phase;
+}
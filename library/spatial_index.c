@@ -0,0 +1,447 @@
+#include "spatial_index.h"
+#include "list.h"
+#include "polygon.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALLOC_SUBSYSTEM ALLOC_SCENE
+#include "alloc_track.h"
+
+// must be a power of 2 so the hash can be masked instead of divided
+const size_t INITIAL_CELL_SLOTS = 64;
+const size_t INITIAL_ENTRY_CAPACITY = 64;
+const size_t INITIAL_REF_CAPACITY = 128;
+
+// the grid cells a box covers, inclusive
+typedef struct cell_range {
+  long x_min;
+  long x_max;
+  long y_min;
+  long y_max;
+} cell_range_t;
+
+// an empty range, for adding an entry to all of its cells
+const cell_range_t NO_CELLS = {.x_min = 1, .x_max = 0, .y_min = 1, .y_max = 0};
+
+// an inserted item, the cells it covers and the query it was last seen by
+typedef struct entry {
+  void *item;
+  aabb_t bounds;
+  cell_range_t cells;
+  size_t mark;
+} entry_t;
+
+// one grid cell, stored in an open-addressing hash table
+typedef struct cell {
+  long x;
+  long y;
+  // the cell is only in use when this matches the index's generation
+  size_t generation;
+  // position in the index's used cells
+  size_t id;
+  // the cell's entries are cell_entries[start, start + size)
+  size_t start;
+  size_t size;
+  size_t fill;
+} cell_t;
+
+// an entry covering a cell, recorded in insertion order
+typedef struct cell_ref {
+  size_t cell;
+  size_t entry;
+} cell_ref_t;
+
+typedef struct spatial_index {
+  double cell_size;
+  entry_t *entries;
+  size_t num_entries;
+  size_t entry_capacity;
+  cell_t *cells;
+  size_t num_slots;
+  // slots of the cells in use, so sparse grids can be walked directly
+  size_t *used;
+  size_t num_used;
+  // every cell's entries share one buffer, grouped by cell before a query,
+  // so its size depends on how many cells are covered and not on how
+  // crowded any one cell has ever been
+  cell_ref_t *refs;
+  size_t num_refs;
+  size_t ref_capacity;
+  // refs to cells an entry no longer covers are left behind by
+  // spatial_index_update() and skipped until the refs are compacted
+  size_t *cell_entries;
+  bool grouped;
+  // bumped by spatial_index_clear() to empty every cell at once
+  size_t generation;
+  size_t query_mark;
+  size_t *matches;
+  size_t match_capacity;
+  // union of the bounds of every inserted item
+  aabb_t extent;
+} spatial_index_t;
+
+cell_t *cells_init(size_t num_slots) {
+  cell_t *cells = calloc(num_slots, sizeof(cell_t));
+  assert(cells != NULL);
+  return cells;
+}
+
+spatial_index_t *spatial_index_init(double cell_size) {
+  assert(cell_size > 0);
+  spatial_index_t *index = malloc(sizeof(spatial_index_t));
+  assert(index != NULL);
+  index->cell_size = cell_size;
+  index->entries = malloc(INITIAL_ENTRY_CAPACITY * sizeof(entry_t));
+  assert(index->entries != NULL);
+  index->num_entries = 0;
+  index->entry_capacity = INITIAL_ENTRY_CAPACITY;
+  index->cells = cells_init(INITIAL_CELL_SLOTS);
+  index->num_slots = INITIAL_CELL_SLOTS;
+  index->used = malloc(INITIAL_CELL_SLOTS * sizeof(size_t));
+  assert(index->used != NULL);
+  index->num_used = 0;
+  index->refs = malloc(INITIAL_REF_CAPACITY * sizeof(cell_ref_t));
+  assert(index->refs != NULL);
+  index->cell_entries = malloc(INITIAL_REF_CAPACITY * sizeof(size_t));
+  assert(index->cell_entries != NULL);
+  index->num_refs = 0;
+  index->ref_capacity = INITIAL_REF_CAPACITY;
+  index->grouped = true;
+  index->generation = 1;
+  index->query_mark = 0;
+  index->matches = malloc(INITIAL_ENTRY_CAPACITY * sizeof(size_t));
+  assert(index->matches != NULL);
+  index->match_capacity = INITIAL_ENTRY_CAPACITY;
+  return index;
+}
+
+void spatial_index_free(spatial_index_t *index) {
+  free(index->cells);
+  free(index->used);
+  free(index->entries);
+  free(index->refs);
+  free(index->cell_entries);
+  free(index->matches);
+  free(index);
+}
+
+void spatial_index_clear(spatial_index_t *index) {
+  index->num_entries = 0;
+  index->num_used = 0;
+  index->num_refs = 0;
+  index->grouped = true;
+  index->generation++;
+}
+
+size_t spatial_index_size(spatial_index_t *index) { return index->num_entries; }
+
+// maps a cell coordinate to its home slot in the hash table
+size_t cell_hash(spatial_index_t *index, long x, long y) {
+  uint64_t h = (uint64_t)x * 73856093u ^ (uint64_t)y * 19349663u;
+  h ^= h >> 17;
+  return (size_t)h & (index->num_slots - 1);
+}
+
+// finds the cell at (x, y), or NULL if no item covers it
+cell_t *cell_find(spatial_index_t *index, long x, long y) {
+  size_t slot = cell_hash(index, x, y);
+  while (index->cells[slot].generation == index->generation) {
+    cell_t *cell = &index->cells[slot];
+    if (cell->x == x && cell->y == y) {
+      return cell;
+    }
+    slot = (slot + 1) & (index->num_slots - 1);
+  }
+  return NULL;
+}
+
+// doubles the hash table, moving the cells in use and dropping stale ones
+void cells_grow(spatial_index_t *index) {
+  cell_t *old_cells = index->cells;
+  index->num_slots *= 2;
+  index->cells = cells_init(index->num_slots);
+  size_t *used = realloc(index->used, index->num_slots * sizeof(size_t));
+  assert(used != NULL);
+  index->used = used;
+  // walk the cells in use in order, so their ids stay the same
+  for (size_t i = 0; i < index->num_used; i++) {
+    cell_t *cell = &old_cells[index->used[i]];
+    size_t slot = cell_hash(index, cell->x, cell->y);
+    while (index->cells[slot].generation == index->generation) {
+      slot = (slot + 1) & (index->num_slots - 1);
+    }
+    index->cells[slot] = *cell;
+    index->used[i] = slot;
+  }
+  free(old_cells);
+}
+
+// finds the cell at (x, y), claiming an empty slot for it if needed
+cell_t *cell_find_or_add(spatial_index_t *index, long x, long y) {
+  cell_t *found = cell_find(index, x, y);
+  if (found != NULL) {
+    return found;
+  }
+  // keep the table at most half full so probe chains stay short
+  if (2 * (index->num_used + 1) > index->num_slots) {
+    cells_grow(index);
+  }
+  size_t slot = cell_hash(index, x, y);
+  while (index->cells[slot].generation == index->generation) {
+    slot = (slot + 1) & (index->num_slots - 1);
+  }
+  cell_t *cell = &index->cells[slot];
+  *cell = (cell_t){.x = x, .y = y, .generation = index->generation,
+                   .id = index->num_used};
+  index->used[index->num_used++] = slot;
+  return cell;
+}
+
+void refs_grow(spatial_index_t *index) {
+  index->ref_capacity *= 2;
+  cell_ref_t *refs =
+      realloc(index->refs, index->ref_capacity * sizeof(cell_ref_t));
+  assert(refs != NULL);
+  index->refs = refs;
+  size_t *cell_entries =
+      realloc(index->cell_entries, index->ref_capacity * sizeof(size_t));
+  assert(cell_entries != NULL);
+  index->cell_entries = cell_entries;
+}
+
+void cell_add_entry(spatial_index_t *index, cell_t *cell, size_t entry) {
+  if (index->num_refs == index->ref_capacity) {
+    refs_grow(index);
+  }
+  index->refs[index->num_refs++] = (cell_ref_t){.cell = cell->id,
+                                                .entry = entry};
+  cell->size++;
+  index->grouped = false;
+}
+
+// lays the cells' entries out one cell after another, keeping their order
+void cells_group(spatial_index_t *index) {
+  size_t start = 0;
+  for (size_t i = 0; i < index->num_used; i++) {
+    cell_t *cell = &index->cells[index->used[i]];
+    cell->start = start;
+    cell->fill = start;
+    start += cell->size;
+  }
+  for (size_t i = 0; i < index->num_refs; i++) {
+    cell_t *cell = &index->cells[index->used[index->refs[i].cell]];
+    index->cell_entries[cell->fill++] = index->refs[i].entry;
+  }
+  index->grouped = true;
+}
+
+long cell_coordinate(spatial_index_t *index, double position) {
+  return (long)floor(position / index->cell_size);
+}
+
+cell_range_t cell_range(spatial_index_t *index, aabb_t bounds) {
+  return (cell_range_t){.x_min = cell_coordinate(index, bounds.min.x),
+                        .x_max = cell_coordinate(index, bounds.max.x),
+                        .y_min = cell_coordinate(index, bounds.min.y),
+                        .y_max = cell_coordinate(index, bounds.max.y)};
+}
+
+bool range_contains(cell_range_t range, long x, long y) {
+  return x >= range.x_min && x <= range.x_max && y >= range.y_min &&
+         y <= range.y_max;
+}
+
+size_t range_size(cell_range_t range) {
+  return (size_t)(range.x_max - range.x_min + 1) *
+         (size_t)(range.y_max - range.y_min + 1);
+}
+
+void extent_add(spatial_index_t *index, aabb_t bounds) {
+  index->extent.min.x = fmin(index->extent.min.x, bounds.min.x);
+  index->extent.min.y = fmin(index->extent.min.y, bounds.min.y);
+  index->extent.max.x = fmax(index->extent.max.x, bounds.max.x);
+  index->extent.max.y = fmax(index->extent.max.y, bounds.max.y);
+}
+
+// adds an entry to the cells of its range that are not in skipped
+void entry_add_refs(spatial_index_t *index, size_t entry,
+                    cell_range_t skipped) {
+  cell_range_t range = index->entries[entry].cells;
+  for (long x = range.x_min; x <= range.x_max; x++) {
+    for (long y = range.y_min; y <= range.y_max; y++) {
+      if (!range_contains(skipped, x, y)) {
+        cell_add_entry(index, cell_find_or_add(index, x, y), entry);
+      }
+    }
+  }
+}
+
+// keeps the refs at most half full and the cells at most a quarter full,
+// so moving entries have room for as many refs and cells again as are in
+// use before spatial_index_update() has to compact them
+void buffers_reserve(spatial_index_t *index) {
+  while (index->ref_capacity < 2 * index->num_refs) {
+    refs_grow(index);
+  }
+  while (index->num_slots < 4 * index->num_used) {
+    cells_grow(index);
+  }
+}
+
+// lays every entry out in the cells again, dropping the refs left behind
+// by moved entries and the cells no entry covers any more
+void refs_compact(spatial_index_t *index) {
+  index->num_used = 0;
+  index->num_refs = 0;
+  index->generation++;
+  index->extent = index->entries[0].bounds;
+  for (size_t i = 0; i < index->num_entries; i++) {
+    extent_add(index, index->entries[i].bounds);
+    entry_add_refs(index, i, NO_CELLS);
+  }
+  buffers_reserve(index);
+}
+
+void assert_bounds_finite(aabb_t bounds) {
+  assert(isfinite(bounds.min.x) && isfinite(bounds.min.y));
+  assert(isfinite(bounds.max.x) && isfinite(bounds.max.y));
+}
+
+void spatial_index_insert(spatial_index_t *index, void *item, aabb_t bounds) {
+  assert(item != NULL);
+  assert_bounds_finite(bounds);
+  if (index->num_entries == index->entry_capacity) {
+    index->entry_capacity *= 2;
+    entry_t *entries =
+        realloc(index->entries, index->entry_capacity * sizeof(entry_t));
+    assert(entries != NULL);
+    index->entries = entries;
+  }
+  size_t entry = index->num_entries++;
+  cell_range_t cells = cell_range(index, bounds);
+  index->entries[entry] =
+      (entry_t){.item = item, .bounds = bounds, .cells = cells, .mark = 0};
+
+  if (entry == 0) {
+    index->extent = bounds;
+  } else {
+    extent_add(index, bounds);
+  }
+  entry_add_refs(index, entry, NO_CELLS);
+  buffers_reserve(index);
+}
+
+void spatial_index_update(spatial_index_t *index, size_t position,
+                          aabb_t bounds) {
+  assert(position < index->num_entries);
+  assert_bounds_finite(bounds);
+  entry_t *entry = &index->entries[position];
+  if (entry->bounds.min.x == bounds.min.x &&
+      entry->bounds.min.y == bounds.min.y &&
+      entry->bounds.max.x == bounds.max.x &&
+      entry->bounds.max.y == bounds.max.y) {
+    return;
+  }
+  entry->bounds = bounds;
+  // the extent only grows until the refs are compacted, which keeps it
+  // a bound on every item
+  extent_add(index, bounds);
+  cell_range_t old_cells = entry->cells;
+  cell_range_t cells = cell_range(index, bounds);
+  if (memcmp(&old_cells, &cells, sizeof(cell_range_t)) == 0) {
+    return;
+  }
+  entry->cells = cells;
+  // compact rather than grow the buffers for the cells the entry enters,
+  // so items that keep moving allocate nothing
+  size_t num_added = range_size(cells);
+  if (index->num_refs + num_added > index->ref_capacity ||
+      2 * (index->num_used + num_added) > index->num_slots) {
+    refs_compact(index);
+  } else {
+    entry_add_refs(index, position, old_cells);
+  }
+}
+
+// records a matching entry the first time the current query sees it
+void query_cell(spatial_index_t *index, cell_t *cell, aabb_t box,
+                size_t *num_matches) {
+  size_t *cell_entries = &index->cell_entries[cell->start];
+  for (size_t i = 0; i < cell->size; i++) {
+    entry_t *entry = &index->entries[cell_entries[i]];
+    // a cell the entry has moved out of
+    if (!range_contains(entry->cells, cell->x, cell->y)) {
+      continue;
+    }
+    if (entry->mark == index->query_mark) {
+      continue;
+    }
+    entry->mark = index->query_mark;
+    if (aabb_overlap(entry->bounds, box)) {
+      index->matches[(*num_matches)++] = cell_entries[i];
+    }
+  }
+}
+
+int compare_entries(const void *a, const void *b) {
+  size_t entry1 = *(const size_t *)a, entry2 = *(const size_t *)b;
+  return (entry1 > entry2) - (entry1 < entry2);
+}
+
+void spatial_index_query(spatial_index_t *index, aabb_t box, list_t *results) {
+  if (index->num_entries == 0 || !aabb_overlap(box, index->extent)) {
+    return;
+  }
+  // clamp unbounded boxes to the region that actually holds items
+  aabb_t clamped = {
+      .min = {fmax(box.min.x, index->extent.min.x),
+              fmax(box.min.y, index->extent.min.y)},
+      .max = {fmin(box.max.x, index->extent.max.x),
+              fmin(box.max.y, index->extent.max.y)}};
+  if (index->match_capacity < index->num_entries) {
+    index->match_capacity = index->entry_capacity;
+    size_t *matches =
+        realloc(index->matches, index->match_capacity * sizeof(size_t));
+    assert(matches != NULL);
+    index->matches = matches;
+  }
+  if (!index->grouped) {
+    cells_group(index);
+  }
+  index->query_mark++;
+  size_t num_matches = 0;
+
+  long x_min = cell_coordinate(index, clamped.min.x),
+       x_max = cell_coordinate(index, clamped.max.x),
+       y_min = cell_coordinate(index, clamped.min.y),
+       y_max = cell_coordinate(index, clamped.max.y);
+  double range_cells = (double)(x_max - x_min + 1) * (y_max - y_min + 1);
+  if (range_cells > index->num_used) {
+    // the box covers more cells than are in use, so walk the used cells
+    for (size_t i = 0; i < index->num_used; i++) {
+      cell_t *cell = &index->cells[index->used[i]];
+      if (cell->x >= x_min && cell->x <= x_max && cell->y >= y_min &&
+          cell->y <= y_max) {
+        query_cell(index, cell, box, &num_matches);
+      }
+    }
+  } else {
+    for (long x = x_min; x <= x_max; x++) {
+      for (long y = y_min; y <= y_max; y++) {
+        cell_t *cell = cell_find(index, x, y);
+        if (cell != NULL) {
+          query_cell(index, cell, box, &num_matches);
+        }
+      }
+    }
+  }
+
+  qsort(index->matches, num_matches, sizeof(size_t), compare_entries);
+  for (size_t i = 0; i < num_matches; i++) {
+    list_add(results, index->entries[index->matches[i]].item);
+  }
+}
@@ -0,0 +1,189 @@
+#include "alloc_track.h"
+#include "body.h"
+#include "forces.h"
+#include "scene.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const rgb_color_t GREY = {0.5, 0.5, 0.5};
+
+list_t *make_rect(vector_t center, double width, double height) {
+  list_t *shape = list_init(4, free);
+  vector_t corners[] = {{-0.5, -0.5}, {0.5, -0.5}, {0.5, 0.5}, {-0.5, 0.5}};
+  for (size_t i = 0; i < 4; i++) {
+    vector_t *v = malloc(sizeof(*v));
+    *v = (vector_t){center.x + corners[i].x * width,
+                    center.y + corners[i].y * height};
+    list_add(shape, v);
+  }
+  return shape;
+}
+
+void test_disabled() {
+  assert(!alloc_track_enabled());
+  list_t *list = list_init(4, NULL);
+  list_free(list);
+  assert(alloc_track_total() == 0);
+  assert(alloc_track_stats(ALLOC_LIST).allocations == 0);
+}
+
+void test_subsystem_counts() {
+  alloc_track_enable();
+  assert(alloc_track_enabled());
+  // the list struct and its elements
+  list_t *list = list_init(4, NULL);
+  alloc_stats_t stats = alloc_track_stats(ALLOC_LIST);
+  assert(stats.allocations == 2);
+  assert(stats.frees == 0);
+  assert(stats.bytes >= 4 * sizeof(void *));
+  assert(stats.live_bytes == stats.bytes);
+  assert(stats.peak_bytes == stats.bytes);
+  assert(alloc_track_stats(ALLOC_BODY).allocations == 0);
+
+  list_free(list);
+  stats = alloc_track_stats(ALLOC_LIST);
+  assert(stats.allocations == 2);
+  assert(stats.frees == 2);
+  assert(stats.live_bytes == 0);
+  assert(stats.peak_bytes == stats.bytes);
+
+  body_t *body = body_init(make_rect(VEC_ZERO, 2, 2), 1, GREY);
+  assert(alloc_track_stats(ALLOC_BODY).allocations > 0);
+  size_t total = alloc_track_total();
+  assert(total == alloc_track_stats(ALLOC_LIST).allocations +
+                      alloc_track_stats(ALLOC_BODY).allocations);
+  body_free(body);
+  assert(alloc_track_stats(ALLOC_BODY).live_bytes == 0);
+  alloc_track_disable();
+  assert(alloc_track_total() == 0);
+}
+
+void test_reset_keeps_live_bytes() {
+  alloc_track_enable();
+  list_t *list = list_init(4, NULL);
+  size_t live_bytes = alloc_track_stats(ALLOC_LIST).live_bytes;
+  alloc_track_reset();
+  alloc_stats_t stats = alloc_track_stats(ALLOC_LIST);
+  assert(stats.allocations == 0);
+  assert(stats.bytes == 0);
+  assert(stats.live_bytes == live_bytes);
+  assert(stats.peak_bytes == live_bytes);
+  list_free(list);
+  stats = alloc_track_stats(ALLOC_LIST);
+  assert(stats.frees == 2);
+  assert(stats.live_bytes == 0);
+  alloc_track_disable();
+}
+
+void test_realloc_counts_once() {
+  alloc_track_enable();
+  list_t *list = list_init(1, NULL);
+  int values[2];
+  list_add(list, &values[0]);
+  alloc_track_reset();
+  size_t live_bytes = alloc_track_stats(ALLOC_LIST).live_bytes;
+  // growing the list reallocates its elements
+  list_add(list, &values[1]);
+  alloc_stats_t stats = alloc_track_stats(ALLOC_LIST);
+  assert(stats.allocations == 1);
+  assert(stats.frees == 0);
+  assert(stats.live_bytes ==
+         live_bytes + (list_capacity(list) - 1) * sizeof(void *));
+  list_free(list);
+  alloc_track_disable();
+}
+
+// frees are not counted for memory allocated before tracking started
+void test_untracked_frees() {
+  list_t *list = list_init(4, NULL);
+  alloc_track_enable();
+  list_free(list);
+  alloc_stats_t stats = alloc_track_stats(ALLOC_LIST);
+  assert(stats.frees == 0);
+  assert(stats.live_bytes == 0);
+  alloc_track_disable();
+}
+
+// the collision handlers look at every body's info, as the game's bodies have
+body_t *make_body(vector_t center, double width, double height, double mass) {
+  info_t *info = info_init();
+  set_info_type(info, 0);
+  return body_init_with_info(make_rect(center, width, height), mass, GREY, info,
+                             free, NULL);
+}
+
+// a level like the game's: a player on the ground and obstacles scrolling
+// past it, which it bounces off or removes
+scene_t *make_level(void) {
+  scene_t *scene = scene_init();
+  body_t *ground = make_body((vector_t){500, -10}, 4000, 20, INFINITY);
+  body_t *player = make_body((vector_t){100, 30}, 40, 40, 10);
+  scene_add_body(scene, ground);
+  scene_add_body(scene, player);
+  create_earth_gravity(scene, 9.8, player);
+  create_normal_force(scene, player, ground);
+  for (size_t i = 0; i < 60; i++) {
+    vector_t center = {200 + 60 * i, 20 + (i % 5) * 30};
+    body_t *obstacle = make_body(center, 30, 30, 5);
+    body_set_velocity(obstacle, (vector_t){-120, 0});
+    scene_add_body(scene, obstacle);
+    if (i % 3 == 0) {
+      create_remove_collision(scene, player, obstacle);
+    } else {
+      create_physics_collision(scene, 0.5, player, obstacle);
+    }
+  }
+  return scene;
+}
+
+// what a frame does outside of the game's logic: step, then draw the view
+void run_frames(scene_t *scene, size_t frames) {
+  aabb_t view = {.min = {0, -50}, .max = {1000, 500}};
+  for (size_t i = 0; i < frames; i++) {
+    scene_tick(scene, 1.0 / 60);
+    list_t *visible = scene_bodies_in_bounds(scene, view);
+    for (size_t j = 0; j < list_size(visible); j++) {
+      list_t *shape = body_borrow_shape(list_get(visible, j));
+      assert(list_size(shape) == 4);
+    }
+  }
+}
+
+void test_steady_state_allocates_nothing() {
+  alloc_track_enable();
+  scene_t *scene = make_level();
+  run_frames(scene, 60);
+  size_t bodies = scene_bodies(scene);
+  alloc_track_reset();
+  run_frames(scene, 600);
+  if (alloc_track_total() != 0) {
+    alloc_track_print();
+  }
+  assert(alloc_track_total() == 0);
+  // the obstacles the player hit are gone, and only their memory was freed
+  assert(scene_bodies(scene) < bodies);
+  assert(alloc_track_stats(ALLOC_BODY).frees > 0);
+  scene_free(scene);
+  alloc_track_disable();
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_disabled)
+  DO_TEST(test_subsystem_counts)
+  DO_TEST(test_reset_keeps_live_bytes)
+  DO_TEST(test_realloc_counts_once)
+  DO_TEST(test_untracked_frees)
+  DO_TEST(test_steady_state_allocates_nothing)
+
+  puts("alloc_track_test PASS");
+}
@@ -0,0 +1,151 @@
+#include "asset_pack.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+const char TEST_PACK_PATH[] = "out/test_asset_pack.pack";
+
+// fills an image with pixels that depend on the image and the position
+uint8_t *make_pixels(size_t width, size_t height, uint8_t seed) {
+  uint8_t *pixels = malloc(width * height * ASSET_PACK_BYTES_PER_PIXEL);
+  assert(pixels != NULL);
+  for (size_t y = 0; y < height; y++) {
+    for (size_t x = 0; x < width; x++) {
+      uint8_t *pixel = pixels + (y * width + x) * ASSET_PACK_BYTES_PER_PIXEL;
+      pixel[0] = seed;
+      pixel[1] = x;
+      pixel[2] = y;
+      pixel[3] = 255 - seed;
+    }
+  }
+  return pixels;
+}
+
+// checks that an image in a pack has the same pixels it was added with
+void check_image(asset_pack_t *pack, size_t index, size_t width, size_t height,
+                 uint8_t seed) {
+  asset_image_t image = asset_pack_get_image(pack, index);
+  char name[16];
+  snprintf(name, sizeof(name), "image%u", seed);
+  assert(strcmp(image.name, name) == 0);
+  assert(image.width == width);
+  assert(image.height == height);
+  asset_page_t page = asset_pack_get_page(pack, image.page);
+  uint8_t *expected = make_pixels(width, height, seed);
+  for (size_t y = 0; y < height; y++) {
+    const uint8_t *row = page.pixels + ((image.y + y) * page.width + image.x) *
+                                           ASSET_PACK_BYTES_PER_PIXEL;
+    assert(memcmp(row, expected + y * width * ASSET_PACK_BYTES_PER_PIXEL,
+                  width * ASSET_PACK_BYTES_PER_PIXEL) == 0);
+  }
+  free(expected);
+}
+
+void add_image(asset_pack_writer_t *writer, size_t width, size_t height,
+               uint8_t seed) {
+  uint8_t *pixels = make_pixels(width, height, seed);
+  char name[16];
+  snprintf(name, sizeof(name), "image%u", seed);
+  asset_pack_writer_add(writer, name, width, height, pixels);
+  free(pixels);
+}
+
+void test_round_trip() {
+  asset_pack_writer_t *writer = asset_pack_writer_init();
+  add_image(writer, 300, 200, 1);
+  add_image(writer, 40, 40, 2);
+  add_image(writer, 150, 150, 3);
+  add_image(writer, 30, 60, 4);
+  assert(asset_pack_writer_save(writer, TEST_PACK_PATH));
+  asset_pack_writer_free(writer);
+
+  asset_pack_t *pack = asset_pack_open(TEST_PACK_PATH);
+  assert(pack != NULL);
+  assert(asset_pack_num_images(pack) == 4);
+  // the large image gets its own page and the sprites share one
+  assert(asset_pack_num_pages(pack) == 2);
+  assert(asset_pack_get_image(pack, 1).page == asset_pack_get_image(pack, 2).page);
+  assert(asset_pack_get_image(pack, 0).page != asset_pack_get_image(pack, 1).page);
+  check_image(pack, 0, 300, 200, 1);
+  check_image(pack, 1, 40, 40, 2);
+  check_image(pack, 2, 150, 150, 3);
+  check_image(pack, 3, 30, 60, 4);
+  asset_pack_close(pack);
+  remove(TEST_PACK_PATH);
+}
+
+void test_many_sprites() {
+  // more sprites than fit on one atlas page
+  const size_t NUM_SPRITES = 100;
+  const size_t SPRITE_SIZE = 200;
+  asset_pack_writer_t *writer = asset_pack_writer_init();
+  for (size_t i = 0; i < NUM_SPRITES; i++) {
+    add_image(writer, SPRITE_SIZE, SPRITE_SIZE - i % 7, i);
+  }
+  assert(asset_pack_writer_save(writer, TEST_PACK_PATH));
+  asset_pack_writer_free(writer);
+
+  asset_pack_t *pack = asset_pack_open(TEST_PACK_PATH);
+  assert(pack != NULL);
+  assert(asset_pack_num_images(pack) == NUM_SPRITES);
+  assert(asset_pack_num_pages(pack) > 1);
+  for (size_t i = 0; i < NUM_SPRITES; i++) {
+    check_image(pack, i, SPRITE_SIZE, SPRITE_SIZE - i % 7, i);
+  }
+  asset_pack_close(pack);
+  remove(TEST_PACK_PATH);
+}
+
+void test_invalid_packs() {
+  assert(asset_pack_open("out/no_such_file.pack") == NULL);
+
+  FILE *file = fopen(TEST_PACK_PATH, "wb");
+  assert(file != NULL);
+  fputs("not an asset pack", file);
+  fclose(file);
+  assert(asset_pack_open(TEST_PACK_PATH) == NULL);
+
+  // a valid pack cut off partway through its pixels
+  asset_pack_writer_t *writer = asset_pack_writer_init();
+  add_image(writer, 300, 300, 1);
+  assert(asset_pack_writer_save(writer, TEST_PACK_PATH));
+  asset_pack_writer_free(writer);
+  assert(truncate(TEST_PACK_PATH, 1000) == 0);
+  assert(asset_pack_open(TEST_PACK_PATH) == NULL);
+
+  // a name whose terminating NUL was overwritten; the header, one page
+  // entry and one image entry come before it
+  writer = asset_pack_writer_init();
+  add_image(writer, 10, 10, 1);
+  assert(asset_pack_writer_save(writer, TEST_PACK_PATH));
+  asset_pack_writer_free(writer);
+  asset_pack_t *pack = asset_pack_open(TEST_PACK_PATH);
+  assert(pack != NULL);
+  asset_pack_close(pack);
+  file = fopen(TEST_PACK_PATH, "r+b");
+  assert(file != NULL);
+  assert(fseek(file, 16 + 12 + 28 + strlen("image1"), SEEK_SET) == 0);
+  fputc('x', file);
+  fclose(file);
+  assert(asset_pack_open(TEST_PACK_PATH) == NULL);
+  remove(TEST_PACK_PATH);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_round_trip)
+  DO_TEST(test_many_sprites)
+  DO_TEST(test_invalid_packs)
+
+  puts("asset_pack_test PASS");
+}
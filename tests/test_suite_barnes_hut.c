@@ -0,0 +1,167 @@
+#include "barnes_hut.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const double FIELD_MIN_DISTANCE = 1;
+
+// the field at a point from every other point, one pair at a time
+vector_t exact_field(vector_t *positions, double *masses, size_t count,
+                     size_t point) {
+  vector_t field = VEC_ZERO;
+  for (size_t i = 0; i < count; i++) {
+    vector_t displacement = vec_subtract(positions[i], positions[point]);
+    double distance = sqrt(vec_dot(displacement, displacement));
+    if (distance == 0) {
+      continue;
+    }
+    double softened = fmax(distance, FIELD_MIN_DISTANCE);
+    field = vec_add(field, vec_multiply(masses[i] /
+                                            (softened * softened * distance),
+                                        displacement));
+  }
+  return field;
+}
+
+double vec_length(vector_t v) { return sqrt(vec_dot(v, v)); }
+
+void test_empty_and_single() {
+  barnes_hut_t *tree = barnes_hut_init();
+  barnes_hut_build(tree);
+  assert(barnes_hut_size(tree) == 0);
+  assert(barnes_hut_add(tree, (vector_t){3, 4}, 10) == 0);
+  barnes_hut_build(tree);
+  assert(barnes_hut_size(tree) == 1);
+  assert(vec_equal(barnes_hut_field(tree, 0, 0.5, FIELD_MIN_DISTANCE), VEC_ZERO));
+  barnes_hut_free(tree);
+}
+
+void test_two_points() {
+  barnes_hut_t *tree = barnes_hut_init();
+  barnes_hut_add(tree, (vector_t){0, 0}, 2);
+  barnes_hut_add(tree, (vector_t){10, 0}, 5);
+  barnes_hut_build(tree);
+  assert(vec_isclose(barnes_hut_field(tree, 0, 0.5, FIELD_MIN_DISTANCE),
+                     (vector_t){5.0 / 100, 0}));
+  assert(vec_isclose(barnes_hut_field(tree, 1, 0.5, FIELD_MIN_DISTANCE),
+                     (vector_t){-2.0 / 100, 0}));
+  // closer than the minimum distance, the field stops growing
+  assert(vec_isclose(barnes_hut_field(tree, 0, 0.5, 20),
+                     (vector_t){5.0 / 400, 0}));
+  barnes_hut_free(tree);
+}
+
+void add_random_points(barnes_hut_t *tree, vector_t *positions,
+                       double *masses, size_t count) {
+  srand(1);
+  for (size_t i = 0; i < count; i++) {
+    positions[i] = (vector_t){rand() % 1000, rand() % 1000};
+    masses[i] = 1 + rand() % 10;
+    barnes_hut_add(tree, positions[i], masses[i]);
+  }
+  barnes_hut_build(tree);
+}
+
+void test_exact_with_zero_theta() {
+  const size_t COUNT = 200;
+  vector_t positions[COUNT];
+  double masses[COUNT];
+  barnes_hut_t *tree = barnes_hut_init();
+  add_random_points(tree, positions, masses, COUNT);
+  for (size_t i = 0; i < COUNT; i++) {
+    vector_t expected = exact_field(positions, masses, COUNT, i);
+    vector_t actual = barnes_hut_field(tree, i, 0, FIELD_MIN_DISTANCE);
+    assert(vec_length(vec_subtract(actual, expected)) <=
+           1e-9 * vec_length(expected));
+  }
+  barnes_hut_free(tree);
+}
+
+void test_approximation_error() {
+  const size_t COUNT = 1000;
+  vector_t positions[COUNT];
+  double masses[COUNT];
+  barnes_hut_t *tree = barnes_hut_init();
+  add_random_points(tree, positions, masses, COUNT);
+  double total_error = 0;
+  double total = 0;
+  for (size_t i = 0; i < COUNT; i++) {
+    vector_t expected = exact_field(positions, masses, COUNT, i);
+    vector_t actual = barnes_hut_field(tree, i, 0.5, FIELD_MIN_DISTANCE);
+    total_error += vec_length(vec_subtract(actual, expected));
+    total += vec_length(expected);
+  }
+  assert(total_error < 0.02 * total);
+  barnes_hut_free(tree);
+}
+
+// a far-away cluster pulls like one mass at its center of mass
+void test_far_cluster() {
+  barnes_hut_t *tree = barnes_hut_init();
+  barnes_hut_add(tree, (vector_t){0, 0}, 1);
+  barnes_hut_add(tree, (vector_t){999, 0}, 3);
+  barnes_hut_add(tree, (vector_t){1001, 0}, 1);
+  barnes_hut_add(tree, (vector_t){1000, 1}, 2);
+  barnes_hut_add(tree, (vector_t){1000, -1}, 2);
+  barnes_hut_build(tree);
+  vector_t center = {(999 * 3 + 1001 + 2000 + 2000) / 8.0, 0};
+  vector_t expected = vec_multiply(8 / pow(center.x, 2), (vector_t){1, 0});
+  vector_t actual = barnes_hut_field(tree, 0, 0.5, FIELD_MIN_DISTANCE);
+  assert(vec_length(vec_subtract(actual, expected)) <
+         1e-4 * vec_length(expected));
+  barnes_hut_free(tree);
+}
+
+// points at the same position end up in one leaf and ignore each other
+void test_coincident_points() {
+  barnes_hut_t *tree = barnes_hut_init();
+  for (size_t i = 0; i < 3; i++) {
+    barnes_hut_add(tree, (vector_t){5, 5}, 1);
+  }
+  barnes_hut_add(tree, (vector_t){15, 5}, 4);
+  barnes_hut_build(tree);
+  for (size_t i = 0; i < 3; i++) {
+    assert(vec_isclose(barnes_hut_field(tree, i, 0.5, FIELD_MIN_DISTANCE),
+                       (vector_t){4.0 / 100, 0}));
+  }
+  assert(vec_isclose(barnes_hut_field(tree, 3, 0.5, FIELD_MIN_DISTANCE),
+                     (vector_t){-3.0 / 100, 0}));
+  barnes_hut_free(tree);
+}
+
+void test_rebuild() {
+  barnes_hut_t *tree = barnes_hut_init();
+  for (size_t i = 0; i < 500; i++) {
+    barnes_hut_add(tree, (vector_t){i, i % 7}, 1);
+  }
+  barnes_hut_build(tree);
+  barnes_hut_clear(tree);
+  assert(barnes_hut_size(tree) == 0);
+  barnes_hut_add(tree, (vector_t){0, 0}, 1);
+  barnes_hut_add(tree, (vector_t){0, 10}, 1);
+  barnes_hut_build(tree);
+  assert(vec_isclose(barnes_hut_field(tree, 0, 0.5, FIELD_MIN_DISTANCE),
+                     (vector_t){0, 1.0 / 100}));
+  barnes_hut_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty_and_single)
+  DO_TEST(test_two_points)
+  DO_TEST(test_exact_with_zero_theta)
+  DO_TEST(test_approximation_error)
+  DO_TEST(test_far_cluster)
+  DO_TEST(test_coincident_points)
+  DO_TEST(test_rebuild)
+
+  puts("barnes_hut_test PASS");
+}
@@ -177,6 +177,50 @@ void test_forces() {
   body_tick(body, DT);
   assert(vec_isclose(body_get_centroid(body),
                      vec_add(new_centroid, vec_multiply(DT, new_velocity))));
+  // cleared forces do not move the body
+  body_add_force(body, (vector_t){MASS * 3, MASS * 4});
+  body_add_impulse(body, (vector_t){MASS * 10, MASS * 5});
+  body_clear_forces(body);
+  assert(vec_equal(body_get_force(body), VEC_ZERO));
+  assert(vec_equal(body_get_impulse(body), VEC_ZERO));
+  assert(vec_isclose(body_get_velocity(body), new_velocity));
+  body_free(body);
+}
+
+void test_force_log() {
+  list_t *shape = list_init(3, free);
+  vector_t *v = malloc(sizeof(*v));
+  *v = (vector_t){+1, 0};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){0, +1};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){-1, 0};
+  list_add(shape, v);
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  force_log_t *log = force_log_init();
+
+  // recorded forces are not added until the log is applied
+  force_log_begin(log);
+  for (int i = 0; i < 100; i++) {
+    body_add_force(body, (vector_t){1, 2});
+    body_add_impulse(body, (vector_t){-1, 0});
+  }
+  force_log_end();
+  assert(vec_equal(body_get_force(body), VEC_ZERO));
+  assert(vec_equal(body_get_impulse(body), VEC_ZERO));
+  force_log_apply(log);
+  assert(vec_isclose(body_get_force(body), (vector_t){100, 200}));
+  assert(vec_isclose(body_get_impulse(body), (vector_t){-100, 0}));
+
+  // beginning again empties the log
+  force_log_begin(log);
+  force_log_end();
+  force_log_apply(log);
+  assert(vec_isclose(body_get_force(body), (vector_t){100, 200}));
+
+  force_log_free(log);
   body_free(body);
 }
 
@@ -200,6 +244,55 @@ void test_body_remove() {
   body_free(body);
 }
 
+void test_collision_filter() {
+  list_t *shape = list_init(3, free);
+  vector_t *v = malloc(sizeof(*v));
+  *v = (vector_t){+1, 0};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){0, +1};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){-1, 0};
+  list_add(shape, v);
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  assert(body_get_category(body) == 0);
+  assert(body_get_mask(body) == UINT32_MAX);
+  body_set_collision_filter(body, 4, 1 | 2);
+  assert(body_get_category(body) == 4);
+  assert(body_get_mask(body) == 3);
+  body_free(body);
+}
+
+// the motion predicted before a tick is the one the tick applies
+void test_body_motion() {
+  list_t *shape = list_init(3, free);
+  vector_t *v = malloc(sizeof(*v));
+  *v = (vector_t){+1, 0};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){0, +1};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){-1, 0};
+  list_add(shape, v);
+  body_t *body = body_init(shape, 2, (rgb_color_t){0, 0, 0});
+  assert(body_get_ccd_categories(body) == 0);
+  body_set_ccd_categories(body, 8);
+  assert(body_get_ccd_categories(body) == 8);
+  body_set_velocity(body, (vector_t){1, 0});
+  body_add_force(body, (vector_t){0, 4});
+  body_add_impulse(body, (vector_t){2, 0});
+  vector_t start = body_get_centroid(body);
+  vector_t motion = body_get_motion(body, 0.5);
+  // the velocity goes from (1, 0) to (2, 1)
+  assert(vec_isclose(motion, (vector_t){0.75, 0.25}));
+  assert(vec_equal(body_get_centroid(body), start));
+  body_tick(body, 0.5);
+  assert(vec_isclose(body_get_centroid(body), vec_add(start, motion)));
+  body_free(body);
+}
+
 void test_body_info() {
   list_t *shape = list_init(3, free);
   vector_t *v = malloc(sizeof(*v));
@@ -263,7 +356,10 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_body_tick)
   DO_TEST(test_infinite_mass)
   DO_TEST(test_forces)
+  DO_TEST(test_force_log)
   DO_TEST(test_body_remove)
+  DO_TEST(test_collision_filter)
+  DO_TEST(test_body_motion)
   DO_TEST(test_body_info)
   DO_TEST(test_body_info_freer)
 
@@ -1,6 +1,7 @@
 #include "body.h"
 #include "collision.h"
 #include "list.h"
+#include "polygon.h"
 #include "scene.h"
 #include "test_util.h"
 #include "vector.h"
@@ -70,6 +71,152 @@ void test_collision() {
   list_free(shape3);
 }
 
+void test_collision_depth() {
+  list_t *shape1 = make_shape_1();
+  list_t *shape2 = make_shape_2();
+  list_t *shape3 = make_shape_3();
+  // shape2 reaches 1 past shape3's left edge
+  collision_info_t collision_info = find_collision(shape2, shape3);
+  assert(collision_info.collided);
+  assert(isclose(collision_info.depth, 1));
+  assert(isclose(fabs(collision_info.axis.x), 1));
+  // shape1 and shape3 only touch
+  collision_info = find_collision(shape1, shape3);
+  assert(collision_info.collided);
+  assert(collision_info.depth == 0);
+  polygon_translate(shape3, (vector_t){0.5, 0});
+  collision_info = find_collision(shape1, shape3);
+  assert(!collision_info.collided);
+  assert(collision_info.depth == 0);
+  polygon_translate(shape3, (vector_t){-1, 0});
+  collision_info = find_collision(shape1, shape3);
+  assert(collision_info.collided);
+  assert(isclose(collision_info.depth, 0.5));
+  list_free(shape1);
+  list_free(shape2);
+  list_free(shape3);
+}
+
+// squares of side 2 on a grid, close enough that some overlap
+list_t *make_grid_square(size_t i) {
+  list_t *shape = make_shape_1();
+  polygon_translate(shape, (vector_t){(i % 10) * 1.5, (i / 10) * 2.5});
+  return shape;
+}
+
+void test_find_collisions() {
+  const size_t NUM_SHAPES = 60;
+  list_t *shapes[NUM_SHAPES];
+  for (size_t i = 0; i < NUM_SHAPES; i++) {
+    shapes[i] = make_grid_square(i);
+  }
+  size_t num_pairs = NUM_SHAPES * (NUM_SHAPES - 1) / 2;
+  collision_pair_t *pairs = malloc(num_pairs * sizeof(collision_pair_t));
+  size_t k = 0;
+  for (size_t i = 0; i < NUM_SHAPES; i++) {
+    for (size_t j = i + 1; j < NUM_SHAPES; j++) {
+      pairs[k++] = (collision_pair_t){.shape1 = shapes[i], .shape2 = shapes[j]};
+    }
+  }
+  collision_info_t *serial = malloc(num_pairs * sizeof(collision_info_t));
+  collision_info_t *parallel = malloc(num_pairs * sizeof(collision_info_t));
+  job_system_t *jobs = job_system_init(3);
+  find_collisions(NULL, pairs, num_pairs, serial);
+  find_collisions(jobs, pairs, num_pairs, parallel);
+  size_t num_collided = 0;
+  for (size_t i = 0; i < num_pairs; i++) {
+    collision_info_t expected = find_collision(pairs[i].shape1, pairs[i].shape2);
+    assert(serial[i].collided == expected.collided);
+    assert(parallel[i].collided == expected.collided);
+    if (expected.collided) {
+      assert(vec_isclose(parallel[i].axis, expected.axis));
+      assert(isclose(parallel[i].depth, expected.depth));
+      num_collided++;
+    }
+  }
+  assert(num_collided > 0 && num_collided < num_pairs);
+  // nothing to test
+  find_collisions(jobs, pairs, 0, parallel);
+  job_system_free(jobs);
+  free(pairs);
+  free(serial);
+  free(parallel);
+  for (size_t i = 0; i < NUM_SHAPES; i++) {
+    list_free(shapes[i]);
+  }
+}
+
+// a wall 0.2 thick and 2 tall, 5 to the right of the origin
+list_t *make_wall() {
+  list_t *shape = list_init(4, free);
+  vector_t corners[] = {{4.9, -1}, {5.1, -1}, {5.1, 1}, {4.9, 1}};
+  for (size_t i = 0; i < 4; i++) {
+    vector_t *v = malloc(sizeof(*v));
+    *v = corners[i];
+    list_add(shape, v);
+  }
+  return shape;
+}
+
+void test_time_of_impact() {
+  list_t *square = make_shape_1();
+  list_t *wall = make_wall();
+  // jumps past the wall in one step, so only a sweep sees it
+  polygon_translate(square, (vector_t){20, 0});
+  assert(!find_collision(square, wall).collided);
+  polygon_translate(square, (vector_t){-20, 0});
+  collision_sweep_t sweep =
+      find_time_of_impact(square, (vector_t){20, 0}, wall, VEC_ZERO);
+  assert(sweep.collided);
+  assert(isclose(sweep.time, 3.9 / 20));
+  assert(vec_isclose(sweep.axis, (vector_t){1, 0}));
+  // only the relative motion matters
+  sweep = find_time_of_impact(wall, (vector_t){-20, 0}, square, VEC_ZERO);
+  assert(sweep.collided);
+  assert(isclose(sweep.time, 3.9 / 20));
+  assert(vec_isclose(sweep.axis, (vector_t){-1, 0}));
+  sweep = find_time_of_impact(square, (vector_t){20, 0}, wall,
+                              (vector_t){20, 0});
+  assert(!sweep.collided);
+  // stopping short, moving away, or passing above the wall
+  assert(!find_time_of_impact(square, (vector_t){2, 0}, wall, VEC_ZERO)
+              .collided);
+  assert(!find_time_of_impact(square, (vector_t){-20, 0}, wall, VEC_ZERO)
+              .collided);
+  assert(!find_time_of_impact(square, (vector_t){20, 20}, wall, VEC_ZERO)
+              .collided);
+  // already overlapping
+  polygon_translate(square, (vector_t){4.5, 0});
+  sweep = find_time_of_impact(square, (vector_t){20, 0}, wall, VEC_ZERO);
+  assert(sweep.collided);
+  assert(sweep.time == 0);
+  list_free(square);
+  list_free(wall);
+}
+
+void test_ray_impact() {
+  list_t *wall = make_wall();
+  collision_sweep_t sweep =
+      find_ray_impact((vector_t){0, 0}, (vector_t){10, 0}, wall);
+  assert(sweep.collided);
+  assert(isclose(sweep.time, 0.49));
+  assert(vec_isclose(sweep.axis, (vector_t){1, 0}));
+  // from the other side, and at a slant
+  sweep = find_ray_impact((vector_t){10, 0}, (vector_t){-10, 0}, wall);
+  assert(isclose(sweep.time, 0.49));
+  assert(vec_isclose(sweep.axis, (vector_t){-1, 0}));
+  sweep = find_ray_impact((vector_t){0, -1}, (vector_t){10, 1}, wall);
+  assert(sweep.collided);
+  assert(isclose(sweep.time, 0.49));
+  // stopping short, passing above, or starting inside
+  assert(!find_ray_impact((vector_t){0, 0}, (vector_t){4, 0}, wall).collided);
+  assert(!find_ray_impact((vector_t){0, 2}, (vector_t){10, 0}, wall).collided);
+  sweep = find_ray_impact((vector_t){5, 0}, (vector_t){10, 0}, wall);
+  assert(sweep.collided);
+  assert(sweep.time == 0);
+  list_free(wall);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -79,5 +226,9 @@ int main(int argc, char *argv[]) {
     read_testname(argv[1], testname, sizeof(testname));
   }
   DO_TEST(test_collision);
+  DO_TEST(test_collision_depth);
+  DO_TEST(test_find_collisions);
+  DO_TEST(test_time_of_impact);
+  DO_TEST(test_ray_impact);
   puts("collision_test PASS");
 }
@@ -77,6 +77,91 @@ void test_energy_conservation() {
   scene_free(scene);
 }
 
+// the largest relative change in the energy of a mass on a stiff spring,
+// ticked at a coarse rate
+double spring_energy_drift(integrator_t integrator, size_t substeps) {
+  const double M = 1;
+  const double K = 100;
+  const double A = 1;
+  const double DT = 0.01;
+  const int STEPS = 1000;
+  scene_t *scene = scene_init();
+  scene_set_integrator(scene, integrator);
+  scene_set_substeps(scene, substeps);
+  body_t *mass = body_init(make_shape(), M, (rgb_color_t){0, 0, 0});
+  body_set_centroid(mass, (vector_t){A, 0});
+  scene_add_body(scene, mass);
+  body_t *anchor = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, anchor);
+  create_spring(scene, K, mass, anchor);
+  double initial_energy = K * A * A / 2;
+  double drift = 0;
+  for (int i = 0; i < STEPS; i++) {
+    scene_tick(scene, DT);
+    vector_t x = body_get_centroid(mass);
+    double energy = K * vec_dot(x, x) / 2 + kinetic_energy(mass);
+    drift = fmax(drift, fabs(energy / initial_energy - 1));
+  }
+  scene_free(scene);
+  return drift;
+}
+
+// the largest relative change in the energy of two bodies orbiting each
+// other, well outside the distance where gravity stops growing
+double orbit_energy_drift(integrator_t integrator) {
+  const double M1 = 1000, M2 = 1;
+  const double G = 1;
+  const double R = 100;
+  const double DT = 1;
+  const int STEPS = 400;
+  scene_t *scene = scene_init();
+  scene_set_integrator(scene, integrator);
+  body_t *mass1 = body_init(make_shape(), M1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, mass1);
+  body_t *mass2 = body_init(make_shape(), M2, (rgb_color_t){0, 0, 0});
+  body_set_centroid(mass2, (vector_t){R, 0});
+  scene_add_body(scene, mass2);
+  // a slightly elliptical orbit, about the center of mass
+  double speed = 0.9 * sqrt(G * (M1 + M2) / R);
+  body_set_velocity(mass1, (vector_t){0, -speed * M2 / (M1 + M2)});
+  body_set_velocity(mass2, (vector_t){0, speed * M1 / (M1 + M2)});
+  create_newtonian_gravity(scene, G, mass1, mass2);
+  double initial_energy = gravity_potential(G, mass1, mass2) +
+                          kinetic_energy(mass1) + kinetic_energy(mass2);
+  double drift = 0;
+  for (int i = 0; i < STEPS; i++) {
+    scene_tick(scene, DT);
+    double energy = gravity_potential(G, mass1, mass2) +
+                    kinetic_energy(mass1) + kinetic_energy(mass2);
+    drift = fmax(drift, fabs(energy / initial_energy - 1));
+  }
+  scene_free(scene);
+  return drift;
+}
+
+// Tests how well each integrator conserves the energy of a stiff spring,
+// with and without substeps
+void test_integrator_energy() {
+  // the default gains energy every tick, so the spring blows up
+  assert(spring_energy_drift(INTEGRATOR_AVERAGE_VELOCITY, 1) > 10);
+  assert(spring_energy_drift(INTEGRATOR_SEMI_IMPLICIT_EULER, 1) < 0.06);
+  assert(spring_energy_drift(INTEGRATOR_VELOCITY_VERLET, 1) < 3e-3);
+  assert(spring_energy_drift(INTEGRATOR_RK4, 1) < 2e-5);
+  // a tenth of the step
+  assert(spring_energy_drift(INTEGRATOR_AVERAGE_VELOCITY, 10) < 1);
+  assert(spring_energy_drift(INTEGRATOR_SEMI_IMPLICIT_EULER, 10) < 6e-3);
+  assert(spring_energy_drift(INTEGRATOR_VELOCITY_VERLET, 10) < 3e-5);
+  assert(spring_energy_drift(INTEGRATOR_RK4, 10) < 1e-9);
+}
+
+// Tests how well each integrator conserves the energy of an orbit
+void test_integrator_orbits() {
+  assert(orbit_energy_drift(INTEGRATOR_AVERAGE_VELOCITY) > 0.1);
+  assert(orbit_energy_drift(INTEGRATOR_SEMI_IMPLICIT_EULER) < 0.02);
+  assert(orbit_energy_drift(INTEGRATOR_VELOCITY_VERLET) < 1e-3);
+  assert(orbit_energy_drift(INTEGRATOR_RK4) < 1e-6);
+}
+
 body_t *make_triangle_body() {
   list_t *shape = list_init(3, free);
   vector_t *v = malloc(sizeof(*v));
@@ -150,6 +235,90 @@ void test_forces_removed() {
   scene_free(scene);
 }
 
+// Tests that a magnet only pulls bodies in its categories and range,
+// only while it is magnetic, and without moving itself
+void test_magnet_attractor() {
+  const uint32_t COIN = 1, OTHER = 2;
+  scene_t *scene = scene_init();
+  body_t *magnet = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, magnet);
+  vector_t positions[] = {{20, 0}, {0, -30}, {200, 0}, {-20, 0}};
+  uint32_t categories[] = {COIN, COIN, COIN, OTHER};
+  body_t *bodies[4];
+  for (size_t i = 0; i < 4; i++) {
+    bodies[i] = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(bodies[i], positions[i]);
+    body_set_collision_filter(bodies[i], categories[i], UINT32_MAX);
+    scene_add_body(scene, bodies[i]);
+  }
+  create_magnet_attractor(scene, 100, magnet, COIN, 50);
+
+  scene_tick(scene, 0.01);
+  for (size_t i = 0; i < 4; i++) {
+    assert(vec_equal(body_get_velocity(bodies[i]), VEC_ZERO));
+  }
+  body_set_magnet(magnet, true);
+  for (int i = 0; i < 10; i++) {
+    scene_tick(scene, 0.01);
+  }
+  assert(body_get_velocity(bodies[0]).x < 0);
+  assert(body_get_velocity(bodies[1]).y > 0);
+  assert(vec_equal(body_get_velocity(bodies[2]), VEC_ZERO));
+  assert(vec_equal(body_get_velocity(bodies[3]), VEC_ZERO));
+  assert(vec_equal(body_get_velocity(magnet), VEC_ZERO));
+  // still one force creator, however long the magnet lasts
+  assert(scene_forcer_count(scene) == 1);
+  scene_free(scene);
+}
+
+// Tests that N-body gravity with an opening angle of 0 matches gravity
+// between every pair, and leaves out other categories and infinite masses
+void test_nbody_gravity() {
+  const double G = 50;
+  const size_t COUNT = 30;
+  const uint32_t STAR = 1;
+  scene_t *pairwise = scene_init();
+  scene_t *nbody = scene_init();
+  for (size_t i = 0; i < COUNT; i++) {
+    vector_t center = {(i * 37) % 101, (i * 53) % 97};
+    double mass = 1 + i % 4;
+    body_t *body = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, center);
+    scene_add_body(pairwise, body);
+    body = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, center);
+    body_set_collision_filter(body, STAR, UINT32_MAX);
+    scene_add_body(nbody, body);
+  }
+  for (size_t i = 0; i < COUNT; i++) {
+    for (size_t j = i + 1; j < COUNT; j++) {
+      create_newtonian_gravity(pairwise, G, scene_get_body(pairwise, i),
+                               scene_get_body(pairwise, j));
+    }
+  }
+  body_t *wall = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  body_set_collision_filter(wall, STAR, UINT32_MAX);
+  scene_add_body(nbody, wall);
+  body_t *other = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(other, (vector_t){50, 50});
+  scene_add_body(nbody, other);
+  create_nbody_gravity(nbody, G, 0, STAR);
+  assert(scene_forcer_count(nbody) == 1);
+
+  for (int i = 0; i < 10; i++) {
+    scene_tick(pairwise, 0.01);
+    scene_tick(nbody, 0.01);
+  }
+  for (size_t i = 0; i < COUNT; i++) {
+    assert(vec_within(1e-6, body_get_centroid(scene_get_body(nbody, i)),
+                      body_get_centroid(scene_get_body(pairwise, i))));
+  }
+  assert(vec_equal(body_get_velocity(wall), VEC_ZERO));
+  assert(vec_equal(body_get_velocity(other), VEC_ZERO));
+  scene_free(pairwise);
+  scene_free(nbody);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -161,8 +330,12 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_collisions)
   DO_TEST(test_energy_conservation)
   DO_TEST(test_spring_sinusoid)
+  DO_TEST(test_integrator_energy)
+  DO_TEST(test_integrator_orbits)
 
   DO_TEST(test_forces_removed)
+  DO_TEST(test_magnet_attractor)
+  DO_TEST(test_nbody_gravity)
 
   puts("forces_test PASS");
 }
@@ -0,0 +1,181 @@
+#include "job_system.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+const size_t TEST_WORKERS = 3;
+
+void count_job(void *aux) { atomic_fetch_add((atomic_size_t *)aux, 1); }
+
+void test_run_jobs(size_t num_workers) {
+  job_system_t *system = job_system_init(num_workers);
+  assert(job_system_num_threads(system) == num_workers + 1);
+  atomic_size_t count;
+  atomic_init(&count, 0);
+  job_t *jobs[100];
+  for (size_t i = 0; i < 100; i++) {
+    jobs[i] = job_submit(system, count_job, &count, NULL, 0);
+  }
+  for (size_t i = 0; i < 100; i++) {
+    job_wait(system, jobs[i]);
+  }
+  assert(atomic_load(&count) == 100);
+  job_system_free(system);
+}
+
+void test_jobs() { test_run_jobs(TEST_WORKERS); }
+
+// with no workers, jobs run on the thread that waits for them
+void test_no_workers() { test_run_jobs(0); }
+
+void test_release_and_wait_idle() {
+  job_system_t *system = job_system_init(TEST_WORKERS);
+  atomic_size_t count;
+  atomic_init(&count, 0);
+  for (size_t i = 0; i < 1000; i++) {
+    job_release(system, job_submit(system, count_job, &count, NULL, 0));
+  }
+  job_system_wait_idle(system);
+  assert(atomic_load(&count) == 1000);
+  job_system_free(system);
+}
+
+// each step records the order it ran in, after checking its dependencies
+typedef struct step {
+  atomic_size_t *clock;
+  size_t ran_at;
+  struct step *after[2];
+  size_t num_after;
+} step_t;
+
+void run_step(void *aux) {
+  step_t *step = aux;
+  for (size_t i = 0; i < step->num_after; i++) {
+    assert(step->after[i]->ran_at != 0);
+  }
+  step->ran_at = atomic_fetch_add(step->clock, 1) + 1;
+}
+
+void test_dependencies() {
+  job_system_t *system = job_system_init(TEST_WORKERS);
+  for (size_t trial = 0; trial < 100; trial++) {
+    atomic_size_t clock;
+    atomic_init(&clock, 0);
+    // a diamond: top before left and right, both before bottom
+    step_t top = {.clock = &clock};
+    step_t left = {.clock = &clock, .after = {&top}, .num_after = 1};
+    step_t right = {.clock = &clock, .after = {&top}, .num_after = 1};
+    step_t bottom = {.clock = &clock, .after = {&left, &right},
+                     .num_after = 2};
+    job_t *top_job = job_submit(system, run_step, &top, NULL, 0);
+    job_t *left_job = job_submit(system, run_step, &left, &top_job, 1);
+    job_t *right_job = job_submit(system, run_step, &right, &top_job, 1);
+    job_t *sides[] = {left_job, right_job};
+    job_t *bottom_job = job_submit(system, run_step, &bottom, sides, 2);
+    job_release(system, top_job);
+    job_release(system, left_job);
+    job_release(system, right_job);
+    job_wait(system, bottom_job);
+    assert(bottom.ran_at == 4);
+    assert(top.ran_at == 1);
+  }
+  job_system_free(system);
+}
+
+// a job whose dependency has already finished runs right away
+void test_finished_dependency() {
+  job_system_t *system = job_system_init(0);
+  atomic_size_t count;
+  atomic_init(&count, 0);
+  job_t *first = job_submit(system, count_job, &count, NULL, 0);
+  job_system_wait_idle(system);
+  job_t *second = job_submit(system, count_job, &count, &first, 1);
+  job_wait(system, first);
+  job_wait(system, second);
+  assert(atomic_load(&count) == 2);
+  job_system_free(system);
+}
+
+void mark_range(void *aux, size_t start, size_t end) {
+  atomic_size_t *marks = aux;
+  assert(start < end);
+  for (size_t i = start; i < end; i++) {
+    atomic_fetch_add(&marks[i], 1);
+  }
+}
+
+void check_parallel_for(job_system_t *system, size_t count, size_t grain) {
+  atomic_size_t *marks = malloc(count * sizeof(atomic_size_t));
+  for (size_t i = 0; i < count; i++) {
+    atomic_init(&marks[i], 0);
+  }
+  job_parallel_for(system, count, grain, mark_range, marks);
+  for (size_t i = 0; i < count; i++) {
+    assert(atomic_load(&marks[i]) == 1);
+  }
+  free(marks);
+}
+
+void test_parallel_for() {
+  job_system_t *system = job_system_init(TEST_WORKERS);
+  check_parallel_for(system, 0, 0);
+  check_parallel_for(system, 1, 0);
+  check_parallel_for(system, 7, 3);
+  check_parallel_for(system, 10000, 0);
+  check_parallel_for(system, 10000, 1);
+  check_parallel_for(system, 10000, 64);
+  job_system_free(system);
+
+  system = job_system_init(0);
+  check_parallel_for(system, 1000, 0);
+  job_system_free(system);
+}
+
+typedef struct nested {
+  job_system_t *system;
+  atomic_size_t *marks;
+} nested_t;
+
+// each outer index marks its own block of 100 indices in parallel
+void nested_range(void *aux, size_t start, size_t end) {
+  nested_t *nested = aux;
+  for (size_t i = start; i < end; i++) {
+    job_parallel_for(nested->system, 100, 10, mark_range,
+                     &nested->marks[i * 100]);
+  }
+}
+
+void test_nested_parallel_for() {
+  job_system_t *system = job_system_init(TEST_WORKERS);
+  atomic_size_t marks[2000];
+  for (size_t i = 0; i < 2000; i++) {
+    atomic_init(&marks[i], 0);
+  }
+  nested_t nested = {.system = system, .marks = marks};
+  job_parallel_for(system, 20, 1, nested_range, &nested);
+  for (size_t i = 0; i < 2000; i++) {
+    assert(atomic_load(&marks[i]) == 1);
+  }
+  job_system_free(system);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_jobs)
+  DO_TEST(test_no_workers)
+  DO_TEST(test_release_and_wait_idle)
+  DO_TEST(test_dependencies)
+  DO_TEST(test_finished_dependency)
+  DO_TEST(test_parallel_for)
+  DO_TEST(test_nested_parallel_for)
+
+  puts("job_system_test PASS");
+}
@@ -261,6 +261,23 @@ void test_null_values() {
   list_free(l);
 }
 
+void test_list_clear() {
+  list_t *l = list_init(2, NULL);
+  vector_t v1 = {1, 1}, v2 = {2, 2}, v3 = {3, 3};
+  list_add(l, &v1);
+  list_add(l, &v2);
+  list_add(l, &v3);
+  size_t capacity = list_capacity(l);
+  // Clearing keeps the elements alive and the capacity unchanged
+  list_clear(l);
+  assert(list_size(l) == 0);
+  assert(list_capacity(l) == capacity);
+  list_add(l, &v3);
+  assert(list_size(l) == 1);
+  assert(list_get(l, 0) == &v3);
+  list_free(l);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -280,6 +297,7 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_list_remove_first)
   DO_TEST(test_empty_remove)
   DO_TEST(test_null_values)
+  DO_TEST(test_list_clear)
 
   puts("list_test PASS");
 }
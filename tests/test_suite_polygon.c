@@ -218,6 +218,26 @@ void test_weird_rotate() {
   list_free(w);
 }
 
+void test_square_bounds() {
+  list_t *sq = make_square();
+  polygon_translate(sq, (vector_t){3, -2});
+  aabb_t box = polygon_bounds(sq);
+  assert(vec_isclose(box.min, (vector_t){2, -3}));
+  assert(vec_isclose(box.max, (vector_t){4, -1}));
+  // touching boxes overlap, separated ones do not
+  aabb_t touching = {.min = {4, -1}, .max = {5, 0}};
+  aabb_t separate = {.min = {4.5, -3}, .max = {5, -1}};
+  assert(aabb_overlap(box, touching));
+  assert(!aabb_overlap(box, separate));
+  aabb_t moved = aabb_translate(box, (vector_t){1, 1});
+  assert(vec_isclose(moved.min, (vector_t){3, -2}));
+  assert(vec_isclose(moved.max, (vector_t){5, 0}));
+  aabb_t swept = aabb_sweep(box, (vector_t){-3, 2});
+  assert(vec_isclose(swept.min, (vector_t){-1, -3}));
+  assert(vec_isclose(swept.max, (vector_t){4, 1}));
+  list_free(sq);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests? True if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -239,6 +259,7 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_weird_area_centroid)
   DO_TEST(test_weird_translate)
   DO_TEST(test_weird_rotate)
+  DO_TEST(test_square_bounds)
 
   puts("polygon_test PASS");
 }
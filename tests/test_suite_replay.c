@@ -0,0 +1,121 @@
+#include "replay.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+const char TEST_REPLAY_PATH[] = "out/test_replay.replay";
+
+void test_round_trip() {
+  replay_writer_t *writer = replay_writer_init(TEST_REPLAY_PATH, 0xdeadbeef);
+  assert(writer != NULL);
+  replay_write_tick(writer, 0, 0.016);
+  replay_write_key(writer, 1, ' ', 0, 0.0);
+  replay_write_key(writer, 1, 'a', 1, 0.25);
+  replay_write_tick(writer, 1, 0.017);
+  // far enough apart that the frame offset takes several bytes
+  replay_write_tick(writer, 100000, 1.0 / 3.0);
+  replay_writer_free(writer, 100002);
+
+  replay_reader_t *reader = replay_reader_init(TEST_REPLAY_PATH);
+  assert(reader != NULL);
+  assert(replay_seed(reader) == 0xdeadbeef);
+
+  replay_event_t event = replay_next(reader);
+  assert(event.type == REPLAY_TICK && event.frame == 0 && event.dt == 0.016);
+  assert(replay_peek(reader).type == REPLAY_KEY);
+  event = replay_next(reader);
+  assert(event.type == REPLAY_KEY && event.frame == 1);
+  assert(event.key == ' ' && event.key_type == 0 && event.held_time == 0.0);
+  event = replay_next(reader);
+  assert(event.type == REPLAY_KEY && event.frame == 1);
+  assert(event.key == 'a' && event.key_type == 1 && event.held_time == 0.25);
+  event = replay_next(reader);
+  assert(event.type == REPLAY_TICK && event.frame == 1 && event.dt == 0.017);
+  event = replay_next(reader);
+  // time steps come back bit for bit
+  assert(event.type == REPLAY_TICK && event.frame == 100000);
+  assert(event.dt == 1.0 / 3.0);
+  // the end is returned however often it is read
+  for (size_t i = 0; i < 3; i++) {
+    event = replay_next(reader);
+    assert(event.type == REPLAY_END && event.frame == 100002);
+  }
+  replay_reader_free(reader);
+  remove(TEST_REPLAY_PATH);
+}
+
+void test_compact() {
+  // a minute of ticks at 60 frames per second
+  const size_t NUM_FRAMES = 3600;
+  replay_writer_t *writer = replay_writer_init(TEST_REPLAY_PATH, 1);
+  for (size_t frame = 0; frame < NUM_FRAMES; frame++) {
+    replay_write_tick(writer, frame, 1.0 / 60.0);
+  }
+  replay_writer_free(writer, NUM_FRAMES);
+
+  FILE *file = fopen(TEST_REPLAY_PATH, "rb");
+  assert(file != NULL);
+  fseek(file, 0, SEEK_END);
+  // a type byte, a one byte frame offset, and the time step
+  assert(ftell(file) < 16 + NUM_FRAMES * 10);
+  fclose(file);
+
+  replay_reader_t *reader = replay_reader_init(TEST_REPLAY_PATH);
+  for (size_t frame = 0; frame < NUM_FRAMES; frame++) {
+    replay_event_t event = replay_next(reader);
+    assert(event.type == REPLAY_TICK && event.frame == frame);
+    assert(event.dt == 1.0 / 60.0);
+  }
+  assert(replay_next(reader).type == REPLAY_END);
+  replay_reader_free(reader);
+  remove(TEST_REPLAY_PATH);
+}
+
+void test_invalid_replays() {
+  assert(replay_reader_init("out/no_such_file.replay") == NULL);
+
+  FILE *file = fopen(TEST_REPLAY_PATH, "wb");
+  assert(file != NULL);
+  fputs("not a replay", file);
+  fclose(file);
+  assert(replay_reader_init(TEST_REPLAY_PATH) == NULL);
+
+  // a recording cut off partway through a record ends at the last frame read
+  replay_writer_t *writer = replay_writer_init(TEST_REPLAY_PATH, 7);
+  replay_write_tick(writer, 0, 0.5);
+  replay_write_tick(writer, 4, 0.5);
+  replay_writer_free(writer, 10);
+  file = fopen(TEST_REPLAY_PATH, "rb");
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fclose(file);
+  assert(truncate(TEST_REPLAY_PATH, size - 5) == 0);
+
+  replay_reader_t *reader = replay_reader_init(TEST_REPLAY_PATH);
+  assert(reader != NULL);
+  assert(replay_seed(reader) == 7);
+  replay_event_t event = replay_next(reader);
+  assert(event.type == REPLAY_TICK && event.frame == 0);
+  event = replay_next(reader);
+  assert(event.type == REPLAY_END && event.frame == 0);
+  replay_reader_free(reader);
+  remove(TEST_REPLAY_PATH);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_round_trip)
+  DO_TEST(test_compact)
+  DO_TEST(test_invalid_replays)
+
+  puts("replay_test PASS");
+}
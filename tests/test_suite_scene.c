@@ -227,6 +227,718 @@ void test_reaping() {
   scene_free(scene);
 }
 
+void test_bodies_in_bounds() {
+  scene_t *scene = scene_init();
+  for (int i = 0; i < 100; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){i * 10, 0});
+    scene_add_body(scene, body);
+  }
+  aabb_t view = {.min = {195, -5}, .max = {305, 5}};
+  list_t *visible = scene_bodies_in_bounds(scene, view);
+  // bodies span +/-1 around x = 200, 210, ..., 300
+  assert(list_size(visible) == 11);
+  for (size_t i = 0; i < list_size(visible); i++) {
+    assert(list_get(visible, i) == scene_get_body(scene, 20 + i));
+  }
+
+  // the index follows the bodies after they move
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_set_velocity(scene_get_body(scene, i), (vector_t){-100, 0});
+  }
+  scene_tick(scene, 1);
+  visible = scene_bodies_in_bounds(scene, view);
+  assert(list_size(visible) == 11);
+  assert(list_get(visible, 0) == scene_get_body(scene, 30));
+
+  // removed bodies disappear from the index after the next tick
+  body_remove(scene_get_body(scene, 30));
+  scene_tick(scene, 0);
+  visible = scene_bodies_in_bounds(scene, view);
+  assert(list_size(visible) == 10);
+  assert(list_get(visible, 0) == scene_get_body(scene, 30));
+  scene_free(scene);
+}
+
+typedef struct {
+  body_t *body1;
+  body_t *body2;
+  list_t *bodies;
+} pair_t;
+
+void pair_free(void *aux) {
+  pair_t *pair = aux;
+  list_free(pair->bodies);
+  free(pair);
+}
+
+// pulls two bodies together, touching nothing but their forces
+void pair_attraction(void *aux) {
+  pair_t *pair = aux;
+  vector_t displacement = vec_subtract(body_get_centroid(pair->body2),
+                                       body_get_centroid(pair->body1));
+  double distance = sqrt(vec_dot(displacement, displacement)) + 1;
+  vector_t force = vec_multiply(1 / (distance * distance * distance),
+                                displacement);
+  body_add_force(pair->body1, force);
+  body_add_force(pair->body2, vec_negate(force));
+}
+
+// bounces a body off the floor; must run alone because it sets velocity
+void floor_bounce(void *aux) {
+  body_t *body = aux;
+  vector_t v = body_get_velocity(body);
+  if (body_get_centroid(body).y < 0 && v.y < 0) {
+    body_set_velocity(body, (vector_t){v.x, -v.y});
+  }
+}
+
+scene_t *make_cluster(job_system_t *jobs) {
+  const size_t NUM_BODIES = 40;
+  scene_t *scene = scene_init();
+  scene_set_job_system(scene, jobs);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){(i % 7) * 3.0, (i / 7) * 2.5});
+    scene_add_body(scene, body);
+  }
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    for (size_t j = i + 1; j < NUM_BODIES; j++) {
+      pair_t *pair = malloc(sizeof(*pair));
+      pair->body1 = scene_get_body(scene, i);
+      pair->body2 = scene_get_body(scene, j);
+      pair->bodies = list_init(2, NULL);
+      list_add(pair->bodies, pair->body1);
+      list_add(pair->bodies, pair->body2);
+      scene_add_parallel_force_creator(scene, pair_attraction, pair,
+                                       pair->bodies, pair_free);
+    }
+    // splits the parallel force creators into runs
+    if (i % 10 == 0) {
+      scene_add_force_creator(scene, floor_bounce, scene_get_body(scene, i),
+                              NULL);
+    }
+  }
+  return scene;
+}
+
+void test_parallel_forces() {
+  job_system_t *jobs = job_system_init(3);
+  scene_t *serial = make_cluster(NULL);
+  scene_t *parallel = make_cluster(jobs);
+  for (int tick = 0; tick < 100; tick++) {
+    scene_tick(serial, 0.01);
+    scene_tick(parallel, 0.01);
+  }
+  for (size_t i = 0; i < scene_bodies(serial); i++) {
+    body_t *body1 = scene_get_body(serial, i);
+    body_t *body2 = scene_get_body(parallel, i);
+    assert(vec_isclose(body_get_centroid(body1), body_get_centroid(body2)));
+    assert(vec_isclose(body_get_velocity(body1), body_get_velocity(body2)));
+  }
+  // the bodies did move
+  assert(!vec_isclose(body_get_centroid(scene_get_body(serial, 0)), VEC_ZERO));
+  scene_free(serial);
+  scene_free(parallel);
+  job_system_free(jobs);
+}
+
+typedef struct {
+  scene_t *scene;
+  body_t *body1;
+  body_t *body2;
+  // handlers append their ids here
+  int calls[10];
+  size_t num_calls;
+  // whether every force creator had run when the first handler was called
+  bool forces_done;
+  bool forces_done_at_first_call;
+} event_test_t;
+
+void record_first(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  event_test_t *test = aux;
+  assert(body1 == test->body1 && body2 == test->body2);
+  if (test->num_calls == 0) {
+    test->forces_done_at_first_call = test->forces_done;
+  }
+  test->calls[test->num_calls++] = 1;
+}
+
+void record_second(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  event_test_t *test = aux;
+  test->calls[test->num_calls++] = 2;
+}
+
+void queue_events(void *aux) {
+  event_test_t *test = aux;
+  collision_event_t event = {.body1 = test->body1, .body2 = test->body2,
+                             .axis = {1, 0}, .depth = 0.5,
+                             .handler = record_first, .aux = test};
+  scene_queue_collision(test->scene, event);
+  event.handler = record_second;
+  scene_queue_collision(test->scene, event);
+  // the same pair and handler again, and the pair the other way around
+  event.handler = record_first;
+  scene_queue_collision(test->scene, event);
+  event.body1 = test->body2;
+  event.body2 = test->body1;
+  event.handler = record_second;
+  scene_queue_collision(test->scene, event);
+}
+
+void finish_forces(void *aux) { ((event_test_t *)aux)->forces_done = true; }
+
+void test_collision_events() {
+  scene_t *scene = scene_init();
+  event_test_t test = {.scene = scene};
+  test.body1 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  test.body2 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, test.body1);
+  scene_add_body(scene, test.body2);
+  scene_add_force_creator(scene, queue_events, &test, NULL);
+  scene_add_force_creator(scene, finish_forces, &test, NULL);
+
+  scene_tick(scene, 0.01);
+  assert(test.forces_done_at_first_call);
+  assert(test.num_calls == 3);
+  assert(test.calls[0] == 1);
+  assert(test.calls[1] == 2);
+  assert(test.calls[2] == 2);
+
+  // each tick starts with an empty queue
+  for (int i = 0; i < 100; i++) {
+    test.num_calls = 0;
+    scene_tick(scene, 0.01);
+    assert(test.num_calls == 3);
+  }
+  scene_free(scene);
+}
+
+typedef struct {
+  body_t *body1;
+  body_t *body2;
+  // the order the testers were called in
+  size_t *next_call;
+  size_t call;
+  bool collided;
+} tester_test_t;
+
+void record_test(void *aux, collision_info_t info) {
+  tester_test_t *test = aux;
+  test->call = (*test->next_call)++;
+  test->collided = info.collided;
+}
+
+void test_collision_testers() {
+  const size_t NUM_BODIES = 20;
+  job_system_t *jobs = job_system_init(3);
+  scene_t *scene = scene_init();
+  scene_set_job_system(scene, jobs);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){i * 1.5, 0});
+    scene_add_body(scene, body);
+  }
+  size_t num_pairs = NUM_BODIES * (NUM_BODIES - 1) / 2;
+  tester_test_t *tests = malloc(num_pairs * sizeof(tester_test_t));
+  size_t next_call = 0;
+  size_t k = 0;
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    for (size_t j = i + 1; j < NUM_BODIES; j++) {
+      tests[k] = (tester_test_t){.body1 = scene_get_body(scene, i),
+                                 .body2 = scene_get_body(scene, j),
+                                 .next_call = &next_call};
+      list_t *bodies = list_init(2, NULL);
+      list_add(bodies, tests[k].body1);
+      list_add(bodies, tests[k].body2);
+      scene_add_collision_tester(scene, tests[k].body1, tests[k].body2,
+                                 record_test, &tests[k], bodies, NULL);
+      k++;
+    }
+  }
+  scene_tick(scene, 0.01);
+  assert(next_call == num_pairs);
+  for (size_t i = 0; i < num_pairs; i++) {
+    assert(tests[i].call == i);
+    collision_info_t info = find_collision(body_borrow_shape(tests[i].body1),
+                                           body_borrow_shape(tests[i].body2));
+    assert(tests[i].collided == info.collided);
+  }
+  // squares of side 2, 1.5 apart, only overlap their neighbours
+  assert(tests[0].collided);
+  assert(!tests[1].collided);
+  scene_free(scene);
+  job_system_free(jobs);
+  free(tests);
+}
+
+typedef struct {
+  // the tick each handler was last called in, and how often stay was called
+  int tick;
+  int began;
+  int stayed;
+  int ended;
+  int num_stays;
+  int *num_freed;
+} contact_test_t;
+
+void contact_began(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  contact_test_t *test = aux;
+  test->began = test->tick;
+}
+
+void contact_stayed(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  contact_test_t *test = aux;
+  test->stayed = test->tick;
+  test->num_stays++;
+}
+
+void contact_ended(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  contact_test_t *test = aux;
+  test->ended = test->tick;
+}
+
+void contact_test_free(void *aux) {
+  contact_test_t *test = aux;
+  (*test->num_freed)++;
+}
+
+void test_contacts() {
+  scene_t *scene = scene_init();
+  body_t *still = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *moving = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(moving, (vector_t){5, 0});
+  body_set_velocity(moving, (vector_t){-1, 0});
+  scene_add_body(scene, still);
+  scene_add_body(scene, moving);
+  contact_handlers_t handlers = {.begin = contact_began,
+                                 .stay = contact_stayed,
+                                 .end = contact_ended};
+  int num_freed = 0;
+  contact_test_t first = {.num_freed = &num_freed};
+  contact_test_t late = {.num_freed = &num_freed};
+  scene_add_contact(scene, moving, still, handlers, &first, contact_test_free);
+  // the squares touch while the moving one is at most 2 from the origin,
+  // i.e. in ticks 4 to 8
+  for (int tick = 1; tick <= 10; tick++) {
+    first.tick = tick;
+    late.tick = tick;
+    if (tick == 6) {
+      // shares the pair, but has not seen the bodies touch yet
+      scene_add_contact(scene, moving, still, handlers, &late,
+                        contact_test_free);
+    }
+    scene_tick(scene, 1);
+  }
+  assert(first.began == 4);
+  assert(first.stayed == 8);
+  assert(first.num_stays == 4);
+  assert(first.ended == 9);
+  assert(late.began == 6);
+  assert(late.num_stays == 2);
+  assert(late.ended == 9);
+
+  // contacts go once either body is removed
+  body_remove(moving);
+  scene_tick(scene, 1);
+  assert(num_freed == 2);
+  assert(scene_bodies(scene) == 1);
+  scene_free(scene);
+}
+
+body_t *make_filtered_body(scene_t *scene, double x, uint32_t category,
+                           uint32_t mask) {
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(body, (vector_t){x, 0});
+  body_set_collision_filter(body, category, mask);
+  scene_add_body(scene, body);
+  return body;
+}
+
+void test_category_contacts() {
+  const uint32_t MOVER = 1, TARGET = 2, OTHER = 4;
+  scene_t *scene = scene_init();
+  body_t *mover = make_filtered_body(scene, 0, MOVER, UINT32_MAX);
+  body_set_velocity(mover, (vector_t){1, 0});
+  make_filtered_body(scene, 5, TARGET, UINT32_MAX);
+  // not in the contact's categories, and masking out the mover
+  make_filtered_body(scene, 10, OTHER, UINT32_MAX);
+  make_filtered_body(scene, 15, TARGET, OTHER);
+  int num_freed = 0;
+  contact_test_t test = {.num_freed = &num_freed};
+  contact_handlers_t handlers = {.begin = contact_began,
+                                 .stay = contact_stayed,
+                                 .end = contact_ended};
+  scene_add_category_contact(scene, MOVER, TARGET, handlers, &test,
+                             contact_test_free);
+  int num_began = 0;
+  int num_ended = 0;
+  for (int tick = 1; tick <= 30; tick++) {
+    test.tick = tick;
+    if (tick == 3) {
+      // bodies added later get the contact too
+      make_filtered_body(scene, 20, TARGET | OTHER, MOVER);
+    }
+    test.began = 0;
+    test.ended = 0;
+    scene_tick(scene, 1);
+    num_began += test.began != 0;
+    num_ended += test.ended != 0;
+  }
+  assert(num_began == 2);
+  assert(num_ended == 2);
+  assert(test.num_stays == 8);
+  // the category contact owns its aux
+  assert(num_freed == 0);
+  scene_free(scene);
+  assert(num_freed == 1);
+}
+
+void test_force_fields() {
+  const uint32_t FALLING = 1;
+  scene_t *scene = scene_init();
+  body_t *in_category = make_filtered_body(scene, 0, FALLING, UINT32_MAX);
+  body_t *added = make_filtered_body(scene, 10, 0, UINT32_MAX);
+  body_t *neither = make_filtered_body(scene, 20, 0, UINT32_MAX);
+  body_t *both = make_filtered_body(scene, 30, FALLING, UINT32_MAX);
+  body_t *wall = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  body_set_collision_filter(wall, FALLING, UINT32_MAX);
+  scene_add_body(scene, wall);
+
+  force_field_t gravity = {.acceleration = {0, -10}, .categories = FALLING};
+  size_t field = scene_force_field(scene, gravity);
+  // the same parameters give the same field
+  assert(scene_force_field(scene, gravity) == field);
+  assert(scene_force_field(scene, (force_field_t){.drag = 1}) != field);
+  scene_add_field_body(scene, field, added);
+  scene_add_field_body(scene, field, both);
+  // a pool around x = 0 that pushes bodies up, with drag
+  force_field_t pool = {.acceleration = {0, 5},
+                        .drag = 2,
+                        .bounded = true,
+                        .region = {.min = {-5, -5}, .max = {5, 5}},
+                        .categories = FALLING};
+  scene_force_field(scene, pool);
+
+  scene_tick(scene, 1);
+  // the pool's drag acts on the velocity from before the tick, i.e. none
+  assert(vec_isclose(body_get_velocity(in_category), (vector_t){0, -5}));
+  assert(vec_isclose(body_get_velocity(added), (vector_t){0, -10}));
+  assert(vec_isclose(body_get_velocity(neither), VEC_ZERO));
+  // a body both added and in the field's categories gets the force once
+  assert(vec_isclose(body_get_velocity(both), (vector_t){0, -10}));
+  assert(vec_isclose(body_get_velocity(wall), VEC_ZERO));
+  scene_tick(scene, 1);
+  assert(vec_isclose(body_get_velocity(in_category), (vector_t){0, 0}));
+  assert(vec_isclose(body_get_velocity(added), (vector_t){0, -20}));
+
+  // removed bodies are dropped from the field
+  body_remove(added);
+  scene_tick(scene, 1);
+  scene_tick(scene, 1);
+  assert(scene_bodies(scene) == 4);
+  scene_free(scene);
+}
+
+void test_bodies_in_radius() {
+  scene_t *scene = scene_init();
+  // a 10x10 grid, 10 apart
+  for (int i = 0; i < 100; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){(i % 10) * 10, (i / 10) * 10});
+    scene_add_body(scene, body);
+  }
+  // the centroids within 10 of (50, 50), not the corners of the box around it
+  list_t *nearby = scene_bodies_in_radius(scene, (vector_t){50, 50}, 10);
+  assert(list_size(nearby) == 5);
+  assert(list_get(nearby, 0) == scene_get_body(scene, 45));
+  assert(list_get(nearby, 2) == scene_get_body(scene, 55));
+  assert(list_get(nearby, 4) == scene_get_body(scene, 65));
+  nearby = scene_bodies_in_radius(scene, (vector_t){50, 50}, 15);
+  assert(list_size(nearby) == 9);
+  nearby = scene_bodies_in_radius(scene, (vector_t){-50, 50}, 15);
+  assert(list_size(nearby) == 0);
+  scene_free(scene);
+}
+
+void scene_no_substeps(void *scene) { scene_set_substeps(scene, 0); }
+
+// a falling body takes the same path in 4 ticks as in one tick of 4 steps
+void test_substeps() {
+  scene_t *ticked = scene_init();
+  scene_t *stepped = scene_init();
+  assert(scene_get_integrator(stepped) == INTEGRATOR_AVERAGE_VELOCITY);
+  assert(scene_get_substeps(stepped) == 1);
+  scene_set_integrator(ticked, INTEGRATOR_RK4);
+  scene_set_integrator(stepped, INTEGRATOR_RK4);
+  assert(scene_get_integrator(stepped) == INTEGRATOR_RK4);
+  scene_set_substeps(stepped, 4);
+  assert(scene_get_substeps(stepped) == 4);
+  assert(test_assert_fail(scene_no_substeps, stepped));
+  scene_t *scenes[] = {ticked, stepped};
+  for (size_t i = 0; i < 2; i++) {
+    body_t *body = body_init(make_shape(), 2, (rgb_color_t){0, 0, 0});
+    body_set_velocity(body, (vector_t){1, 5});
+    scene_add_body(scenes[i], body);
+    size_t field = scene_force_field(
+        scenes[i], (force_field_t){.acceleration = {0, -10}, .drag = 0.5});
+    scene_add_field_body(scenes[i], field, body);
+  }
+  for (int i = 0; i < 4; i++) {
+    scene_tick(ticked, 0.25);
+  }
+  scene_tick(stepped, 1);
+  body_t *body1 = scene_get_body(ticked, 0);
+  body_t *body2 = scene_get_body(stepped, 0);
+  assert(vec_isclose(body_get_centroid(body1), body_get_centroid(body2)));
+  assert(vec_isclose(body_get_velocity(body1), body_get_velocity(body2)));
+  scene_free(ticked);
+  scene_free(stepped);
+}
+
+// two floors 10 apart, and a box above the first
+scene_t *make_query_scene(uint32_t floor_category, uint32_t box_category) {
+  scene_t *scene = scene_init();
+  vector_t floors[] = {{0, 0}, {10, 0}};
+  for (size_t i = 0; i < 2; i++) {
+    body_t *floor = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+    body_set_collision_filter(floor, floor_category, UINT32_MAX);
+    body_set_centroid(floor, floors[i]);
+    scene_add_body(scene, floor);
+  }
+  body_t *box = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_collision_filter(box, box_category, UINT32_MAX);
+  body_set_centroid(box, (vector_t){0, 10});
+  scene_add_body(scene, box);
+  return scene;
+}
+
+void test_raycast() {
+  const uint32_t FLOOR = 1, BOX = 2;
+  scene_t *scene = make_query_scene(FLOOR, BOX);
+  body_t *floor = scene_get_body(scene, 0);
+  body_t *box = scene_get_body(scene, 2);
+  // straight down through the box onto the floor
+  scene_hit_t hit =
+      scene_raycast(scene, (vector_t){0, 20}, (vector_t){0, -30}, FLOOR);
+  assert(hit.body == floor);
+  assert(isclose(hit.time, 19.0 / 30));
+  assert(vec_isclose(hit.normal, (vector_t){0, 1}));
+  hit = scene_raycast(scene, (vector_t){0, 20}, (vector_t){0, -30},
+                      FLOOR | BOX);
+  assert(hit.body == box);
+  assert(isclose(hit.time, 9.0 / 30));
+  // sideways into the second floor
+  hit = scene_raycast(scene, (vector_t){3, 0}, (vector_t){10, 0}, FLOOR);
+  assert(hit.body == scene_get_body(scene, 1));
+  assert(isclose(hit.time, 0.6));
+  assert(vec_isclose(hit.normal, (vector_t){-1, 0}));
+  // between the floors, too short, or starting inside
+  hit = scene_raycast(scene, (vector_t){5, 20}, (vector_t){0, -30}, FLOOR);
+  assert(hit.body == NULL);
+  assert(hit.time == 1);
+  hit = scene_raycast(scene, (vector_t){0, 20}, (vector_t){0, -5}, FLOOR);
+  assert(hit.body == NULL);
+  hit = scene_raycast(scene, (vector_t){0, 0}, (vector_t){0, -5}, FLOOR);
+  assert(hit.body == floor);
+  assert(hit.time == 0);
+  // removed bodies are not hit
+  body_remove(box);
+  hit = scene_raycast(scene, (vector_t){0, 20}, (vector_t){0, -30}, BOX);
+  assert(hit.body == NULL);
+  scene_free(scene);
+}
+
+void test_shapecast() {
+  const uint32_t FLOOR = 1, BOX = 2;
+  scene_t *scene = make_query_scene(FLOOR, BOX);
+  list_t *shape = make_shape();
+  polygon_translate(shape, (vector_t){10, 5});
+  scene_hit_t hit = scene_shapecast(scene, shape, (vector_t){0, -10}, FLOOR);
+  assert(hit.body == scene_get_body(scene, 1));
+  assert(isclose(hit.time, 0.3));
+  assert(vec_isclose(hit.normal, (vector_t){0, 1}));
+  // a little too high to land on anything, or sliding past the box
+  hit = scene_shapecast(scene, shape, (vector_t){0, -2}, FLOOR);
+  assert(hit.body == NULL);
+  hit = scene_shapecast(scene, shape, (vector_t){-20, 0}, FLOOR | BOX);
+  assert(hit.body == NULL);
+  // already resting on the floor
+  polygon_translate(shape, (vector_t){-10, -3.1});
+  hit = scene_shapecast(scene, shape, (vector_t){0, -0.1}, FLOOR);
+  assert(hit.body == scene_get_body(scene, 0));
+  assert(hit.time == 0);
+  list_free(shape);
+  scene_free(scene);
+}
+
+void test_query_aabb() {
+  const uint32_t FLOOR = 1, BOX = 2;
+  scene_t *scene = make_query_scene(FLOOR, BOX);
+  aabb_t everything = {.min = {-5, -5}, .max = {15, 15}};
+  list_t *found = scene_query_aabb(scene, everything, FLOOR);
+  assert(list_size(found) == 2);
+  assert(list_get(found, 0) == scene_get_body(scene, 0));
+  assert(list_get(found, 1) == scene_get_body(scene, 1));
+  found = scene_query_aabb(scene, everything, FLOOR | BOX);
+  assert(list_size(found) == 3);
+  found = scene_query_aabb(scene, (aabb_t){.min = {5, -5}, .max = {15, 15}},
+                           FLOOR | BOX);
+  assert(list_size(found) == 1);
+  assert(list_get(found, 0) == scene_get_body(scene, 1));
+  body_remove(scene_get_body(scene, 2));
+  assert(list_size(scene_query_aabb(scene, everything, BOX)) == 0);
+  scene_free(scene);
+}
+
+// a body falling 10 per tick onto a floor 2 thick
+void test_fast_bodies() {
+  const uint32_t SOLID = 1;
+  scene_t *scene = scene_init();
+  body_t *floor = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  body_set_collision_filter(floor, SOLID, UINT32_MAX);
+  body_set_velocity(floor, (vector_t){100, 0});
+  body_t *fast = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *slow = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_ccd_categories(fast, SOLID);
+  body_set_centroid(fast, (vector_t){0, 5});
+  body_set_centroid(slow, (vector_t){0, 5});
+  body_set_velocity(fast, (vector_t){0, -1000});
+  body_set_velocity(slow, (vector_t){0, -1000});
+  scene_add_body(scene, floor);
+  scene_add_body(scene, fast);
+  scene_add_body(scene, slow);
+  int num_freed = 0;
+  contact_test_t fast_test = {.num_freed = &num_freed};
+  contact_test_t slow_test = {.num_freed = &num_freed};
+  contact_handlers_t handlers = {.begin = contact_began};
+  scene_add_contact(scene, fast, floor, handlers, &fast_test,
+                    contact_test_free);
+  scene_add_contact(scene, slow, floor, handlers, &slow_test,
+                    contact_test_free);
+
+  fast_test.tick = slow_test.tick = 1;
+  scene_tick(scene, 0.01);
+  // the slow body skipped the floor
+  assert(vec_isclose(body_get_centroid(slow), (vector_t){0, -5}));
+  // the fast body touched it 0.3 into the tick and stopped just inside it,
+  // without being dragged along by the floor's sideways motion
+  vector_t stopped = body_get_centroid(fast);
+  assert(isclose(stopped.x, 0));
+  assert(stopped.y < 2 && stopped.y > 1.99);
+  fast_test.tick = slow_test.tick = 2;
+  scene_tick(scene, 0.01);
+  assert(fast_test.began == 2);
+  assert(slow_test.began == 0);
+  scene_free(scene);
+}
+
+// a box that lands on a floor and is held up by the contact solver
+void test_solid_contacts() {
+  const double DT = 0.01;
+  scene_t *scene = scene_init();
+  body_t *floor = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  body_t *box = body_init(make_shape(), 3, (rgb_color_t){0, 0, 0});
+  body_set_centroid(box, (vector_t){0, 2.5});
+  body_set_velocity(box, (vector_t){0, -10});
+  scene_add_body(scene, floor);
+  scene_add_body(scene, box);
+  scene_add_field_body(
+      scene, scene_force_field(scene, (force_field_t){.acceleration = {0, -10}}),
+      box);
+  scene_add_solid_contact(scene, box, floor, 0.5);
+  // it bounces at half the speed it hits at, after this tick's gravity
+  double speed = 0;
+  for (int i = 0; i < 10 && body_get_velocity(box).y < 0; i++) {
+    speed = -body_get_velocity(box).y + 10 * DT;
+    scene_tick(scene, DT);
+  }
+  assert(isclose(body_get_velocity(box).y, speed / 2));
+  // and comes to rest on the floor
+  for (int i = 0; i < 500; i++) {
+    scene_tick(scene, DT);
+  }
+  for (int i = 0; i < 100; i++) {
+    scene_tick(scene, DT);
+    assert(within(1e-9, body_get_velocity(box).y, 0));
+    assert(within(0.05, body_get_centroid(box).y, 2));
+  }
+  // a tick of no time leaves an overlapping box where it is
+  body_set_centroid(box, (vector_t){0, 1.5});
+  body_set_velocity(box, VEC_ZERO);
+  scene_tick(scene, 0);
+  assert(vec_isclose(body_get_velocity(box), VEC_ZERO));
+  assert(vec_isclose(body_get_centroid(box), (vector_t){0, 1.5}));
+  scene_free(scene);
+}
+
+// equal masses meeting head-on swap velocities in an elastic collision,
+// and a stack of boxes rests on the floor
+void test_solver_momentum_and_stacks() {
+  scene_t *scene = scene_init();
+  body_t *left = body_init(make_shape(), 2, (rgb_color_t){0, 0, 0});
+  body_t *right = body_init(make_shape(), 2, (rgb_color_t){0, 0, 0});
+  body_set_centroid(left, (vector_t){-2.5, 0});
+  body_set_centroid(right, (vector_t){2.5, 0});
+  body_set_velocity(left, (vector_t){3, 0});
+  body_set_velocity(right, (vector_t){-1, 0});
+  scene_add_body(scene, left);
+  scene_add_body(scene, right);
+  scene_add_solid_contact(scene, left, right, 1);
+  for (int i = 0; i < 50; i++) {
+    scene_tick(scene, 0.05);
+  }
+  assert(vec_within(1e-9, body_get_velocity(left), (vector_t){-1, 0}));
+  assert(vec_within(1e-9, body_get_velocity(right), (vector_t){3, 0}));
+  scene_free(scene);
+
+  const uint32_t BOX = 1, FLOOR = 2;
+  scene = scene_init();
+  body_t *floor = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  body_set_collision_filter(floor, FLOOR, UINT32_MAX);
+  scene_add_body(scene, floor);
+  scene_add_category_solid_contact(scene, BOX, FLOOR | BOX, 0);
+  scene_force_field(scene, (force_field_t){.acceleration = {0, -10},
+                                           .categories = BOX});
+  for (int i = 1; i <= 3; i++) {
+    body_t *box = body_init(make_shape(), i, (rgb_color_t){0, 0, 0});
+    body_set_centroid(box, (vector_t){0, 2 * i});
+    body_set_collision_filter(box, BOX, UINT32_MAX);
+    scene_add_body(scene, box);
+  }
+  for (int i = 0; i < 1000; i++) {
+    scene_tick(scene, 0.01);
+  }
+  for (int i = 1; i <= 3; i++) {
+    body_t *box = scene_get_body(scene, i);
+    assert(within(0.1, body_get_centroid(box).y, 2 * i));
+    assert(within(1e-3, body_get_velocity(box).y, 0));
+  }
+  scene_free(scene);
+}
+
+// contacts held to the y axis stop bodies landing on each other without
+// slowing them sideways, and let bodies that meet side-on pass
+void test_axis_contacts() {
+  scene_t *scene = scene_init();
+  body_t *floor = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  body_t *lander = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *slider = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(lander, (vector_t){0, 1.99});
+  body_set_velocity(lander, (vector_t){3, -1});
+  body_set_centroid(slider, (vector_t){-1.99, 0});
+  body_set_velocity(slider, (vector_t){1, 0});
+  scene_add_body(scene, floor);
+  scene_add_body(scene, lander);
+  scene_add_body(scene, slider);
+  scene_add_axis_contact(scene, lander, floor, 0, (vector_t){0, 2});
+  scene_add_axis_contact(scene, slider, floor, 0, (vector_t){0, 2});
+  scene_tick(scene, 0.01);
+  assert(vec_within(1e-9, body_get_velocity(lander), (vector_t){3, 0}));
+  assert(vec_within(1e-9, body_get_velocity(slider), (vector_t){1, 0}));
+  scene_free(scene);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -241,6 +953,22 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_force_creator)
   DO_TEST(test_force_creator_aux)
   DO_TEST(test_reaping)
+  DO_TEST(test_bodies_in_bounds)
+  DO_TEST(test_bodies_in_radius)
+  DO_TEST(test_parallel_forces)
+  DO_TEST(test_collision_events)
+  DO_TEST(test_collision_testers)
+  DO_TEST(test_contacts)
+  DO_TEST(test_category_contacts)
+  DO_TEST(test_force_fields)
+  DO_TEST(test_fast_bodies)
+  DO_TEST(test_solid_contacts)
+  DO_TEST(test_solver_momentum_and_stacks)
+  DO_TEST(test_axis_contacts)
+  DO_TEST(test_substeps)
+  DO_TEST(test_raycast)
+  DO_TEST(test_shapecast)
+  DO_TEST(test_query_aabb)
 
   puts("scene_test PASS");
 }
@@ -0,0 +1,159 @@
+#include "spatial_index.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+aabb_t make_box(double x, double y, double half_size) {
+  return (aabb_t){.min = {x - half_size, y - half_size},
+                  .max = {x + half_size, y + half_size}};
+}
+
+void test_empty_index() {
+  spatial_index_t *index = spatial_index_init(10);
+  list_t *results = list_init(1, NULL);
+  spatial_index_query(index, make_box(0, 0, 100), results);
+  assert(list_size(results) == 0);
+  assert(spatial_index_size(index) == 0);
+  list_free(results);
+  spatial_index_free(index);
+}
+
+void test_query_region() {
+  spatial_index_t *index = spatial_index_init(10);
+  int items[4];
+  spatial_index_insert(index, &items[0], make_box(0, 0, 1));
+  spatial_index_insert(index, &items[1], make_box(50, 0, 1));
+  spatial_index_insert(index, &items[2], make_box(-50, -50, 1));
+  // a large item covering many cells
+  spatial_index_insert(index, &items[3], make_box(0, 0, 40));
+  assert(spatial_index_size(index) == 4);
+
+  list_t *results = list_init(4, NULL);
+  spatial_index_query(index, make_box(0, 0, 5), results);
+  assert(list_size(results) == 2);
+  assert(list_get(results, 0) == &items[0]);
+  assert(list_get(results, 1) == &items[3]);
+
+  // results come back in insertion order, each item once
+  list_clear(results);
+  spatial_index_query(index, make_box(45, 0, 10), results);
+  assert(list_size(results) == 2);
+  assert(list_get(results, 0) == &items[1]);
+  assert(list_get(results, 1) == &items[3]);
+
+  list_clear(results);
+  spatial_index_query(index, make_box(200, 200, 5), results);
+  assert(list_size(results) == 0);
+
+  list_free(results);
+  spatial_index_free(index);
+}
+
+void test_unbounded_query() {
+  spatial_index_t *index = spatial_index_init(16);
+  int items[3];
+  spatial_index_insert(index, &items[0], make_box(-1000, 0, 1));
+  spatial_index_insert(index, &items[1], make_box(0, 0, 1));
+  spatial_index_insert(index, &items[2], make_box(1000, 0, 1));
+  list_t *results = list_init(3, NULL);
+  aabb_t left = {.min = {-INFINITY, -INFINITY}, .max = {-500, INFINITY}};
+  spatial_index_query(index, left, results);
+  assert(list_size(results) == 1);
+  assert(list_get(results, 0) == &items[0]);
+  list_free(results);
+  spatial_index_free(index);
+}
+
+void test_clear_and_rebuild() {
+  const size_t NUM_ITEMS = 1000;
+  spatial_index_t *index = spatial_index_init(8);
+  int *items = malloc(NUM_ITEMS * sizeof(int));
+  list_t *results = list_init(NUM_ITEMS, NULL);
+  for (size_t round = 0; round < 3; round++) {
+    spatial_index_clear(index);
+    assert(spatial_index_size(index) == 0);
+    // move every item to the right each round, as a scrolling level would
+    for (size_t i = 0; i < NUM_ITEMS; i++) {
+      spatial_index_insert(index, &items[i],
+                           make_box(i * 10.0 + round * 100.0, 0, 2));
+    }
+    assert(spatial_index_size(index) == NUM_ITEMS);
+    for (size_t i = 0; i < NUM_ITEMS; i += 97) {
+      list_clear(results);
+      spatial_index_query(index, make_box(i * 10.0 + round * 100.0, 0, 1),
+                          results);
+      assert(list_size(results) == 1);
+      assert(list_get(results, 0) == &items[i]);
+    }
+    list_clear(results);
+    aabb_t everything = {.min = {-INFINITY, -INFINITY},
+                         .max = {INFINITY, INFINITY}};
+    spatial_index_query(index, everything, results);
+    assert(list_size(results) == NUM_ITEMS);
+    for (size_t i = 0; i < NUM_ITEMS; i++) {
+      assert(list_get(results, i) == &items[i]);
+    }
+  }
+  list_free(results);
+  free(items);
+  spatial_index_free(index);
+}
+
+void test_update() {
+  const size_t NUM_ITEMS = 50;
+  spatial_index_t *index = spatial_index_init(8);
+  int items[NUM_ITEMS];
+  aabb_t bounds[NUM_ITEMS];
+  for (size_t i = 0; i < NUM_ITEMS; i++) {
+    bounds[i] = make_box(i * 10.0, 0, 1 + i % 3 * 5);
+    spatial_index_insert(index, &items[i], bounds[i]);
+  }
+  list_t *results = list_init(NUM_ITEMS, NULL);
+  // move the items back and forth across cells, so some return to cells
+  // they left, and check every query against the bounds
+  for (size_t round = 0; round < 40; round++) {
+    for (size_t i = round % 2; i < NUM_ITEMS; i += 2) {
+      double x = i * 10.0 + (round % 4 < 2 ? round : -(double)round) * 3;
+      bounds[i] = make_box(x, round % 5 * 4.0, 1 + i % 3 * 5);
+      spatial_index_update(index, i, bounds[i]);
+    }
+    // an item that stays put
+    spatial_index_update(index, 0, bounds[0]);
+    for (size_t x = 0; x < 500; x += 37) {
+      aabb_t box = make_box(x, 5, 6);
+      list_clear(results);
+      spatial_index_query(index, box, results);
+      size_t num_found = 0;
+      for (size_t i = 0; i < NUM_ITEMS; i++) {
+        if (aabb_overlap(bounds[i], box)) {
+          assert(num_found < list_size(results));
+          assert(list_get(results, num_found) == &items[i]);
+          num_found++;
+        }
+      }
+      assert(num_found == list_size(results));
+    }
+  }
+  assert(spatial_index_size(index) == NUM_ITEMS);
+  list_free(results);
+  spatial_index_free(index);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty_index)
+  DO_TEST(test_query_region)
+  DO_TEST(test_unbounded_query)
+  DO_TEST(test_clear_and_rebuild)
+  DO_TEST(test_update)
+
+  puts("spatial_index_test PASS");
+}
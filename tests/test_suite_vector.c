@@ -1,5 +1,6 @@
 #include "test_util.h"
 #include "vector.h"
+#include "vector_math.h"
 #include <assert.h>
 #include <math.h>
 
@@ -75,6 +76,51 @@ void test_vec_rotate() {
   assert(vec_isclose(vec_rotate(VEC_ZERO, 1.0), VEC_ZERO));
 }
 
+void test_distance_and_normalize() {
+  assert(distance((vector_t){1, 2}, (vector_t){4, 6}) == 5);
+  assert(distance((vector_t){-1, -2}, (vector_t){-1, -2}) == 0);
+  assert(vec_isclose(normalize((vector_t){3, -4}), (vector_t){0.6, -0.8}));
+  assert(vec_equal(normalize(VEC_ZERO), VEC_ZERO));
+}
+
+// the inline functions agree with the ones in vector.c
+void test_inline_math() {
+  vector_t vectors[] = {{1, 2}, {-5, 3}, {0.1, -0.7}, {1e10, -1e-10}, {0, 0}};
+  for (size_t i = 0; i < 5; i++) {
+    for (size_t j = 0; j < 5; j++) {
+      vector_t v1 = vectors[i], v2 = vectors[j];
+      assert(vec_equal(vm_add(v1, v2), vec_add(v1, v2)));
+      assert(vec_equal(vm_subtract(v1, v2), vec_subtract(v1, v2)));
+      assert(vec_equal(vm_multiply(v1.x, v2), vec_multiply(v1.x, v2)));
+      assert(vm_dot(v1, v2) == vec_dot(v1, v2));
+      assert(vm_cross(v1, v2) == vec_cross(v1, v2));
+      assert(vm_distance(v1, v2) == distance(v1, v2));
+    }
+    assert(vec_equal(vm_negate(vectors[i]), vec_negate(vectors[i])));
+    assert(vec_equal(vm_normalize(vectors[i]), normalize(vectors[i])));
+  }
+}
+
+void test_array_math() {
+  // an odd count, so the last dot product is not done in a pair
+  vector_t points[] = {{1, 2}, {-5, 3}, {0.5, -0.25}};
+  vector_t steps[] = {{1, 0}, {0, 1}, {-2, 2}};
+  double dots[3];
+  vm_dot_array(points, 3, (vector_t){2, -1}, dots);
+  assert(dots[0] == 0 && dots[1] == -13 && dots[2] == 1.25);
+  vm_translate_array(points, 3, (vector_t){1, -1});
+  assert(vec_equal(points[0], (vector_t){2, 1}));
+  assert(vec_equal(points[2], (vector_t){1.5, -1.25}));
+  vm_add_scaled_array(points, 0.5, steps, 3);
+  assert(vec_equal(points[0], (vector_t){2.5, 1}));
+  assert(vec_equal(points[1], (vector_t){-4, 2.5}));
+  assert(vec_equal(points[2], (vector_t){0.5, -0.25}));
+  // nothing to do
+  vm_dot_array(points, 0, (vector_t){1, 1}, dots);
+  vm_translate_array(points, 0, (vector_t){1, 1});
+  assert(vec_equal(points[0], (vector_t){2.5, 1}));
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -92,6 +138,9 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_vec_dot)
   DO_TEST(test_vec_cross)
   DO_TEST(test_vec_rotate)
+  DO_TEST(test_distance_and_normalize)
+  DO_TEST(test_inline_math)
+  DO_TEST(test_array_math)
 
   puts("vector_test PASS");
 }
@@ -0,0 +1,65 @@
+/**
+ * Build-time tool that decodes images and writes them into an asset pack,
+ * so the game can map the raw pixels instead of decoding PNGs at startup.
+ *
+ * Usage: asset_packer <output pack> <image>...
+ * Images are numbered in the order they are given, and named by their path.
+ */
+#include "asset_pack.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Decodes an image and adds its pixels to the pack, in RGBA32 */
+bool add_image_file(asset_pack_writer_t *writer, const char *path) {
+  SDL_Surface *decoded = IMG_Load(path);
+  if (decoded == NULL) {
+    fprintf(stderr, "failed to load %s: %s\n", path, IMG_GetError());
+    return false;
+  }
+  SDL_Surface *surface =
+      SDL_ConvertSurfaceFormat(decoded, SDL_PIXELFORMAT_RGBA32, 0);
+  SDL_FreeSurface(decoded);
+  if (surface == NULL) {
+    fprintf(stderr, "failed to convert %s: %s\n", path, SDL_GetError());
+    return false;
+  }
+
+  // surface rows may be padded, but pack rows are not
+  size_t row_size = surface->w * ASSET_PACK_BYTES_PER_PIXEL;
+  uint8_t *pixels = malloc(row_size * surface->h);
+  assert(pixels != NULL);
+  SDL_LockSurface(surface);
+  for (int row = 0; row < surface->h; row++) {
+    memcpy(pixels + row * row_size,
+           (uint8_t *)surface->pixels + row * surface->pitch, row_size);
+  }
+  SDL_UnlockSurface(surface);
+  asset_pack_writer_add(writer, path, surface->w, surface->h, pixels);
+  free(pixels);
+  SDL_FreeSurface(surface);
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <output pack> <image>...\n", argv[0]);
+    return 1;
+  }
+  IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+  asset_pack_writer_t *writer = asset_pack_writer_init();
+  bool packed = true;
+  for (int i = 2; i < argc && packed; i++) {
+    packed = add_image_file(writer, argv[i]);
+  }
+  if (packed && !asset_pack_writer_save(writer, argv[1])) {
+    fprintf(stderr, "failed to write %s\n", argv[1]);
+    packed = false;
+  }
+  asset_pack_writer_free(writer);
+  IMG_Quit();
+  return packed ? 0 : 1;
+}